@@ -255,7 +255,9 @@ def exportEnergyPlusAsFMU(showDiagnostics, litter, iddFileName, wthFileName, fmi
   addToZipFile(workZipFile, idfFileName, 'resources', modelIdName+'.idf')
   addToZipFile(workZipFile, OUT_variablesFileName, 'resources', None)
   addToZipFile(workZipFile, iddFileName, 'resources', None)
-  addToZipFile(workZipFile, exportPrepExeName, 'resources', None)
+  # The FMU for FMI 2.0 links the preprocessing, and does not need the executable.
+  if( fmiVersion == 1 ):
+    addToZipFile(workZipFile, exportPrepExeName, 'resources', None)
   if( wthFileName is not None ):
     addToZipFile(workZipFile, wthFileName, 'resources', None)
   addToZipFile(workZipFile, OUT_fmuSharedLibName, os.path.join('binaries',fmuBinDirName), None)
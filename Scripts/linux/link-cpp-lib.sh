@@ -32,4 +32,4 @@ shift 1
 
 #--- Link.
 #
-g++ -shared -lm -o "${outputName}"  "$@"
+g++ -shared -lm -o "${outputName}"  "$@"  -lrt -lpthread
@@ -222,6 +222,7 @@ def makeExportPrepApp(showDiagnostics, litter, forceRebuild, fmiVersion):
   for theRootName in ['app-cmdln-input',
     'app-cmdln-version',
     'fmu-export-idf-data',
+    'fmu-export-prep-lib',
     'fmu-export-write-vars-cfg',
     'fmu-export-prep-main'
     ]:
@@ -229,7 +230,9 @@ def makeExportPrepApp(showDiagnostics, litter, forceRebuild, fmiVersion):
   #
 
   srcDirName = os.path.join(scriptDirName, '../SourceCode/read-ep-file')
-  for theRootName in ['ep-idd-map',
+  for theRootName in ['char-scan',
+    'ep-idd-cache',
+    'ep-idd-map',
     'fileReader',
     'fileReaderData',
     'fileReaderDictionary'
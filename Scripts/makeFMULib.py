@@ -346,6 +346,7 @@ def makeFmuSharedLib(showDiagnostics, litter,
   #
   srcDirName = os.path.join(scriptDirName, '../SourceCode/socket')
   for theRootName in [
+    'utilShm',
     'utilSocket'
     ]:
     srcFileNameList.append(os.path.join(srcDirName, theRootName +'.c'))
@@ -372,6 +373,14 @@ def makeFmuSharedLib(showDiagnostics, litter,
         srcFileNameList.append(os.path.join(srcDirName, theRootName +'.c'))
 
   if(fmiVersion==2):
+      for theRootName in [
+        'valueRefTable',
+        'asyncWorker',
+        'modelDescCache',
+        'phaseTimer'
+        ]:
+        srcFileNameList.append(os.path.join(srcDirName, theRootName +'.c'))
+      #
       srcDirName = os.path.join(scriptDirName, '../SourceCode/'+vers+'/fmusdk-shared')
       for theRootName in [
         'xmlVersionParser'
@@ -384,6 +393,31 @@ def makeFmuSharedLib(showDiagnostics, litter,
         'XmlParserCApi'
         ]:
         srcFileNameList.append(os.path.join(srcDirName, theRootName +'.cpp'))
+      # Preprocessing of the input files, called by fmi2EnterInitializationMode.
+      srcDirName = os.path.join(scriptDirName, '../SourceCode/fmu-export-prep-shared')
+      for theRootName in [
+        'fmu-export-idf-data',
+        'fmu-export-prep-lib'
+        ]:
+        srcFileNameList.append(os.path.join(srcDirName, theRootName +'.cpp'))
+      srcDirName = os.path.join(scriptDirName, '../SourceCode/read-ep-file')
+      for theRootName in [
+        'char-scan',
+        'ep-idd-cache',
+        'ep-idd-map',
+        'fileReader',
+        'fileReaderData',
+        'fileReaderDictionary'
+        ]:
+        srcFileNameList.append(os.path.join(srcDirName, theRootName +'.cpp'))
+      srcDirName = os.path.join(scriptDirName, '../SourceCode/utility')
+      for theRootName in [
+        'digest-md5',
+        'file-help',
+        'string-help',
+        'utilReport'
+        ]:
+        srcFileNameList.append(os.path.join(srcDirName, theRootName +'.cpp'))
   # Load modules expect to find in same directory as this script file.
   if( scriptDirName not in sys.path ):
     sys.path.append(scriptDirName)
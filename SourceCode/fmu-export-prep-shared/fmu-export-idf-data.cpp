@@ -53,6 +53,9 @@ const string g_desc_idfVer = "A";
 const string g_key_leapYear = "HOLIDAYS/DAYLIGHT SAVINGS";
 const string g_desc_leapYear = "A";
 
+// Number of header lines of a weather file, before the data.
+const int EPW_HEADER_LINES = 8;
+
 const string g_key_extInt = "EXTERNALINTERFACE";
 const string g_desc_extInt = "A";
 //
@@ -69,6 +72,34 @@ const string g_key_extInt_fmuExport_toVar = "EXTERNALINTERFACE:FUNCTIONALMOCKUPU
 const string g_desc_extInt_fmuExport_toVar = "AAN";
 
 
+//--- Keywords of the IDF file that the export handles.
+//
+//   Each keyword is an atom of {g_idfKeywords}, so that the keyword of each
+// IDF object is looked up once, without case folding a copy of it, rather
+// than compared to each keyword in turn.
+enum idfKeywordAtom {
+  ATOM_EXTINT,
+  ATOM_EXTINT_FMUEXPORT_TOACTUATOR,
+  ATOM_EXTINT_FMUEXPORT_TOSCHED,
+  ATOM_EXTINT_FMUEXPORT_FROMVAR,
+  ATOM_EXTINT_FMUEXPORT_TOVAR
+};
+
+static iddMap makeIdfKeywords(void)
+  {
+  iddMap keywords;
+  // Set in the order of the atoms.
+  keywords.set(g_key_extInt, g_desc_extInt);
+  keywords.set(g_key_extInt_fmuExport_toActuator, g_desc_extInt_fmuExport_toActuator);
+  keywords.set(g_key_extInt_fmuExport_toSched, g_desc_extInt_fmuExport_toSched);
+  keywords.set(g_key_extInt_fmuExport_fromVar, g_desc_extInt_fmuExport_fromVar);
+  keywords.set(g_key_extInt_fmuExport_toVar, g_desc_extInt_fmuExport_toVar);
+  return( keywords );
+  }
+
+static const iddMap g_idfKeywords = makeIdfKeywords();
+
+
 //--- Functions.
 
 
@@ -78,6 +109,8 @@ fmuExportIdfData::fmuExportIdfData(void)
   {
   _goodRead = false;
   _externalErrorFcn = 0;
+  _externalErrorStream = 0;
+  _infoStream = &cout;
   _gotKeyExtInt = false;
   //
   #ifdef _DEBUG
@@ -114,6 +147,36 @@ void fmuExportIdfData::attachErrorFcn(void (*errFcn)(std::ostringstream& errorMe
   }  // End method fmuExportIdfData::attachErrorFcn().
 
 
+//--- Attach an error stream.
+//
+void fmuExportIdfData::attachErrorStream(std::ostream& errStream)
+  {
+  _externalErrorStream = &errStream;
+  }  // End method fmuExportIdfData::attachErrorStream().
+
+
+//--- Set the stream of the progress messages.
+//
+void fmuExportIdfData::setInfoStream(std::ostream& infoStream)
+  {
+  _infoStream = &infoStream;
+  }  // End method fmuExportIdfData::setInfoStream().
+
+
+//--- Set the directory of the files of the run.
+//
+void fmuExportIdfData::setRunDirectory(const string& runDirName)
+  {
+  _runFilePrefix = runDirName;
+  if( ! _runFilePrefix.empty() )
+    {
+    const char lastChar = _runFilePrefix[_runFilePrefix.size()-1];
+    if( '/' != lastChar && '\\' != lastChar )
+      _runFilePrefix.push_back('/');
+    }
+  }  // End method fmuExportIdfData::setRunDirectory().
+
+
 //--- Validate IDD file.
 //
 bool fmuExportIdfData::haveValidIDD(const iddMap& idd, string& errStr) const
@@ -135,6 +198,19 @@ bool fmuExportIdfData::haveValidIDD(const iddMap& idd, string& errStr) const
     );
   }  // End method fmuExportIdfData::haveValidIDD().
 
+
+//--- Get the keywords of the IDD file that {haveValidIDD()} checks.
+//
+void fmuExportIdfData::getIddKeywords(std::set<string>& keywords) const
+  {
+  //
+  keywords.insert(g_key_extInt);
+  keywords.insert(g_key_extInt_fmuExport_toActuator);
+  keywords.insert(g_key_extInt_fmuExport_toSched);
+  keywords.insert(g_key_extInt_fmuExport_fromVar);
+  keywords.insert(g_key_extInt_fmuExport_toVar);
+  }  // End method fmuExportIdfData::getIddKeywords().
+
 ///////////////////////////////////////////////////////////////////////////////
 /// This function calculates the modulo of two doubles. 
 ///
@@ -354,9 +430,10 @@ static int getNumDays(int month, int leapyear){
 ///
 ///\param month The time.
 ///\param leapyear The flag for leap year.
+///\param infoStream The stream of the progress messages.
 ///\return The month.
 ///////////////////////////////////////////////////////////////////////////////
-static int getMonth(int time_s, int leapyear){
+static int getMonth(int time_s, int leapyear, std::ostream& infoStream){
 
 	int month;
 	int tmp;
@@ -404,7 +481,7 @@ static int getMonth(int time_s, int leapyear){
 		}
 		//if the time is larger than a year
 		else{
-			cout << "Time (" << time_s << ") set is larger than maximum allowed (365 days)."
+			infoStream << "Time (" << time_s << ") set is larger than maximum allowed (365 days)."
 				" Month will be set to 12." << endl;
 			month = 12;
 		}
@@ -449,7 +526,7 @@ static int getMonth(int time_s, int leapyear){
 		}
 		//if the time is larger than a year
 		else{
-			cout << "Time (" << time_s << ") set is larger than maximum allowed (366 days)."
+			infoStream << "Time (" << time_s << ") set is larger than maximum allowed (366 days)."
 				" Month will be set to 12." << endl;
 			month = 12;
 		}
@@ -462,11 +539,12 @@ static int getMonth(int time_s, int leapyear){
 ///
 ///\param time_s The time in seconds.
 ///\param leapyear The flag for leap year.
+///\param infoStream The stream of the progress messages.
 ///\return The time in months.
 ///////////////////////////////////////////////////////////////////////////////
-static int getCurrentMonth(double time_s, int leapyear){
+static int getCurrentMonth(double time_s, int leapyear, std::ostream& infoStream){
 	int month;
-	month = getMonth(time_s, leapyear);
+	month = getMonth(time_s, leapyear, infoStream);
 	return month;
 }
 
@@ -476,9 +554,10 @@ static int getCurrentMonth(double time_s, int leapyear){
 ///
 ///\param time_s The time in seconds.
 ///\param leapyear The flag for leap year.
+///\param infoStream The stream of the progress messages.
 ///\return The time in days.
 ///////////////////////////////////////////////////////////////////////////////
-static int getCurrentDay(double time_s, int month, int leapyear){
+static int getCurrentDay(double time_s, int month, int leapyear, std::ostream& infoStream){
 
 	int day;
 	int num_days;
@@ -487,7 +566,7 @@ static int getCurrentDay(double time_s, int month, int leapyear){
 
 	num_days = getNumDays(month, leapyear);
 	if ((time_s == 0) || (int)(time_s / 86400)< 1){
-		cout << "Time (" << time_s << ") set is smaller than minimun allowed (1 day)."
+		infoStream << "Time (" << time_s << ") set is smaller than minimun allowed (1 day)."
 			" Day will be set to 1." << endl;
 		day = 1;
 	}
@@ -500,7 +579,7 @@ static int getCurrentDay(double time_s, int month, int leapyear){
 			else{
 				if (time_s > tmp)
 				{
-					cout << "Time (" << time_s << ") set is larger than maximum allowed (365 days)."
+					infoStream << "Time (" << time_s << ") set is larger than maximum allowed (365 days)."
 						" Day will be set to 31." << endl;
 					day = 31;
 				}
@@ -517,7 +596,7 @@ static int getCurrentDay(double time_s, int month, int leapyear){
 			else{
 				if (time_s > tmpp)
 				{
-					cout << "Time (" << time_s << ") set is larger than maximum allowed (366 days)."
+					infoStream << "Time (" << time_s << ") set is larger than maximum allowed (366 days)."
 						" Day will be set to 31." << endl;
 					day = 31;
 				}
@@ -538,10 +617,11 @@ static int getCurrentDay(double time_s, int month, int leapyear){
 ///\param t_start_fmu The start time in the FMU.
 ///\param fname The filename to extract idf information.
 ///\param fname The filename to write new date information.
+///\param infoStream The stream of the progress messages.
 ///\return 0 if no error occurred.
 ///////////////////////////////////////////////////////////////////////////////
 static int getCurrentDayOfWeek(double t_start_idf, double t_start_fmu, 
-	string day_of_week, char *new_day_week){
+	string day_of_week, char *new_day_week, std::ostream& infoStream){
 		int modDat;
 		char arr[7][10]={ "SUNDAY", "MONDAY", "TUESDAY", "WEDNESDAY", "THURSDAY", "FRIDAY", "SATURDAY" };
 		int new_index;
@@ -585,7 +665,7 @@ static int getCurrentDayOfWeek(double t_start_idf, double t_start_fmu,
 		else if (day_of_week.compare("USEWEATHERFILE")== 0)
 		{
 			change=0;
-			cout << "Day of week: UseWeatherFile has been specified and will be used." << endl;
+			infoStream << "Day of week: UseWeatherFile has been specified and will be used." << endl;
             sprintf(new_day_week, "%s", "USEWEATHERFILE");
 			return 0;
 		}
@@ -593,7 +673,7 @@ static int getCurrentDayOfWeek(double t_start_idf, double t_start_fmu,
 		{
 			// write the new day of week, no day of week was specified.
 			sprintf(new_day_week, "%s", " ");
-			cout << "Day of week was left blank in input file." << endl;
+			infoStream << "Day of week was left blank in input file." << endl;
 			return 0;
 		}
 		if (change !=0) {
@@ -625,7 +705,7 @@ int fmuExportIdfData::populateFromIDF(fileReaderData& frIdf)
   {
   //
   int lineNo;
-  string idfKey, iddDesc;
+  fileReaderSpan idfKey;
   //
   #ifdef _DEBUG
     assert( ! frIdf.isEOF() );
@@ -647,35 +727,35 @@ int fmuExportIdfData::populateFromIDF(fileReaderData& frIdf)
       {
       // Here, hit EOF.
       //   OK to hit EOF, provided don't actually have a keyword.
-      if( 0 != idfKey.length() )
+      if( ! idfKey.empty() )
         {
         _goodRead = false;
         std::ostringstream os;
-        os << "Error: IDF file ends after keyword '" << idfKey << "' on line " << lineNo;
+        os << "Error: IDF file ends after keyword '" << idfKey.str() << "' on line " << lineNo;
         reportError(os);
         }
       break;
       }
     // Here, have a keyword (although may be zero length).
-    capitalize(idfKey);
     // Handle or skip IDF entry for this keyword.
-    if( 0 == g_key_extInt.compare(idfKey) )
+    const int atom = g_idfKeywords.find(idfKey.data(), idfKey.size());
+    if( ATOM_EXTINT == atom )
       {
       handleKey_extInt(frIdf);
       }
-    else if( 0 == g_key_extInt_fmuExport_toActuator.compare(idfKey) )
+    else if( ATOM_EXTINT_FMUEXPORT_TOACTUATOR == atom )
       {
       handleKey_extInt_fmuExport_toActuator(frIdf);
       }
-    else if( 0 == g_key_extInt_fmuExport_toSched.compare(idfKey) )
+    else if( ATOM_EXTINT_FMUEXPORT_TOSCHED == atom )
       {
       handleKey_extInt_fmuExport_toSched(frIdf);
       }
-    else if( 0 == g_key_extInt_fmuExport_fromVar.compare(idfKey) )
+    else if( ATOM_EXTINT_FMUEXPORT_FROMVAR == atom )
       {
       handleKey_extInt_fmuExport_fromVar(frIdf);
       }
-    else if( 0 == g_key_extInt_fmuExport_toVar.compare(idfKey) )
+    else if( ATOM_EXTINT_FMUEXPORT_TOVAR == atom )
       {
       handleKey_extInt_fmuExport_toVar(frIdf);
       }
@@ -727,10 +807,7 @@ int fmuExportIdfData::writeInputFile(fileReaderData& frIdf, int leapYear, int id
 	_goodRead = true;
 	//
 	// Run through the IDF file.
-#define HS_MAX 10
-
-	runInfile.open("runinfile.idf");
-	char valueStr[HS_MAX];
+	runInfile.open((_runFilePrefix + "runinfile.idf").c_str());
 	while (_goodRead)
 	{
 		frIdf.skipComment(IDF_COMMENT_CHARS, lineNo);
@@ -761,216 +838,10 @@ int fmuExportIdfData::writeInputFile(fileReaderData& frIdf, int leapYear, int id
 		else if ((0 == g_key_runPer.compare(inputKey)) && !(inputKey.find(g_key_output) != string::npos)){
 				nRunPer++;
 				if (nRunPer < 2){
-					// FMU start time
-					double t_start_fmu = 0.0;
-					double t_start_fmuDofW = 0.0;
-					double t_stop_fmu = 86400.0;
-					if (idfVer < 9) {
-						// g_desc_runPer_idf = "ANNNNAAAAAANAN";
-						handleKey_runPer(frIdf, idfVer);
-						std::string runPeriod("RUNPERIOD, \n");
-						if (_runPer_strings.size() > 1) {
-							runPeriod.append(_runPer_strings[0]);
-							runPeriod.append(",\n");
-						}
-
-						istringstream(tStartFMU) >> t_start_fmu;
-						istringstream(tStopFMU) >> t_stop_fmu;
-
-						// Save original FMU start time to be used to determine the day of the week
-						t_start_fmuDofW = t_start_fmu;
-
-						// Change the start time so we compute the correct time.
-						if (t_start_fmu >= 86400) t_start_fmu = t_start_fmu + 86400;
-
-						// get the start month
-						int begMonth = getCurrentMonth(t_start_fmu, leapYear);
-						snprintf(valueStr, HS_MAX, "%d", begMonth);
-						runPeriod.append(valueStr);
-						runPeriod.append(",\n");
-
-						cout << "This is the Begin Month: " << begMonth << endl;
-
-						// get the day of the month 
-						int begDayMonth = getCurrentDay(t_start_fmu, begMonth, leapYear);
-						snprintf(valueStr, HS_MAX, "%d", begDayMonth);
-						runPeriod.append(valueStr);
-						runPeriod.append(",\n");
-
-						cout << "This is the Day of the Begin Month: " << begDayMonth << endl;
-
-						// get the end month
-						int endMonth = getCurrentMonth(t_stop_fmu, leapYear);
-						snprintf(valueStr, HS_MAX, "%d", endMonth);
-						runPeriod.append(valueStr);
-						runPeriod.append(",\n");
-
-						cout << "This is the End Month: " << endMonth << endl;
-
-						// get the day of the month
-						int endDayMonth = getCurrentDay(t_stop_fmu, endMonth, leapYear);
-						snprintf(valueStr, HS_MAX, "%d", endDayMonth);
-						runPeriod.append(valueStr);
-
-						cout << "This is the Day of the End Month: " << endDayMonth << endl;
-
-						// get the idf start time in seconds
-						double t_start_idf = getSimTimeSeconds(_runPer_numerics[1], _runPer_numerics[0], 0);
-						char new_day_week[20];
-						int retVal = getCurrentDayOfWeek(t_start_idf, t_start_fmuDofW, _runPer_strings[1], new_day_week);
-
-						cout << "This is the New Day of Week: " << new_day_week << endl;
-
-						if (_runPer_strings.size() > 6) {
-							runPeriod.append(",\n");
-							// write new day of the week
-							runPeriod.append(new_day_week);
-							runPeriod.append(",\n");
-							runPeriod.append(_runPer_strings[2] + ",\n");
-							runPeriod.append(_runPer_strings[3] + ",\n");
-							runPeriod.append(_runPer_strings[4] + ",\n");
-							runPeriod.append(_runPer_strings[5] + ",\n");
-							runPeriod.append(_runPer_strings[6]);
-						}
-						if (_runPer_numerics.size() > 4) {
-							cout << "The field **Number of Times Runperiod to be Repeated**"
-								"  of the RunPeriod object is ignored. This entry will be set to its default." << endl;
-							runPeriod.append(",\n");
-							//snprintf(valueStr, HS_MAX, "%d", (int)_runPer_numerics[4]);
-							runPeriod.append(" ");
-
-						}
-						if (_runPer_strings.size() > 7) {
-							cout << "The field **Increment Day of Week on repeat**"
-								" of the RunPeriod object is ignored. This entry will be set to its default." << endl;
-							runPeriod.append(",\n");
-							//runPeriod.append(_runPer_strings[7]);
-							runPeriod.append(" ");
-						}
-						if (_runPer_numerics.size() > 5) {
-							cout << "The field **Start Year** of the RunPeriod object is ignored."
-								" This entry will be set to its default." << endl;
-							runPeriod.append(",\n");
-							runPeriod.append(" ");
-						}
-						runPeriod.append(";\n");
-						runInfile << runPeriod;
-					}
-					else {
-						// g_desc_runPer_idf = "ANNNNNNAAAAAAA";
-						string startYear;
-						string endYear;
-
-						istringstream(tStartFMU) >> t_start_fmu;
-						istringstream(tStopFMU) >> t_stop_fmu;
-
-						istringstream(startYear) >> _runPer_numerics[2];
-						istringstream(endYear) >> _runPer_numerics[5];
-
-						handleKey_runPer(frIdf, idfVer);
-						std::string runPeriod("RUNPERIOD, \n");
-						if (_runPer_strings.size() > 1) {
-							runPeriod.append(_runPer_strings[0]);
-							runPeriod.append(",\n");
-						}
-						// FMU start time
-						double t_start_fmu = 0.0;
-						double t_start_fmuDofW = 0.0;
-						double t_stop_fmu = 86400.0;
-
-						istringstream(tStartFMU) >> t_start_fmu;
-						istringstream(tStopFMU) >> t_stop_fmu;
-
-						// Save original FMU start time to be used to determine the day of the week
-						t_start_fmuDofW = t_start_fmu;
-
-						// Change the start time so we compute the correct time.
-						if (t_start_fmu >= 86400) t_start_fmu = t_start_fmu + 86400;
-
-						// get the start month
-						int begMonth = getCurrentMonth(t_start_fmu, leapYear);
-						snprintf(valueStr, HS_MAX, "%d", begMonth);
-						runPeriod.append(valueStr);
-						runPeriod.append(",\n");
-
-						cout << "This is the Begin Month: " << begMonth << endl;
-
-						// get the day of the month 
-						int begDayMonth = getCurrentDay(t_start_fmu, begMonth, leapYear);
-						snprintf(valueStr, HS_MAX, "%d", begDayMonth);
-						runPeriod.append(valueStr);
-						runPeriod.append(",\n");
-
-						cout << "This is the Day of the Begin Month: " << begDayMonth << endl;
-
-						// get the start year
-						if (_runPer_numerics[2] != 0) {
-							snprintf(valueStr, HS_MAX, "%d", (int)_runPer_numerics[2]);
-							runPeriod.append(valueStr);
-						}
-						else {
-							runPeriod.append("");
-						}
-						runPeriod.append(",\n");
-
-						// get the end month
-						int endMonth = getCurrentMonth(t_stop_fmu, leapYear);
-						snprintf(valueStr, HS_MAX, "%d", endMonth);
-						runPeriod.append(valueStr);
-						runPeriod.append(",\n");
-
-						cout << "This is the End Month: " << endMonth << endl;
-
-						// get the day of the month
-						int endDayMonth = getCurrentDay(t_stop_fmu, endMonth, leapYear);
-						snprintf(valueStr, HS_MAX, "%d", endDayMonth);
-						runPeriod.append(valueStr);
-						runPeriod.append(",\n");
-
-						cout << "This is the Day of the End Month: " << endDayMonth << endl;
-
-						// get the end year
-						if (_runPer_numerics[5] != 0) {
-							snprintf(valueStr, HS_MAX, "%d", (int)_runPer_numerics[5]);
-							runPeriod.append(valueStr);
-						}
-						else {
-							runPeriod.append("");
-						}
-						runPeriod.append(",\n");
-
-						// get the idf start time in seconds
-						double t_start_idf = getSimTimeSeconds(_runPer_numerics[1], _runPer_numerics[0], 0);
-						char new_day_week[20];
-						int retVal = getCurrentDayOfWeek(t_start_idf, t_start_fmuDofW, _runPer_strings[1], new_day_week);
-
-						cout << "This is the New Day of Week: " << new_day_week << endl;
-
-						if (_runPer_strings.size() > 5) {
-							// write new day of the week
-							runPeriod.append(new_day_week);
-							runPeriod.append(",\n");
-							runPeriod.append(_runPer_strings[2] + ",\n");
-							runPeriod.append(_runPer_strings[3] + ",\n");
-							runPeriod.append(_runPer_strings[4] + ",\n");
-							runPeriod.append(_runPer_strings[5] + ",\n");
-						}
-
-						if (_runPer_strings.size() == 7) {
-							//runPeriod.append(_runPer_strings[6] + ",\n");
-							runPeriod.append(_runPer_strings[6]);
-						}
-						else if (_runPer_strings.size() == 8) {
-							runPeriod.append(_runPer_strings[6] + ",\n");
-							runPeriod.append(_runPer_strings[7]);
-						}
-						runPeriod.append(";\n");
-						runInfile << runPeriod;
-
-					}
+					writeRunPeriod(frIdf, runInfile, leapYear, idfVer, tStartFMU, tStopFMU);
 				}
 				else{
-					cout << "There is more than one RunPeriod(" << nRunPer << ") in the IDF file."
+					*_infoStream << "There is more than one RunPeriod(" << nRunPer << ") in the IDF file."
 						" The first RunPeriod will be considered. Other RunPeriods will be ignored." << endl;
 				}
 		}
@@ -1001,21 +872,378 @@ int fmuExportIdfData::writeInputFile(fileReaderData& frIdf, int leapYear, int id
 	{
 		lineNo = 0;
 	}
-#undef HS_MAX
 	return(lineNo);
 }  // End method fmuExportIdfData::writeInputFile().
 
+//--- Write the RunPeriod of the FMU, in place of the RunPeriod of the IDF file.
+//
+//   Assume just read key {g_key_runPer} from the IDF file.
+//
+void fmuExportIdfData::writeRunPeriod(fileReaderData& frIdf, std::ostream& runInfile,
+	int leapYear, int idfVer, const string& tStartFMU, const string& tStopFMU)
+{
+#define HS_MAX 10
+	char valueStr[HS_MAX];
+	// FMU start time
+	double t_start_fmu = 0.0;
+	double t_start_fmuDofW = 0.0;
+	double t_stop_fmu = 86400.0;
+	if (idfVer < 9) {
+		// g_desc_runPer_idf = "ANNNNAAAAAANAN";
+		handleKey_runPer(frIdf, idfVer);
+		std::string runPeriod("RUNPERIOD, \n");
+		if (_runPer_strings.size() > 1) {
+			runPeriod.append(_runPer_strings[0]);
+			runPeriod.append(",\n");
+		}
+
+		istringstream(tStartFMU) >> t_start_fmu;
+		istringstream(tStopFMU) >> t_stop_fmu;
+
+		// Save original FMU start time to be used to determine the day of the week
+		t_start_fmuDofW = t_start_fmu;
+
+		// Change the start time so we compute the correct time.
+		if (t_start_fmu >= 86400) t_start_fmu = t_start_fmu + 86400;
+
+		// get the start month
+		int begMonth = getCurrentMonth(t_start_fmu, leapYear, *_infoStream);
+		snprintf(valueStr, HS_MAX, "%d", begMonth);
+		runPeriod.append(valueStr);
+		runPeriod.append(",\n");
+
+		*_infoStream << "This is the Begin Month: " << begMonth << endl;
+
+		// get the day of the month 
+		int begDayMonth = getCurrentDay(t_start_fmu, begMonth, leapYear, *_infoStream);
+		snprintf(valueStr, HS_MAX, "%d", begDayMonth);
+		runPeriod.append(valueStr);
+		runPeriod.append(",\n");
+
+		*_infoStream << "This is the Day of the Begin Month: " << begDayMonth << endl;
+
+		// get the end month
+		int endMonth = getCurrentMonth(t_stop_fmu, leapYear, *_infoStream);
+		snprintf(valueStr, HS_MAX, "%d", endMonth);
+		runPeriod.append(valueStr);
+		runPeriod.append(",\n");
+
+		*_infoStream << "This is the End Month: " << endMonth << endl;
+
+		// get the day of the month
+		int endDayMonth = getCurrentDay(t_stop_fmu, endMonth, leapYear, *_infoStream);
+		snprintf(valueStr, HS_MAX, "%d", endDayMonth);
+		runPeriod.append(valueStr);
+
+		*_infoStream << "This is the Day of the End Month: " << endDayMonth << endl;
+
+		// get the idf start time in seconds
+		double t_start_idf = getSimTimeSeconds(_runPer_numerics[1], _runPer_numerics[0], 0);
+		char new_day_week[20];
+		int retVal = getCurrentDayOfWeek(t_start_idf, t_start_fmuDofW, _runPer_strings[1], new_day_week, *_infoStream);
+
+		*_infoStream << "This is the New Day of Week: " << new_day_week << endl;
+
+		if (_runPer_strings.size() > 6) {
+			runPeriod.append(",\n");
+			// write new day of the week
+			runPeriod.append(new_day_week);
+			runPeriod.append(",\n");
+			runPeriod.append(_runPer_strings[2] + ",\n");
+			runPeriod.append(_runPer_strings[3] + ",\n");
+			runPeriod.append(_runPer_strings[4] + ",\n");
+			runPeriod.append(_runPer_strings[5] + ",\n");
+			runPeriod.append(_runPer_strings[6]);
+		}
+		if (_runPer_numerics.size() > 4) {
+			*_infoStream << "The field **Number of Times Runperiod to be Repeated**"
+				"  of the RunPeriod object is ignored. This entry will be set to its default." << endl;
+			runPeriod.append(",\n");
+			//snprintf(valueStr, HS_MAX, "%d", (int)_runPer_numerics[4]);
+			runPeriod.append(" ");
+
+		}
+		if (_runPer_strings.size() > 7) {
+			*_infoStream << "The field **Increment Day of Week on repeat**"
+				" of the RunPeriod object is ignored. This entry will be set to its default." << endl;
+			runPeriod.append(",\n");
+			//runPeriod.append(_runPer_strings[7]);
+			runPeriod.append(" ");
+		}
+		if (_runPer_numerics.size() > 5) {
+			*_infoStream << "The field **Start Year** of the RunPeriod object is ignored."
+				" This entry will be set to its default." << endl;
+			runPeriod.append(",\n");
+			runPeriod.append(" ");
+		}
+		runPeriod.append(";\n");
+		runInfile << runPeriod;
+	}
+	else {
+		// g_desc_runPer_idf = "ANNNNNNAAAAAAA";
+		string startYear;
+		string endYear;
+
+		istringstream(tStartFMU) >> t_start_fmu;
+		istringstream(tStopFMU) >> t_stop_fmu;
+
+		istringstream(startYear) >> _runPer_numerics[2];
+		istringstream(endYear) >> _runPer_numerics[5];
+
+		handleKey_runPer(frIdf, idfVer);
+		std::string runPeriod("RUNPERIOD, \n");
+		if (_runPer_strings.size() > 1) {
+			runPeriod.append(_runPer_strings[0]);
+			runPeriod.append(",\n");
+		}
+		// FMU start time
+		double t_start_fmu = 0.0;
+		double t_start_fmuDofW = 0.0;
+		double t_stop_fmu = 86400.0;
+
+		istringstream(tStartFMU) >> t_start_fmu;
+		istringstream(tStopFMU) >> t_stop_fmu;
+
+		// Save original FMU start time to be used to determine the day of the week
+		t_start_fmuDofW = t_start_fmu;
+
+		// Change the start time so we compute the correct time.
+		if (t_start_fmu >= 86400) t_start_fmu = t_start_fmu + 86400;
+
+		// get the start month
+		int begMonth = getCurrentMonth(t_start_fmu, leapYear, *_infoStream);
+		snprintf(valueStr, HS_MAX, "%d", begMonth);
+		runPeriod.append(valueStr);
+		runPeriod.append(",\n");
+
+		*_infoStream << "This is the Begin Month: " << begMonth << endl;
+
+		// get the day of the month 
+		int begDayMonth = getCurrentDay(t_start_fmu, begMonth, leapYear, *_infoStream);
+		snprintf(valueStr, HS_MAX, "%d", begDayMonth);
+		runPeriod.append(valueStr);
+		runPeriod.append(",\n");
+
+		*_infoStream << "This is the Day of the Begin Month: " << begDayMonth << endl;
+
+		// get the start year
+		if (_runPer_numerics[2] != 0) {
+			snprintf(valueStr, HS_MAX, "%d", (int)_runPer_numerics[2]);
+			runPeriod.append(valueStr);
+		}
+		else {
+			runPeriod.append("");
+		}
+		runPeriod.append(",\n");
+
+		// get the end month
+		int endMonth = getCurrentMonth(t_stop_fmu, leapYear, *_infoStream);
+		snprintf(valueStr, HS_MAX, "%d", endMonth);
+		runPeriod.append(valueStr);
+		runPeriod.append(",\n");
+
+		*_infoStream << "This is the End Month: " << endMonth << endl;
+
+		// get the day of the month
+		int endDayMonth = getCurrentDay(t_stop_fmu, endMonth, leapYear, *_infoStream);
+		snprintf(valueStr, HS_MAX, "%d", endDayMonth);
+		runPeriod.append(valueStr);
+		runPeriod.append(",\n");
+
+		*_infoStream << "This is the Day of the End Month: " << endDayMonth << endl;
+
+		// get the end year
+		if (_runPer_numerics[5] != 0) {
+			snprintf(valueStr, HS_MAX, "%d", (int)_runPer_numerics[5]);
+			runPeriod.append(valueStr);
+		}
+		else {
+			runPeriod.append("");
+		}
+		runPeriod.append(",\n");
+
+		// get the idf start time in seconds
+		double t_start_idf = getSimTimeSeconds(_runPer_numerics[1], _runPer_numerics[0], 0);
+		char new_day_week[20];
+		int retVal = getCurrentDayOfWeek(t_start_idf, t_start_fmuDofW, _runPer_strings[1], new_day_week, *_infoStream);
+
+		*_infoStream << "This is the New Day of Week: " << new_day_week << endl;
+
+		if (_runPer_strings.size() > 5) {
+			// write new day of the week
+			runPeriod.append(new_day_week);
+			runPeriod.append(",\n");
+			runPeriod.append(_runPer_strings[2] + ",\n");
+			runPeriod.append(_runPer_strings[3] + ",\n");
+			runPeriod.append(_runPer_strings[4] + ",\n");
+			runPeriod.append(_runPer_strings[5] + ",\n");
+		}
+
+		if (_runPer_strings.size() == 7) {
+			//runPeriod.append(_runPer_strings[6] + ",\n");
+			runPeriod.append(_runPer_strings[6]);
+		}
+		else if (_runPer_strings.size() == 8) {
+			runPeriod.append(_runPer_strings[6] + ",\n");
+			runPeriod.append(_runPer_strings[7]);
+		}
+		runPeriod.append(";\n");
+		runInfile << runPeriod;
+
+	}
+#undef HS_MAX
+}  // End method fmuExportIdfData::writeRunPeriod().
+
+//--- Write the input file and the time step file in a single pass over the IDF file.
+//
+//   The pass extracts the version, the first Timestep and the first RunPeriod,
+// while writing {runinfile.idf}.  The RunPeriod depends on the version.  If the
+// RunPeriod comes before the Version object, {runinfile.idf} is incomplete, and
+// {needInputFile} is set so that the caller writes it with writeInputFile().
+//
+int fmuExportIdfData::writeRunFiles(fileReaderData& frIdf, int leapYear, string tStartFMU, string tStopFMU,
+	int &idfVersion, bool &needInputFile)
+{
+	//
+	int lineNo;
+	int nRunPer;
+	int nTStep;
+	bool gotIdfVer;
+	// Key of the current object, if the object has a single field of interest.
+	string pendingKey;
+	bool atKey;
+	string inputKey, inputKeyExt;
+	ofstream runInfile;
+	ofstream tStepfile;
+	//
+#ifdef _DEBUG
+	assert(!frIdf.isEOF());
+#endif
+	//
+	// Initialize.
+	lineNo = 0;
+	nRunPer = 0;
+	nTStep = 0;
+	gotIdfVer = false;
+	atKey = true;
+	needInputFile = false;
+	_goodRead = true;
+	//
+	// Run through the IDF file.
+	runInfile.open((_runFilePrefix + "runinfile.idf").c_str());
+	while (_goodRead)
+	{
+		frIdf.skipComment(IDF_COMMENT_CHARS, lineNo);
+		frIdf.getToken(IDF_DELIMITERS_ALL, IDF_COMMENT_CHARS, inputKey, inputKeyExt);
+		// Consume the delimiter that caused getToken() to return.
+		char delimChar = frIdf.getChar();
+		capitalize(inputKey);
+
+		// Pass Output: objects through, as they may contain the key RunPeriod.
+		if (inputKey.find(g_key_output) != string::npos){
+			runInfile << inputKeyExt << '\n';
+			while (';' != delimChar)
+			{
+				frIdf.skipComment(IDF_COMMENT_CHARS, lineNo);
+				frIdf.getToken(IDF_DELIMITERS_ALL, IDF_COMMENT_CHARS, inputKey, inputKeyExt);
+				runInfile << inputKeyExt << '\n';
+				delimChar = frIdf.getChar();
+			}
+			atKey = true;
+			pendingKey.clear();
+		}
+
+		// handle RunPeriod
+		else if (0 == g_key_runPer.compare(inputKey)){
+			nRunPer++;
+			if (nRunPer < 2 && !gotIdfVer){
+				// Here, the descriptor of the RunPeriod is not known yet.
+				needInputFile = true;
+			}
+			else if (nRunPer < 2){
+				writeRunPeriod(frIdf, runInfile, leapYear, idfVersion, tStartFMU, tStopFMU);
+				// The RunPeriod has been consumed up to its terminating delimiter.
+				delimChar = ';';
+			}
+			else{
+				*_infoStream << "There is more than one RunPeriod(" << nRunPer << ") in the IDF file."
+					" The first RunPeriod will be considered. Other RunPeriods will be ignored." << endl;
+			}
+			atKey = (';' == delimChar);
+			pendingKey.clear();
+		}
+		else{
+			runInfile << inputKeyExt << '\n';
+			// Get Version and Timestep, which each have a single field.
+			if (atKey){
+				string key = inputKey;
+				trimEnd(key);
+				pendingKey.clear();
+				if (',' == delimChar && ((!gotIdfVer && 0 == g_key_idfVer.compare(key)) ||
+					(0 == nTStep && 0 == g_key_timeStep.compare(key)))){
+					pendingKey = key;
+				}
+			}
+			else if (!pendingKey.empty()){
+				if (';' == delimChar && 0 == g_key_idfVer.compare(pendingKey)){
+					idfVersion = std::stoi(inputKey, nullptr, 10);
+					gotIdfVer = true;
+				}
+				else if (';' == delimChar){
+					tStepfile.open((_runFilePrefix + "tstep.txt").c_str());
+					tStepfile << inputKey;
+					tStepfile.close();
+					nTStep++;
+				}
+				pendingKey.clear();
+			}
+			atKey = (';' == delimChar);
+		}
+		if (frIdf.isEOF())
+		{
+			// Here, hit EOF.
+			//   OK to hit EOF, provided don't actually have a keyword.
+			if (0 != inputKey.length())
+			{
+				_goodRead = false;
+				std::ostringstream os;
+				os << "Error: IDF file ends after keyword '" << inputKey << "' on line " << lineNo;
+				reportError(os);
+			}
+			break;
+		}
+		// Here, ready to look for next keyword.
+	}
+
+	// Report if we couldn't find a time step in the file.
+	if (_goodRead && nTStep == 0){
+		_goodRead = false;
+		std::ostringstream os;
+		os << "Error: There is no TimeStep object in the IDF input file";
+		reportError(os);
+		lineNo = frIdf.getLineNumber();
+	}
+
+	// Here, ran through whole IDF file.
+	frIdf.close();
+	runInfile.close();
+	//
+	if (_goodRead)
+	{
+		lineNo = 0;
+	}
+	return(lineNo);
+}  // End method fmuExportIdfData::writeRunFiles().
+
 //--- Read Weather file, collecting data needed to run an EnergyPlus simulation as an FMU.
 //
 int fmuExportIdfData::isLeapYear(fileReaderData& frIdf, int &leapYear)
 {
 	//
 	int lineNo;
-	int nLeapYear;
-	string inputKey, iddDesc;
-	string line, inputKeyExt;
-	ofstream runWeafile;
-	runWeafile.open("runweafile.epw");
+	int iLine;
+	bool gotLeapYear;
+	string line;
 	//
 #ifdef _DEBUG
 	assert(!frIdf.isEOF());
@@ -1024,45 +1252,45 @@ int fmuExportIdfData::isLeapYear(fileReaderData& frIdf, int &leapYear)
 	// Initialize.
 	lineNo = 0;
 	leapYear = 0;
-	nLeapYear = 0;
+	gotLeapYear = false;
 	_goodRead = true;
 	//
-	// Run through the IDF file.
-	while (_goodRead)
+	// Run through the header lines only.
+	//   The leap year indicator is the first field of the HOLIDAYS/DAYLIGHT SAVINGS
+	// line, e.g. "HOLIDAYS/DAYLIGHT SAVINGS,Yes,0,0,0".
+	for (iLine = 0; iLine < EPW_HEADER_LINES; ++iLine)
 	{
-		frIdf.getToken(",", IDF_COMMENT_CHARS, inputKey, inputKeyExt);
-		// Consume the delimiter that caused getToken() to return.
-		const char delimChar = frIdf.getChar();
-		capitalize(inputKey);
-		if (inputKey.find(g_key_leapYear) != string::npos){
-			nLeapYear++;
-			runWeafile << inputKeyExt;
-			frIdf.getToken(",", IDF_COMMENT_CHARS, inputKey, inputKeyExt);
-			capitalize(inputKey);
-			if (0== inputKey.compare("YES")){
+		frIdf.getLine(line, lineNo);
+		capitalize(line);
+		if (0 == line.compare(0, g_key_leapYear.length(), g_key_leapYear))
+		{
+			const size_t fieldStart = line.find(',');
+			string field;
+			if (fieldStart != string::npos)
+			{
+				field = line.substr(fieldStart + 1, line.find(',', fieldStart + 1) - fieldStart - 1);
+				trimEnd(field);
+			}
+			if (0 == field.compare("YES")){
 				leapYear = 1;
 			}
+			gotLeapYear = true;
+			break;
 		}
-		// Write weather file
-		runWeafile << inputKeyExt;
 		if (frIdf.isEOF())
 		{
-			// Here, hit EOF.
-			//   OK to hit EOF, provided don't actually have a keyword.
-			if (nLeapYear == 0){
-				cout << "Finish reading weather file without finding leap year indicator." << endl;
-			}
-			else{
-				cout << "Successfully finish reading weather file." << endl;
-			}
 			break;
 		}
-		// Here, ready to look for next keyword.
+	}
+	if (gotLeapYear){
+		*_infoStream << "Successfully finish reading weather file." << endl;
+	}
+	else{
+		*_infoStream << "Finish reading weather file without finding leap year indicator." << endl;
 	}
 
-	// Here, ran through whole IDF file.
+	// Here, read the header of the weather file.
 	frIdf.close();
-	runWeafile.close();
 	//
 	if (_goodRead)
 	{
@@ -1082,7 +1310,7 @@ int fmuExportIdfData::getTimeStep(fileReaderData& frIdf)
 	string inputKey, iddDesc;
 	string line;
 	ofstream tStepfile;
-	tStepfile.open("tstep.txt");
+	tStepfile.open((_runFilePrefix + "tstep.txt").c_str());
 	//
 #ifdef _DEBUG
 	assert(!frIdf.isEOF());
@@ -1211,7 +1439,7 @@ int fmuExportIdfData::getIDFVersion(fileReaderData& frIdf, int &idfVersion)
 				idfVersion = std::stoi(inputKey, nullptr, 10);
 				break;
 			}
-			cout << "The IDF version found is :" << idfVersion << endl;
+			*_infoStream << "The IDF version found is :" << idfVersion << endl;
 			//_goodRead = false;
 		}
 		if (frIdf.isEOF())
@@ -1274,6 +1502,10 @@ void fmuExportIdfData::reportError(std::ostringstream& errorMessage) const
     {
     (*_externalErrorFcn)(errorMessage);
     }
+  else if( _externalErrorStream )
+    {
+    *_externalErrorStream << errorMessage.str() << endl;
+    }
   else
     {
     // Here, no user-supplied error fcn.
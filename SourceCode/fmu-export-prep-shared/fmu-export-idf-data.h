@@ -15,6 +15,7 @@
 //
 //#include <fstream>
 //#include <string>
+#include <set>
 
 #include "../read-ep-file/ep-idd-map.h"
 #include "../read-ep-file/fileReaderData.h"
@@ -34,6 +35,20 @@ public:
   /// \param errFcn Pointer to function to be called in case of an error.
   void attachErrorFcn(void (*errFcn)(std::ostringstream& errorMessage));
 
+  /// Attach a stream, to which errors are written if no error-reporting function is attached.
+  /// \param errStream Stream that collects the errors.
+  void attachErrorStream(std::ostream& errStream);
+
+  /// Set the stream of the progress messages.
+  /// \param infoStream Stream to which progress messages are written.  By default,
+  ///        they are written to \c std::cout.
+  void setInfoStream(std::ostream& infoStream);
+
+  /// Set the directory in which to write the files of the run.
+  /// \param runDirName Path to the directory.  By default, the files are written
+  ///        to the current directory.
+  void setRunDirectory(const string& runDirName);
+
 
   //--- Validate IDD file.
   //
@@ -44,6 +59,13 @@ public:
   /// \return 1 if \c idd is compatible with expected entries for method \c populateFromIDF().
   bool haveValidIDD(const iddMap& idd, string& errStr) const;
 
+  /// Get the keywords of the Input Data Dictionary that \c haveValidIDD() checks.
+  //
+  //   Use with \c fileReaderDictionary::getMap(), to read only these keywords.
+  //
+  /// \retval keywords Set to which the keywords are added.
+  void getIddKeywords(std::set<string>& keywords) const;
+
   /// Read IDF file, collecting data needed to export an EnergyPlus simulation as an FMU.
   //
   /// \param frIdf IDF-file reader, configured to read from EnergyPlus Input Data File of interest.
@@ -59,10 +81,23 @@ public:
   /// \return 0 on success; or IDF line number where encountered a problem.
   int writeInputFile(fileReaderData& frIdf, int leapYear, int idfVer, string tStartFMU, string tStopFMU);
 
-  /// Read Weather file, collecting data needed to export an EnergyPlus simulation as an FMU.
+  /// Read IDF file once, writing the input file and the time step file of the run.
+  //
+  /// \param frIdf IDF-file reader, configured to read from EnergyPlus Input Data File of interest.
+  /// \param leapYear 1 if leap year 0 else.
+  /// \param idfVersion The IDF version extracted from the IDF file.
+  /// \param needInputFile Set to true if the RunPeriod precedes the Version, in which
+  ///        case the input file must be written with \c writeInputFile().
+  /// \return 0 on success; or IDF line number where encountered a problem.
+  int writeRunFiles(fileReaderData& frIdf, int leapYear, string tStartFMU, string tStopFMU,
+    int &idfVersion, bool &needInputFile);
+
+  /// Read the header of the Weather file, and get the leap year indicator.
   //
+  /// Only reads the header lines. The weather file is made available to
+  /// EnergyPlus by the caller, see \c linkOrCopyFile().
   /// \param frIdf Weather-file reader, configured to read from EnergyPlus Weather Data File of interest.
-  /// \return 1 if Leapyear success; or Weather line number where encountered a problem.
+  /// \return 0 on success; or Weather line number where encountered a problem.
   int isLeapYear(fileReaderData& frIdf, int &leapYear);
 
   /// Read Weather file, collecting data needed to export an EnergyPlus simulation as an FMU.
@@ -115,7 +150,10 @@ private:
   //
   bool _goodRead;
   void (*_externalErrorFcn)(std::ostringstream& errorMessage);
+  std::ostream* _externalErrorStream;
+  std::ostream* _infoStream;
   bool _gotKeyExtInt;
+  std::string _runFilePrefix;
 
   //-- Private methods.
   //
@@ -126,6 +164,8 @@ private:
   void handleKey_extInt_fmuExport_fromVar(fileReaderData& frIdf);
   void handleKey_extInt_fmuExport_toVar(fileReaderData& frIdf);
   void handleKey_runPer(fileReaderData& frIdf, int idfVer);
+  void writeRunPeriod(fileReaderData& frIdf, std::ostream& runInfile,
+    int leapYear, int idfVer, const string& tStartFMU, const string& tStopFMU);
   //int handleKey_timeStep(fileReaderData& frIdf);
 
 };
@@ -0,0 +1,398 @@
+//--- Prepare the input files of an EnergyPlus simulation run by an FMU.
+
+
+//--- Copyright notice.
+//
+//   Please see the header file.
+
+
+//--- Includes.
+//
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <string>
+using std::string;
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _MSC_VER
+  #include <direct.h>
+  #include <process.h>
+#else
+  #include <unistd.h>
+#endif
+
+#include <iostream>
+
+#include "fmu-export-prep-lib.h"
+#include "fmu-export-idf-data.h"
+
+#include "../read-ep-file/ep-idd-map.h"
+#include "../read-ep-file/fileReader.h"
+#include "../read-ep-file/fileReaderData.h"
+#include "../read-ep-file/fileReaderDictionary.h"
+
+#include "../utility/digest-md5.h"
+#include "../utility/file-help.h"
+
+
+//--- File-scope constants.
+//
+//   Files of the run, in the current directory.  The weather file is last,
+// since it is written only if a weather file is given.
+static const char *const g_runFileNames[] = {
+  "runinfile.idf",
+  "tstep.txt",
+  "runweafile.epw"
+  };
+//
+//   Tag hashed into every cache key.  Change it whenever the contents of
+// the run files change, so that stale cache entries are not served.
+static const char *const g_cacheKeyTag = "fmu-export-prep-run-files-1";
+
+
+//--- Functions.
+//
+static bool writeRunFiles(const string& runFilePrefix, const char *iddFileName,
+  const char *idfFileName, const char *wthFileName, const char *tStartFMU,
+  const char *tStopFMU, std::ostringstream& errStream);
+static void getCacheKey(const char *idfFileName, const char *wthFileName,
+  const char *tStartFMU, const char *tStopFMU, char cacheKey[33]);
+static void addFileToCacheKey(std::ostream& keyStream, const char *fileName);
+static bool linkRunFilesFromCache(const string& runFilePrefix,
+  const string& entryDirName, const int numRunFiles);
+static void addRunFilesToCache(const string& runFilePrefix,
+  const char *cacheDirName, const char *cacheKey, const int numRunFiles);
+static int makeDir(const char *dirName);
+
+
+//--- Write the input files of an EnergyPlus simulation run by an FMU.
+//
+int fmuExportPrep_writeRunFiles(const char *iddFileName,
+  const char *idfFileName, const char *wthFileName,
+  const char *tStartFMU, const char *tStopFMU,
+  char *errMsg, size_t errMsgLen)
+  {
+  //
+  return( fmuExportPrep_writeRunFilesCached(NULL, NULL, iddFileName, idfFileName,
+    wthFileName, tStartFMU, tStopFMU, NULL, errMsg, errMsgLen) );
+  }  // End fcn fmuExportPrep_writeRunFiles().
+
+
+//--- Write the input files of an EnergyPlus simulation run by an FMU, using a cache.
+//
+int fmuExportPrep_writeRunFilesCached(const char *runDirName, const char *cacheDirName,
+  const char *iddFileName, const char *idfFileName, const char *wthFileName,
+  const char *tStartFMU, const char *tStopFMU,
+  int *fromCache, char *errMsg, size_t errMsgLen)
+  {
+  //
+  std::ostringstream errStream;
+  bool success;
+  const int numRunFiles = ( NULL == wthFileName ) ? 2 : 3;
+  char cacheKey[33];
+  //
+  // Prefix for the names of the run files, so that the current directory,
+  // which is shared by all threads, is not used.
+  string runFilePrefix;
+  if( NULL != runDirName && '\0' != runDirName[0] )
+    {
+    runFilePrefix = runDirName;
+    const char lastChar = runFilePrefix[runFilePrefix.size()-1];
+    if( '/' != lastChar && '\\' != lastChar )
+      runFilePrefix.push_back('/');
+    }
+  //
+  if( NULL != fromCache )
+    *fromCache = 0;
+  //
+  if( NULL == iddFileName || NULL == idfFileName || NULL == tStartFMU || NULL == tStopFMU )
+    {
+    errStream << "Missing IDD file, IDF file, start time or stop time.";
+    success = false;
+    }
+  else
+    {
+    //
+    // Look for the files of an identical run in the cache.
+    if( NULL != cacheDirName )
+      {
+      getCacheKey(idfFileName, wthFileName, tStartFMU, tStopFMU, cacheKey);
+      if( linkRunFilesFromCache(runFilePrefix, string(cacheDirName) + "/" + cacheKey, numRunFiles) )
+        {
+        if( NULL != fromCache )
+          *fromCache = 1;
+        return( 0 );
+        }
+      }
+    //
+    // Here, need to write the files.  Remove old ones first, in case they
+    // are links into the cache, which must not be overwritten.
+    for( int idx=0; idx<3; ++idx )
+      remove((runFilePrefix + g_runFileNames[idx]).c_str());
+    //
+    // The readers throw rather than terminate the process of the FMU.
+    try
+      {
+      success = writeRunFiles(runFilePrefix, iddFileName, idfFileName, wthFileName,
+        tStartFMU, tStopFMU, errStream);
+      }
+    catch( const fileReaderError& err )
+      {
+      errStream << "Error while reading an input file: " << err.what();
+      success = false;
+      }
+    catch( const std::exception& err )
+      {
+      errStream << "Unexpected error: " << err.what();
+      success = false;
+      }
+    //
+    if( success && NULL != cacheDirName )
+      addRunFilesToCache(runFilePrefix, cacheDirName, cacheKey, numRunFiles);
+    }
+  //
+  if( ! success && NULL != errMsg && 0 < errMsgLen )
+    {
+    strncpy(errMsg, errStream.str().c_str(), errMsgLen-1);
+    errMsg[errMsgLen-1] = '\0';
+    }
+  return( success ? 0 : 1 );
+  }  // End fcn fmuExportPrep_writeRunFilesCached().
+
+
+//--- Make a file available under a new name.
+//
+int fmuExportPrep_linkOrCopyFile(const char *srcFileName, const char *dstFileName)
+  {
+  string errStr;
+  //
+  return( linkOrCopyFile(srcFileName, dstFileName, errStr) ? 0 : 1 );
+  }  // End fcn fmuExportPrep_linkOrCopyFile().
+
+
+//--- Find the cache key of a run.
+//
+//   The run files depend only on the contents of the IDF and weather files,
+// and on the start and stop time.
+//
+static void getCacheKey(const char *idfFileName, const char *wthFileName,
+  const char *tStartFMU, const char *tStopFMU, char cacheKey[33])
+  {
+  std::ostringstream keyStream;
+  //
+  keyStream << g_cacheKeyTag << '\n';
+  addFileToCacheKey(keyStream, idfFileName);
+  if( NULL != wthFileName )
+    addFileToCacheKey(keyStream, wthFileName);
+  else
+    keyStream << "none\n";
+  keyStream << tStartFMU << '\n' << tStopFMU;
+  digest_md5_fromStr(keyStream.str().c_str(), cacheKey);
+  }  // End fcn getCacheKey().
+
+
+//--- Add the contents of an input file to a cache key.
+//
+//   As in {iddCache_read()}, use the size and modification time of the file,
+// and its inode, so that a hit does not read the file.  The change time is
+// not used, as linking the file into the cache changes it.  A file modified
+// in the last seconds may change again without changing its state, so use
+// the digest of its contents instead.  Such a run misses the entries keyed
+// on the state, which only costs writing its files again.
+//
+static void addFileToCacheKey(std::ostream& keyStream, const char *fileName)
+  {
+  struct stat st;
+  char digest[33];
+  const time_t now = time(NULL);
+  //
+  if( 0 == stat(fileName, &st) && st.st_mtime < now - 1 )
+    {
+    keyStream << "state " << (long long)st.st_size << ' ' << (long long)st.st_mtime << ' '
+      << (long long)st.st_dev << ' ' << (long long)st.st_ino << '\n';
+    return;
+    }
+  digest_md5_fromFile(fileName, digest);
+  keyStream << "digest " << digest << '\n';
+  }  // End fcn addFileToCacheKey().
+
+
+//--- Link the run files from a cache entry into the run directory.
+//
+//   Return {true} if the entry exists.  Entries are added complete, see
+// {addRunFilesToCache()}, so if the first file exists, they all do.
+//
+static bool linkRunFilesFromCache(const string& runFilePrefix,
+  const string& entryDirName, const int numRunFiles)
+  {
+  string errStr;
+  //
+  for( int idx=0; idx<numRunFiles; ++idx )
+    {
+    const string cacheFileName = entryDirName + "/" + g_runFileNames[idx];
+    const string runFileName = runFilePrefix + g_runFileNames[idx];
+    if( ! linkOrCopyFile(cacheFileName.c_str(), runFileName.c_str(), errStr) )
+      return( false );
+    }
+  //
+  return( true );
+  }  // End fcn linkRunFilesFromCache().
+
+
+//--- Add the run files in the run directory to the cache.
+//
+//   Link the files into a directory private to this process and run
+// directory, then rename it to the name of the entry.  Renaming a directory
+// is atomic, so other processes and threads see either no entry or a
+// complete one.  If another one added the same entry first, keep that one.
+//   Failing to add an entry is not an error.  The next run will write its
+// files again.
+//
+static void addRunFilesToCache(const string& runFilePrefix,
+  const char *cacheDirName, const char *cacheKey, const int numRunFiles)
+  {
+  string errStr;
+  char runDirDigest[33];
+  int idx;
+  //
+  makeDir(cacheDirName);
+  //
+  // Threads of one process run in different run directories.
+  digest_md5_fromStr(runFilePrefix.c_str(), runDirDigest);
+  runDirDigest[8] = '\0';
+  std::ostringstream tmpDirStream;
+  tmpDirStream << cacheDirName << "/" << cacheKey << ".tmp-"
+#ifdef _MSC_VER
+    << _getpid()
+#else
+    << getpid()
+#endif
+    << "-" << runDirDigest;
+  const string tmpDirName = tmpDirStream.str();
+  if( 0 != makeDir(tmpDirName.c_str()) )
+    return;
+  //
+  for( idx=0; idx<numRunFiles; ++idx )
+    {
+    const string tmpFileName = tmpDirName + "/" + g_runFileNames[idx];
+    const string runFileName = runFilePrefix + g_runFileNames[idx];
+    if( ! linkOrCopyFile(runFileName.c_str(), tmpFileName.c_str(), errStr) )
+      break;
+    }
+  //
+  const string entryDirName = string(cacheDirName) + "/" + cacheKey;
+  if( idx < numRunFiles || 0 != rename(tmpDirName.c_str(), entryDirName.c_str()) )
+    {
+    for( idx=0; idx<numRunFiles; ++idx )
+      remove((tmpDirName + "/" + g_runFileNames[idx]).c_str());
+#ifdef _MSC_VER
+    _rmdir(tmpDirName.c_str());
+#else
+    rmdir(tmpDirName.c_str());
+#endif
+    }
+  }  // End fcn addRunFilesToCache().
+
+
+//--- Make a directory.
+//
+//   Return 0 on success.
+//
+static int makeDir(const char *dirName)
+  {
+#ifdef _MSC_VER
+  return( _mkdir(dirName) );
+#else
+  return( mkdir(dirName, 0755) );
+#endif
+  }  // End fcn makeDir().
+
+
+//--- Read IDD, IDF and weather file, and write the files of the run.
+//
+//   Return {true} on success.  Otherwise, write the reason to {errStream}.
+//
+//   The errors of the readers are also written to {errStream}, and their
+// progress messages are dropped, so that nothing is written to the standard
+// streams or to the log file of a master program that links this function.
+//
+static bool writeRunFiles(const string& runFilePrefix, const char *iddFileName,
+  const char *idfFileName, const char *wthFileName, const char *tStartFMU,
+  const char *tStopFMU, std::ostringstream& errStream)
+  {
+  //
+  fmuExportIdfData fmuIdfData;
+  fmuIdfData.setRunDirectory(runFilePrefix);
+  fmuIdfData.attachErrorStream(errStream);
+  std::ostream noInfoStream(NULL);
+  fmuIdfData.setInfoStream(noInfoStream);
+  int idfVer = 0;
+  int leapYear = 0;
+  int failLine;
+  bool needInputFile;
+  //
+  // Set up data dictionary.
+  fileReaderDictionary frIdd(iddFileName);
+  frIdd.attachErrorStream(errStream);
+  frIdd.open();
+  iddMap idd;
+  frIdd.getMapCached(idd);
+  //
+  // Check data dictionary.
+  string errStr;
+  if( ! fmuIdfData.haveValidIDD(idd, errStr) )
+    {
+    errStream << "Incompatible IDD file " << iddFileName << ": " << errStr;
+    return( false );
+    }
+  //
+  // Get leap year indicator, and link weather file.
+  if( NULL != wthFileName )
+    {
+    fileReaderData frWth(wthFileName, IDF_DELIMITERS_ENTRY, IDF_DELIMITERS_SECTION);
+    frWth.attachErrorStream(errStream);
+    frWth.open();
+    failLine = fmuIdfData.isLeapYear(frWth, leapYear);
+    if( 0 < failLine )
+      {
+      errStream << "Error detected while reading Weather file " << wthFileName << ", at line #" << failLine;
+      return( false );
+      }
+    if( ! linkOrCopyFile(wthFileName, (runFilePrefix + g_runFileNames[2]).c_str(), errStr) )
+      {
+      errStream << errStr;
+      return( false );
+      }
+    }
+  //
+  // Write IDF file with the run period of the FMU, and time step, in one pass.
+  fileReaderData frIdf(idfFileName, IDF_DELIMITERS_ENTRY, IDF_DELIMITERS_SECTION);
+  frIdf.attachErrorStream(errStream);
+  frIdf.open();
+  failLine = fmuIdfData.writeRunFiles(frIdf, leapYear, tStartFMU, tStopFMU, idfVer, needInputFile);
+  if( 0 < failLine )
+    {
+    errStream << "Error detected while reading IDF file " << idfFileName << ", at line #" << failLine;
+    return( false );
+    }
+  //
+  // Rewrite IDF file if its RunPeriod precedes the version.
+  if( needInputFile )
+    {
+    fileReaderData frIdf1(idfFileName, IDF_DELIMITERS_ENTRY, IDF_DELIMITERS_SECTION);
+    frIdf1.attachErrorStream(errStream);
+    frIdf1.open();
+    failLine = fmuIdfData.writeInputFile(frIdf1, leapYear, idfVer, tStartFMU, tStopFMU);
+    if( 0 < failLine )
+      {
+      errStream << "Error detected while reading IDF file " << idfFileName << ", at line #" << failLine;
+      return( false );
+      }
+    }
+  //
+  // Here, successfully wrote the files of the run.
+  return( true );
+  }  // End fcn writeRunFiles().
@@ -0,0 +1,176 @@
+//--- Prepare the input files of an EnergyPlus simulation run by an FMU.
+//
+/// \brief  Prepare the input files of an EnergyPlus simulation run by an FMU.
+///
+/// The FMU calls these functions from \c fmi2EnterInitializationMode,
+/// rather than running the export-prep application in a new process.
+/// The functions write the files into the current directory, or into
+/// a given run directory, as the application does when it is called
+/// with a start and stop time:
+/// ** \c runinfile.idf, the IDF file with the run period of the FMU.
+/// ** \c runweafile.epw, a link to or copy of the weather file, if one is given.
+/// ** \c tstep.txt, the number of time steps per hour.
+
+
+#if !defined(__FMU_EXPORT_PREP_LIB__)
+#define __FMU_EXPORT_PREP_LIB__
+
+
+//--- Includes.
+//
+#include <stddef.h>
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//--- Write the input files of an EnergyPlus simulation run by an FMU.
+//
+//   Arguments:
+// ** {iddFileName}, path to the EnergyPlus input data dictionary (IDD).
+// ** {idfFileName}, path to the EnergyPlus input data file (IDF).
+// ** {wthFileName}, path to the weather file, or NULL if there is none.
+// ** {tStartFMU}, start time of the FMU, in seconds.
+// ** {tStopFMU}, stop time of the FMU, in seconds.
+// ** {errMsg}, buffer for a message if an error occurs, or NULL.
+// ** {errMsgLen}, number of characters of {errMsg}.
+//
+//   Return 0 on success, or 1 if an error occurred.  Errors in the input
+// files are written to {errMsg}.  Nothing is written to the standard
+// streams or to a log file.
+//
+int fmuExportPrep_writeRunFiles(const char *iddFileName,
+  const char *idfFileName, const char *wthFileName,
+  const char *tStartFMU, const char *tStopFMU,
+  char *errMsg, size_t errMsgLen);
+
+
+//--- Write the input files of an EnergyPlus simulation run by an FMU, using a cache.
+//
+//   As {fmuExportPrep_writeRunFiles()}, but write the files into directory
+// {runDirName}, and first look for the files of an identical run in
+// directory {cacheDirName}.  Runs are identical if they have the same IDF
+// and weather file contents, and the same start and stop time.  On a hit,
+// the files are hard linked into the run directory, and are shared with
+// the cache, so they must not be written to.  On a miss, the files are
+// written, then added to the cache.
+//   The current directory is not used, except to log errors in the input
+// files, so threads may prepare runs in different run directories
+// concurrently.
+//
+//   Additional arguments:
+// ** {runDirName}, path to the directory of the run.  If NULL, use the
+// current directory.
+// ** {cacheDirName}, path to the cache directory, which is created if needed.
+// If NULL, do not use a cache.
+// ** {fromCache}, set to 1 if the files came from the cache, else to 0.
+// May be NULL.
+//
+int fmuExportPrep_writeRunFilesCached(const char *runDirName, const char *cacheDirName,
+  const char *iddFileName, const char *idfFileName, const char *wthFileName,
+  const char *tStartFMU, const char *tStopFMU,
+  int *fromCache, char *errMsg, size_t errMsgLen);
+
+
+//--- Make a file available under a new name, without copying it if possible.
+//
+//   As the run files taken from the cache, {dstFileName} is a hard link to
+// {srcFileName}, or a copy if a link cannot be made.  An existing
+// {dstFileName} is replaced.  The caller must not write to {dstFileName}.
+//
+//   Return 0 on success, or 1 if an error occurred.
+//
+int fmuExportPrep_linkOrCopyFile(const char *srcFileName, const char *dstFileName);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif // __FMU_EXPORT_PREP_LIB__
+
+
+/*
+***********************************************************************************
+Copyright Notice
+----------------
+
+Functional Mock-up Unit Export of EnergyPlus (C)2013, The Regents of
+the University of California, through Lawrence Berkeley National
+Laboratory (subject to receipt of any required approvals from
+the U.S. Department of Energy). All rights reserved.
+
+If you have questions about your rights to use or distribute this software,
+please contact Berkeley Lab's Technology Transfer Department at
+TTD@lbl.gov.referring to "Functional Mock-up Unit Export
+of EnergyPlus (LBNL Ref 2013-088)".
+
+NOTICE: This software was produced by The Regents of the
+University of California under Contract No. DE-AC02-05CH11231
+with the Department of Energy.
+For 5 years from November 1, 2012, the Government is granted for itself
+and others acting on its behalf a nonexclusive, paid-up, irrevocable
+worldwide license in this data to reproduce, prepare derivative works,
+and perform publicly and display publicly, by or on behalf of the Government.
+There is provision for the possible extension of the term of this license.
+Subsequent to that period or any extension granted, the Government is granted
+for itself and others acting on its behalf a nonexclusive, paid-up, irrevocable
+worldwide license in this data to reproduce, prepare derivative works,
+distribute copies to the public, perform publicly and display publicly,
+and to permit others to do so. The specific term of the license can be identified
+by inquiry made to Lawrence Berkeley National Laboratory or DOE. Neither
+the United States nor the United States Department of Energy, nor any of their employees,
+makes any warranty, express or implied, or assumes any legal liability or responsibility
+for the accuracy, completeness, or usefulness of any data, apparatus, product,
+or process disclosed, or represents that its use would not infringe privately owned rights.
+
+
+Copyright (c) 2013, The Regents of the University of California, Department
+of Energy contract-operators of the Lawrence Berkeley National Laboratory.
+All rights reserved.
+
+1. Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+(1) Redistributions of source code must retain the copyright notice, this list
+of conditions and the following disclaimer.
+
+(2) Redistributions in binary form must reproduce the copyright notice, this list
+of conditions and the following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+(3) Neither the name of the University of California, Lawrence Berkeley
+National Laboratory, U.S. Dept. of Energy nor the names of its contributors
+may be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+2. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+3. You are under no obligation whatsoever to provide any bug fixes, patches,
+or upgrades to the features, functionality or performance of the source code
+("Enhancements") to anyone; however, if you choose to make your Enhancements
+available either publicly, or directly to Lawrence Berkeley National Laboratory,
+without imposing a separate written license agreement for such Enhancements,
+then you hereby grant the following license: a non-exclusive, royalty-free
+perpetual license to install, use, modify, prepare derivative works, incorporate
+into other computer software, distribute, and sublicense such enhancements or
+derivative works thereof, in binary and source code form.
+
+NOTE: This license corresponds to the "revised BSD" or "3-clause BSD"
+License and includes the following modification: Paragraph 3. has been added.
+
+
+***********************************************************************************
+*/
@@ -16,6 +16,7 @@ using std::endl;
 
 #include "app-cmdln-input.h"
 #include "fmu-export-idf-data.h"
+#include "fmu-export-prep-lib.h"
 // Reference to version 1.0 for the next include since it
 // is not different from v20.
 #include "../v10/fmu-export-prep/fmu-export-write-model-desc.h"
@@ -37,9 +38,6 @@ using std::endl;
 //
 static void getIdfData(cmdlnInput_s& cmdlnInput, fmuExportIdfData& fmuIdfData);
 
-//
-static void getInputData(cmdlnInput_s& cmdlnInput, fmuExportIdfData& fmuIdfData);
-
 
 //--- Main driver.
 //
@@ -56,7 +54,15 @@ int main(int argc, const char* argv[])
 	fmuExportIdfData fmuIdfData;
 	if (!cmdlnInput.tStartFMU && !cmdlnInput.tStopFMU){
 		cout << "Reading input and weather file for EnergyPlusToFMU program." << endl;
-		getIdfData(cmdlnInput, fmuIdfData);
+		try
+		{
+			getIdfData(cmdlnInput, fmuIdfData);
+		}
+		catch (const fileReaderError&)
+		{
+			// The reader has reported the error.
+			return(EXIT_FAILURE);
+		}
 		//
 		// Write {modelDescription.xml}.
 		std::ofstream outStream;
@@ -85,7 +91,14 @@ int main(int argc, const char* argv[])
 	}
 	else{
 		cout << "Reading input and weather file for preprocessor program." << endl;
-		getInputData(cmdlnInput, fmuIdfData);
+		// Same files as written by the FMU, which links the function directly.
+		char errMsg[1024];
+		if (0 != fmuExportPrep_writeRunFiles(cmdlnInput.iddFileName, cmdlnInput.idfFileName,
+			cmdlnInput.wthFileName, cmdlnInput.tStartFMU, cmdlnInput.tStopFMU, errMsg, sizeof(errMsg)))
+		{
+			cout << errMsg << endl;
+			return(EXIT_FAILURE);
+		}
 	}
 	//
 	// Finalize.
@@ -147,8 +160,11 @@ static void getIdfData(cmdlnInput_s& cmdlnInput, fmuExportIdfData& fmuIdfData)
   fileReaderDictionary frIdd(cmdlnInput.iddFileName);
   frIdd.attachErrorFcn(reportInputError);
   frIdd.open();
+  //   Read only the keywords to check, rather than the whole file.
   iddMap idd;
-  frIdd.getMap(idd);  // Terminates on error.
+  std::set<string> iddKeywords;
+  fmuIdfData.getIddKeywords(iddKeywords);
+  frIdd.getMap(idd, iddKeywords);  // Throws {fileReaderError} on error.
   //
   // Check data dictionary.
   string errStr;
@@ -185,88 +201,6 @@ static void getIdfData(cmdlnInput_s& cmdlnInput, fmuExportIdfData& fmuIdfData)
   }  // End fcn getIdfData().
 
 
-//--- Read required data from IDF file.
-//
-static void getInputData(cmdlnInput_s& cmdlnInput, fmuExportIdfData& fmuIdfData)
-{
-	//
-	// Set up data dictionary.
-	fileReaderDictionary frIdd(cmdlnInput.iddFileName);
-	int idfVer;
-	frIdd.attachErrorFcn(reportInputError);
-	frIdd.open();
-	iddMap idd;
-	int timeStep;
-	int leapYear;
-	frIdd.getMap(idd);  // Terminates on error.
-	//
-	// Check data dictionary.
-	string errStr;
-	if (!fmuIdfData.haveValidIDD(idd, errStr))
-	{
-		cout << "Incompatible IDD file " << cmdlnInput.iddFileName <<
-			endl << errStr << endl;
-		exit(EXIT_FAILURE);
-	}
-
-
-	//
-	// Initialize IDF file and get IDFVersion.
-	fileReaderData frIdf0(cmdlnInput.idfFileName, IDF_DELIMITERS_ENTRY, IDF_DELIMITERS_SECTION);
-	frIdf0.attachErrorFcn(reportInputError);
-	frIdf0.open();
-	// Read IDF file for data of interest.
-	int failLine = fmuIdfData.getIDFVersion(frIdf0, idfVer);
-	if (0 < failLine)
-	{
-		cout << "Error detected while reading IDF version of IDF file " << cmdlnInput.idfFileName << ", at line #" << failLine << endl;
-		exit(EXIT_FAILURE);
-	}
-
-	cout << "The IDF version of the input file " << cmdlnInput.idfFileName << " starts with " << idfVer << endl;
-
-	// Initialize weather data file.
-	fileReaderData frIdf1(cmdlnInput.wthFileName, IDF_DELIMITERS_ENTRY, IDF_DELIMITERS_SECTION);
-	frIdf1.attachErrorFcn(reportInputError);
-	frIdf1.open();
-	// Read IDF file for data of interest.
-	failLine = fmuIdfData.isLeapYear(frIdf1, leapYear);
-	if (0 < failLine)
-	{
-		cout << "Error detected while reading Weather file " << cmdlnInput.wthFileName << ", at line #" << failLine << endl;
-		exit(EXIT_FAILURE);
-	}
-
-	// Initialize input data file.
-	fileReaderData frIdf2(cmdlnInput.idfFileName, IDF_DELIMITERS_ENTRY, IDF_DELIMITERS_SECTION);
-	frIdf2.attachErrorFcn(reportInputError);
-	frIdf2.open();
-	//
-	// Read IDF file for data of interest.
-	failLine = fmuIdfData.writeInputFile(frIdf2, leapYear, idfVer, cmdlnInput.tStartFMU, cmdlnInput.tStopFMU);
-	if (0 < failLine)
-	{
-		cout << "Error detected while reading IDF file " << cmdlnInput.idfFileName << ", at line #" << failLine << endl;
-		exit(EXIT_FAILURE);
-	}
-
-	// Initialize input data file.
-	fileReaderData frIdf3(cmdlnInput.idfFileName, IDF_DELIMITERS_ENTRY, IDF_DELIMITERS_SECTION);
-	frIdf3.attachErrorFcn(reportInputError);
-	frIdf3.open();
-	//
-	// Read IDF file for data of interest.
-	failLine = fmuIdfData.getTimeStep(frIdf3);
-	if (0 < failLine)
-	{
-		cout << "Error detected while reading IDF file " << cmdlnInput.idfFileName << ", at line #" << failLine << endl;
-		exit(EXIT_FAILURE);
-	}
-	//
-	// Here, successfully extracted data of interest from the IDF file.
-}  // End fcn getInputData().
-
-
 /*
 ***********************************************************************************
 Copyright Notice
@@ -0,0 +1,211 @@
+//--- Unit test for fmu-export-prep-lib.cpp.
+//
+/// \brief  Unit test for fmu-export-prep-lib.cpp.
+///
+/// Writes the files of a run from an IDD, IDF and weather file, checks
+/// that a missing input file is reported rather than terminating the
+/// process, checks that nothing is printed or logged by the library,
+/// checks that a second identical run is served from the cache,
+/// checks that the files can be written to a run directory, and reports
+/// the time per call.
+///
+/// Build on Linux, from this directory, with
+///   g++ -O2 -o utest-fmu-export-prep-lib utest-fmu-export-prep-lib.cpp fmu-export-prep-lib.cpp
+///     fmu-export-idf-data.cpp ../read-ep-file/char-scan.cpp ../read-ep-file/ep-idd-cache.cpp
+///     ../read-ep-file/ep-idd-map.cpp ../read-ep-file/fileReader.cpp
+///     ../read-ep-file/fileReaderData.cpp ../read-ep-file/fileReaderDictionary.cpp
+///     ../utility/digest-md5.cpp ../utility/file-help.cpp ../utility/string-help.cpp
+///     ../utility/utilReport.cpp
+
+
+//--- Includes.
+//
+#include <assert.h>
+#include <ctime>
+
+#include <cstdlib>
+#include <cstdio>
+
+#include <iostream>
+using std::cout;
+using std::endl;
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _MSC_VER
+  #include <direct.h>
+  #include <windows.h>
+#else
+  #include <unistd.h>
+#endif
+
+#include "fmu-export-prep-lib.h"
+
+
+//--- File-scope constants.
+//
+#define N_CALL 20
+#define CACHE_DIR "utest-cache"
+#define RUN_DIR "utest-run"
+
+
+//--- Read a whole file into a string.
+//
+static std::string readFile(const char *fileName) {
+  std::ifstream inStream(fileName, std::ios::binary);
+  std::ostringstream contents;
+  contents << inStream.rdbuf();
+  return( contents.str() );
+}  // End fcn readFile().
+
+
+//--- Wait until a file is keyed on its state in the cache.
+//
+//   A file changed in the last seconds is keyed on its digest instead, so a
+// test that starts right after its input files were copied would miss the
+// cache entries it added once the files become old enough.
+//
+static void waitUntilOld(const char *fileName) {
+  struct stat st;
+  while( 0 == stat(fileName, &st) && st.st_mtime >= time(NULL) - 2 ){
+#ifdef _MSC_VER
+    Sleep(1000);
+#else
+    sleep(1);
+#endif
+  }
+}  // End fcn waitUntilOld().
+
+
+//--- Main driver.
+//
+//   Write {runinfile.idf}, {runweafile.epw} and {tstep.txt} into the current
+// directory, for a run of one day.
+//
+int main(int argc, const char* argv[]) {
+  //
+  // Check arguments.
+  if( 4 != argc ){
+    cout << "Error: missing filename\nUsage: " << argv[0] << "  <name of IDD file>  <name of IDF file>  <name of weather file>\n";
+    return(1);
+  }
+  //
+  char errMsg[1024];
+  int call, retVal;
+  //
+  // Missing files are reported.
+  errMsg[0] = '\0';
+  retVal = fmuExportPrep_writeRunFiles(argv[1], "utest-missing.idf", argv[3],
+    "0.000000", "86400.000000", errMsg, sizeof(errMsg));
+  assert( 1 == retVal );
+  assert( '\0' != errMsg[0] );
+  cout << "Missing IDF file: " << errMsg << endl;
+  retVal = fmuExportPrep_writeRunFiles(NULL, argv[2], argv[3],
+    "0.000000", "86400.000000", errMsg, sizeof(errMsg));
+  assert( 1 == retVal );
+  //
+  // Without a weather file, no weather file is written.
+  remove("runweafile.epw");
+  retVal = fmuExportPrep_writeRunFiles(argv[1], argv[2], NULL,
+    "0.000000", "86400.000000", errMsg, sizeof(errMsg));
+  assert( 0 == retVal );
+  assert( NULL == fopen("runweafile.epw", "r") );
+  //
+  // Errors and progress messages are neither printed nor logged.
+  remove("output.log");
+  std::ostringstream outCapture;
+  std::streambuf *const outBuf = cout.rdbuf(outCapture.rdbuf());
+  const int retValMissing = fmuExportPrep_writeRunFiles(argv[1], "utest-missing.idf", argv[3],
+    "0.000000", "86400.000000", errMsg, sizeof(errMsg));
+  retVal = fmuExportPrep_writeRunFiles(argv[1], argv[2], argv[3],
+    "0.000000", "86400.000000", errMsg, sizeof(errMsg));
+  cout.rdbuf(outBuf);
+  assert( 1 == retValMissing );
+  assert( 0 == retVal );
+  assert( outCapture.str().empty() );
+  assert( NULL == fopen("output.log", "r") );
+  //
+  // Write the files of the run.
+  const clock_t tic = clock();
+  for( call=0; call<N_CALL; call++ ){
+    retVal = fmuExportPrep_writeRunFiles(argv[1], argv[2], argv[3],
+      "0.000000", "86400.000000", errMsg, sizeof(errMsg));
+    assert( 0 == retVal );
+  }
+  const double tCall = 1e3*(double)(clock()-tic)/CLOCKS_PER_SEC/N_CALL;
+  //
+  FILE *fp = fopen("runinfile.idf", "r");
+  assert( NULL != fp );
+  fclose(fp);
+  fp = fopen("runweafile.epw", "r");
+  assert( NULL != fp );
+  fclose(fp);
+  fp = fopen("tstep.txt", "r");
+  assert( NULL != fp );
+  fclose(fp);
+  //
+  const std::string runInfile = readFile("runinfile.idf");
+  const std::string tStep = readFile("tstep.txt");
+  //
+  // The first run fills the cache, and the second one is served from it.
+  int fromCache;
+  waitUntilOld(argv[2]);
+  waitUntilOld(argv[3]);
+  retVal = fmuExportPrep_writeRunFilesCached(NULL, CACHE_DIR, argv[1], argv[2], argv[3],
+    "0.000000", "86400.000000", &fromCache, errMsg, sizeof(errMsg));
+  assert( 0 == retVal );
+  remove("runinfile.idf");
+  remove("tstep.txt");
+  remove("runweafile.epw");
+  const clock_t ticCache = clock();
+  for( call=0; call<N_CALL; call++ ){
+    retVal = fmuExportPrep_writeRunFilesCached(NULL, CACHE_DIR, argv[1], argv[2], argv[3],
+      "0.000000", "86400.000000", &fromCache, errMsg, sizeof(errMsg));
+    assert( 0 == retVal );
+    assert( 1 == fromCache );
+  }
+  const double tCallCache = 1e3*(double)(clock()-ticCache)/CLOCKS_PER_SEC/N_CALL;
+  assert( runInfile == readFile("runinfile.idf") );
+  assert( tStep == readFile("tstep.txt") );
+  assert( readFile(argv[3]) == readFile("runweafile.epw") );
+  //
+  // A different stop time is a different run.
+  retVal = fmuExportPrep_writeRunFilesCached(NULL, CACHE_DIR, argv[1], argv[2], argv[3],
+    "0.000000", "172800.000000", &fromCache, errMsg, sizeof(errMsg));
+  assert( 0 == retVal );
+  assert( 0 == fromCache );
+  assert( runInfile != readFile("runinfile.idf") );
+  //
+  // Writing the run files again does not change the cache entry.
+  retVal = fmuExportPrep_writeRunFilesCached(NULL, CACHE_DIR, argv[1], argv[2], argv[3],
+    "0.000000", "86400.000000", &fromCache, errMsg, sizeof(errMsg));
+  assert( 0 == retVal );
+  assert( 1 == fromCache );
+  assert( runInfile == readFile("runinfile.idf") );
+  //
+  // The files can be written to a run directory, from the cache or not.
+#ifdef _MSC_VER
+  _mkdir(RUN_DIR);
+#else
+  mkdir(RUN_DIR, 0755);
+#endif
+  retVal = fmuExportPrep_writeRunFilesCached(RUN_DIR, CACHE_DIR, argv[1], argv[2], argv[3],
+    "0.000000", "86400.000000", &fromCache, errMsg, sizeof(errMsg));
+  assert( 0 == retVal );
+  assert( 1 == fromCache );
+  assert( runInfile == readFile(RUN_DIR "/runinfile.idf") );
+  retVal = fmuExportPrep_writeRunFilesCached(RUN_DIR, NULL, argv[1], argv[2], argv[3],
+    "0.000000", "86400.000000", &fromCache, errMsg, sizeof(errMsg));
+  assert( 0 == retVal );
+  assert( 0 == fromCache );
+  assert( runInfile == readFile(RUN_DIR "/runinfile.idf") );
+  assert( tStep == readFile(RUN_DIR "/tstep.txt") );
+  assert( readFile(argv[3]) == readFile(RUN_DIR "/runweafile.epw") );
+  //
+  cout << "Time per call: " << tCall << " ms" << endl;
+  cout << "Time per call from cache: " << tCallCache << " ms" << endl;
+  return( EXIT_SUCCESS );
+}  // End fcn main().
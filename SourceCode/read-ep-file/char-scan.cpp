@@ -0,0 +1,354 @@
+//--- Scan text for classes of characters, many bytes at a time.
+
+
+//--- Copyright notice.
+//
+//   Please see the header file.
+
+
+//--- Includes.
+//
+#include <string.h>
+
+#include "char-scan.h"
+
+
+//--- Preprocessor definitions.
+//
+//   SSE2 is part of every x86-64 processor.  AVX2 is compiled for the functions
+// that use it only, and used only if the processor supports it.
+//
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)) \
+  || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define CHAR_SCAN_HAVE_SSE2
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+    #include <immintrin.h>
+    #define CHAR_SCAN_HAVE_AVX2
+    #define CHAR_SCAN_TARGET_AVX2
+  #elif defined(__GNUC__)
+    #include <immintrin.h>
+    #define CHAR_SCAN_HAVE_AVX2
+    #define CHAR_SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+  #else
+    #include <emmintrin.h>
+  #endif
+#endif
+
+
+//--- Global variables.
+//
+//   Level of the implementation selected by \c charScan_setLevel(), or -1 for
+// the highest level the processor supports.
+static int charScanLevel = -1;
+
+
+//--- File-scope fcn prototypes.
+static int charScan_getMaxLevel(void);
+
+
+//--- Functions.
+
+
+//--- Index of the lowest set bit of a nonzero {mask}.
+//
+static inline int lowestBit(unsigned int mask){
+#if defined(_MSC_VER)
+  unsigned long idx;
+  _BitScanForward(&idx, mask);
+  return( (int)idx );
+#else
+  return( __builtin_ctz(mask) );
+#endif
+}
+
+
+//--- Number of set bits of {mask}.
+//
+static inline int bitCount(unsigned int mask){
+#if defined(_MSC_VER)
+  // The instruction popcnt may be missing on processors with SSE2 only.
+  mask = mask - ((mask >> 1) & 0x55555555u);
+  mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+  return( (int)((((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24) );
+#else
+  return( __builtin_popcount(mask) );
+#endif
+}
+
+
+//--- Check for a space character, as \c isspace() in the "C" locale.
+//
+static inline bool isSpaceChar(char ch){
+  return( ch == ' ' || (ch >= '\t' && ch <= '\r') );
+}
+
+
+//--- Fill a set with the characters of a string.
+//
+void charScan_setChars(const std::string& chars, charScanSet& set){
+  memset(set.has, 0, sizeof(set.has));
+  set.charCt = 0;
+  for( size_t idx=0; idx<chars.size(); ++idx ){
+    const unsigned char ch = (unsigned char)chars[idx];
+    if( set.has[ch] )
+      continue;
+    set.has[ch] = 1;
+    if( set.charCt >= 0 && set.charCt < CHAR_SCAN_MAX_VECTOR_CHARS )
+      set.chars[set.charCt++] = ch;
+    else
+      set.charCt = -1;
+  }
+}  // End fcn charScan_setChars().
+
+
+//--- One byte at a time.
+//
+static const char* findFirstOf_scalar(const char* begin, const char* end, const charScanSet& set){
+  while( begin < end && ! set.has[(unsigned char)*begin] )
+    ++begin;
+  return( begin );
+}
+
+static const char* findNonSpace_scalar(const char* begin, const char* end){
+  while( begin < end && isSpaceChar(*begin) )
+    ++begin;
+  return( begin );
+}
+
+static size_t countChar_scalar(const char* begin, const char* end, char ch){
+  size_t ct = 0;
+  for( ; begin < end; ++begin )
+    ct += ( *begin == ch );
+  return( ct );
+}
+
+
+#ifdef CHAR_SCAN_HAVE_SSE2
+//--- Sixteen bytes at a time.
+//
+//   The characters of the set are compared with the bytes, and the comparisons
+// are reduced to a bit mask of the bytes that match.
+//
+static const char* findFirstOf_sse2(const char* begin, const char* end, const charScanSet& set){
+  __m128i needle[CHAR_SCAN_MAX_VECTOR_CHARS];
+  const int charCt = set.charCt;
+  int idx;
+  for( idx=0; idx<charCt; ++idx )
+    needle[idx] = _mm_set1_epi8((char)set.chars[idx]);
+  while( end - begin >= 16 ){
+    const __m128i text = _mm_loadu_si128((const __m128i*)begin);
+    __m128i match = _mm_cmpeq_epi8(text, needle[0]);
+    for( idx=1; idx<charCt; ++idx )
+      match = _mm_or_si128(match, _mm_cmpeq_epi8(text, needle[idx]));
+    const unsigned int mask = (unsigned int)_mm_movemask_epi8(match);
+    if( mask != 0 )
+      return( begin + lowestBit(mask) );
+    begin += 16;
+  }
+  return( findFirstOf_scalar(begin, end, set) );
+}
+
+//   A byte is a space if it is ' ', or if it is in ['\t', '\r'], which is tested
+// as (byte - '\t') <= 4 without sign.
+//
+static inline unsigned int spaceMask_sse2(const __m128i text){
+  const __m128i shifted = _mm_sub_epi8(text, _mm_set1_epi8('\t'));
+  const __m128i inRange = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+  const __m128i space = _mm_or_si128(inRange, _mm_cmpeq_epi8(text, _mm_set1_epi8(' ')));
+  return( (unsigned int)_mm_movemask_epi8(space) );
+}
+
+static const char* findNonSpace_sse2(const char* begin, const char* end){
+  while( end - begin >= 16 ){
+    const unsigned int mask = ~spaceMask_sse2(_mm_loadu_si128((const __m128i*)begin)) & 0xFFFFu;
+    if( mask != 0 )
+      return( begin + lowestBit(mask) );
+    begin += 16;
+  }
+  return( findNonSpace_scalar(begin, end) );
+}
+
+static size_t countChar_sse2(const char* begin, const char* end, char ch){
+  const __m128i needle = _mm_set1_epi8(ch);
+  size_t ct = 0;
+  while( end - begin >= 16 ){
+    const __m128i text = _mm_loadu_si128((const __m128i*)begin);
+    ct += bitCount((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(text, needle)));
+    begin += 16;
+  }
+  return( ct + countChar_scalar(begin, end, ch) );
+}
+#endif  // CHAR_SCAN_HAVE_SSE2
+
+
+#ifdef CHAR_SCAN_HAVE_AVX2
+//--- Thirty-two bytes at a time.
+//
+CHAR_SCAN_TARGET_AVX2
+static const char* findFirstOf_avx2(const char* begin, const char* end, const charScanSet& set){
+  __m256i needle[CHAR_SCAN_MAX_VECTOR_CHARS];
+  const int charCt = set.charCt;
+  int idx;
+  for( idx=0; idx<charCt; ++idx )
+    needle[idx] = _mm256_set1_epi8((char)set.chars[idx]);
+  while( end - begin >= 32 ){
+    const __m256i text = _mm256_loadu_si256((const __m256i*)begin);
+    __m256i match = _mm256_cmpeq_epi8(text, needle[0]);
+    for( idx=1; idx<charCt; ++idx )
+      match = _mm256_or_si256(match, _mm256_cmpeq_epi8(text, needle[idx]));
+    const unsigned int mask = (unsigned int)_mm256_movemask_epi8(match);
+    if( mask != 0 )
+      return( begin + lowestBit(mask) );
+    begin += 32;
+  }
+  return( findFirstOf_sse2(begin, end, set) );
+}
+
+CHAR_SCAN_TARGET_AVX2
+static const char* findNonSpace_avx2(const char* begin, const char* end){
+  while( end - begin >= 32 ){
+    const __m256i text = _mm256_loadu_si256((const __m256i*)begin);
+    const __m256i shifted = _mm256_sub_epi8(text, _mm256_set1_epi8('\t'));
+    const __m256i inRange = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+    const __m256i space = _mm256_or_si256(inRange, _mm256_cmpeq_epi8(text, _mm256_set1_epi8(' ')));
+    const unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(space);
+    if( mask != 0 )
+      return( begin + lowestBit(mask) );
+    begin += 32;
+  }
+  return( findNonSpace_sse2(begin, end) );
+}
+
+CHAR_SCAN_TARGET_AVX2
+static size_t countChar_avx2(const char* begin, const char* end, char ch){
+  const __m256i needle = _mm256_set1_epi8(ch);
+  size_t ct = 0;
+  while( end - begin >= 32 ){
+    const __m256i text = _mm256_loadu_si256((const __m256i*)begin);
+    ct += bitCount((unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(text, needle)));
+    begin += 32;
+  }
+  return( ct + countChar_sse2(begin, end, ch) );
+}
+#endif  // CHAR_SCAN_HAVE_AVX2
+
+
+//--- Find the first character of a set.
+//
+const char* charScan_findFirstOf(const char* begin, const char* end, const charScanSet& set){
+  if( set.charCt == 0 )
+    return( end );
+  if( set.charCt > 0 ){
+    switch( charScan_getLevel() ){
+#ifdef CHAR_SCAN_HAVE_AVX2
+    case CHAR_SCAN_AVX2:
+      return( findFirstOf_avx2(begin, end, set) );
+#endif
+#ifdef CHAR_SCAN_HAVE_SSE2
+    case CHAR_SCAN_SSE2:
+      return( findFirstOf_sse2(begin, end, set) );
+#endif
+    default:
+      break;
+    }
+  }
+  return( findFirstOf_scalar(begin, end, set) );
+}  // End fcn charScan_findFirstOf().
+
+
+//--- Find the first occurrence of a character.
+//
+//   The C library already compares many bytes at a time.
+//
+const char* charScan_findChar(const char* begin, const char* end, char ch){
+  const char* found = (begin < end) ? (const char*)memchr(begin, ch, (size_t)(end-begin)) : NULL;
+  return( found != NULL ? found : end );
+}  // End fcn charScan_findChar().
+
+
+//--- Find the first character that is not a space.
+//
+const char* charScan_findNonSpace(const char* begin, const char* end){
+  // Most runs of spaces are short, so check the first byte before the setup.
+  if( begin < end && ! isSpaceChar(*begin) )
+    return( begin );
+  switch( charScan_getLevel() ){
+#ifdef CHAR_SCAN_HAVE_AVX2
+  case CHAR_SCAN_AVX2:
+    return( findNonSpace_avx2(begin, end) );
+#endif
+#ifdef CHAR_SCAN_HAVE_SSE2
+  case CHAR_SCAN_SSE2:
+    return( findNonSpace_sse2(begin, end) );
+#endif
+  default:
+    return( findNonSpace_scalar(begin, end) );
+  }
+}  // End fcn charScan_findNonSpace().
+
+
+//--- Count the occurrences of a character.
+//
+size_t charScan_countChar(const char* begin, const char* end, char ch){
+  switch( charScan_getLevel() ){
+#ifdef CHAR_SCAN_HAVE_AVX2
+  case CHAR_SCAN_AVX2:
+    return( countChar_avx2(begin, end, ch) );
+#endif
+#ifdef CHAR_SCAN_HAVE_SSE2
+  case CHAR_SCAN_SSE2:
+    return( countChar_sse2(begin, end, ch) );
+#endif
+  default:
+    return( countChar_scalar(begin, end, ch) );
+  }
+}  // End fcn charScan_countChar().
+
+
+//--- Get the highest level the processor supports.
+//
+static int charScan_getMaxLevel(void){
+#if defined(CHAR_SCAN_HAVE_AVX2) && defined(_MSC_VER)
+  // AVX2 needs the processor flag, and the operating system to save the registers.
+  int info[4];
+  __cpuid(info, 0);
+  if( info[0] >= 7 ){
+    __cpuid(info, 1);
+    const bool osxsave = ( (info[2] & (1 << 27)) != 0 );
+    __cpuidex(info, 7, 0);
+    if( osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 6) == 6 )
+      return( CHAR_SCAN_AVX2 );
+  }
+  return( CHAR_SCAN_SSE2 );
+#elif defined(CHAR_SCAN_HAVE_AVX2)
+  __builtin_cpu_init();
+  return( __builtin_cpu_supports("avx2") ? CHAR_SCAN_AVX2 : CHAR_SCAN_SSE2 );
+#elif defined(CHAR_SCAN_HAVE_SSE2)
+  return( CHAR_SCAN_SSE2 );
+#else
+  return( CHAR_SCAN_SCALAR );
+#endif
+}  // End fcn charScan_getMaxLevel().
+
+
+//--- Select the implementation of the scan.
+//
+int charScan_setLevel(int level){
+  const int maxLevel = charScan_getMaxLevel();
+  if( level > maxLevel )
+    level = maxLevel;
+  if( level < CHAR_SCAN_SCALAR )
+    level = CHAR_SCAN_SCALAR;
+  charScanLevel = level;
+  return( level );
+}  // End fcn charScan_setLevel().
+
+
+//--- Get the implementation of the scan.
+//
+int charScan_getLevel(void){
+  // Initialized once, also if several threads start to read files at the same time.
+  static const int maxLevel = charScan_getMaxLevel();
+  return( charScanLevel < 0 ? maxLevel : charScanLevel );
+}  // End fcn charScan_getLevel().
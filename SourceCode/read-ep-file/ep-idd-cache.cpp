@@ -0,0 +1,247 @@
+//--- Binary cache of an EnergyPlus input data dictionary (IDD) map.
+
+
+//--- Copyright notice.
+//
+//   Please see the header file.
+
+
+//--- Includes.
+//
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <stdint.h>
+#include <ctime>
+#include <string>
+#include <vector>
+using std::string;
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _MSC_VER
+  #include <process.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+#include "ep-idd-cache.h"
+
+#include "../utility/digest-md5.h"
+
+
+//--- Types.
+//
+//   Header of the cache file.  Change {g_cacheMagic} whenever the format of
+// the cache, or the way {fileReaderDictionary::getMap()} parses the IDD file,
+// changes, so that stale caches are not read.
+//
+struct cacheHeader {
+  char magic[16];
+  char iddDigest[32];
+  int64_t iddSize;
+  int64_t iddModTime;
+  int64_t writeTime;
+  uint32_t byteOrder;
+  uint32_t entryCt;
+  uint32_t charCt;
+  uint32_t reserved;
+};
+//
+struct cacheEntry {
+  uint32_t keyIdx;
+  uint32_t keyLen;
+  uint32_t descIdx;
+  uint32_t descLen;
+};
+
+
+//--- Global variables.
+static const char g_cacheMagic[16] = "EP-IDD-CACHE-1";
+static const uint32_t g_byteOrder = 0x01020304;
+
+
+//--- File-scope fcn prototypes.
+static bool readCache(const char* data, size_t dataLen, const string& iddFileName, iddMap& idd);
+
+
+//--- Functions.
+
+
+//--- Read an IDD map from a cache file.
+//
+//   On Linux and Mac OS X, map the file to memory.  On Windows, read it.
+//
+bool iddCache_read(const string& cacheFileName, const string& iddFileName, iddMap& idd)
+  {
+  bool success = false;
+#ifndef _MSC_VER
+  const int fd = open(cacheFileName.c_str(), O_RDONLY);
+  if( fd < 0 )
+    return( false );
+  struct stat st;
+  if( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= (off_t)sizeof(cacheHeader) )
+    {
+    void* addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if( addr != MAP_FAILED )
+      {
+      success = readCache((const char*)addr, (size_t)st.st_size, iddFileName, idd);
+      munmap(addr, (size_t)st.st_size);
+      }
+    }
+  close(fd);
+#else
+  FILE* fp = fopen(cacheFileName.c_str(), "rb");
+  if( fp == NULL )
+    return( false );
+  std::vector<char> data;
+  char chunk[65536];
+  size_t len;
+  while( (len = fread(chunk, 1, sizeof(chunk), fp)) > 0 )
+    data.insert(data.end(), chunk, chunk+len);
+  fclose(fp);
+  if( ! data.empty() )
+    success = readCache(&data[0], data.size(), iddFileName, idd);
+#endif
+  return( success );
+  }  // End fcn iddCache_read().
+
+
+//--- Check the content of a cache file, and add its entries to {idd}.
+//
+//   Check every index before adding any entry, so that a damaged or
+// truncated cache leaves {idd} unchanged.
+//
+static bool readCache(const char* data, size_t dataLen, const string& iddFileName, iddMap& idd)
+  {
+  cacheHeader header;
+  struct stat st;
+  char iddDigest[33];
+  size_t idx;
+  //
+  if( dataLen < sizeof(header) )
+    return( false );
+  memcpy(&header, data, sizeof(header));
+  if( 0 != memcmp(header.magic, g_cacheMagic, sizeof(header.magic)) ||
+    header.byteOrder != g_byteOrder ||
+    (dataLen - sizeof(header)) / sizeof(cacheEntry) < header.entryCt ||
+    dataLen != sizeof(header) + header.entryCt*sizeof(cacheEntry) + header.charCt )
+    return( false );
+  //
+  // Find the digest of the IDD file, unless the IDD file did not change
+  // since the cache was written.  An IDD file modified in the second the
+  // cache was written may have changed after it, so check its digest.
+  if( 0 != stat(iddFileName.c_str(), &st) )
+    return( false );
+  if( header.iddSize != (int64_t)st.st_size || header.iddModTime != (int64_t)st.st_mtime ||
+    header.iddModTime >= header.writeTime )
+    {
+    digest_md5_fromFile(iddFileName.c_str(), iddDigest);
+    if( 0 != memcmp(header.iddDigest, iddDigest, sizeof(header.iddDigest)) )
+      return( false );
+    }
+  //
+  const char* const entryData = data + sizeof(header);
+  const char* const chars = entryData + header.entryCt*sizeof(cacheEntry);
+  std::vector<cacheEntry> entries(header.entryCt);
+  if( header.entryCt > 0 )
+    memcpy(&entries[0], entryData, header.entryCt*sizeof(cacheEntry));
+  for( idx=0; idx<entries.size(); ++idx )
+    {
+    const cacheEntry& entry = entries[idx];
+    if( entry.keyLen > header.charCt || entry.keyIdx > header.charCt - entry.keyLen ||
+      entry.descLen > header.charCt || entry.descIdx > header.charCt - entry.descLen )
+      return( false );
+    }
+  //
+  // The entries are in the order of the atoms of the map that was written.
+  for( idx=0; idx<entries.size(); ++idx )
+    {
+    const cacheEntry& entry = entries[idx];
+    idd.set(chars+entry.keyIdx, entry.keyLen, chars+entry.descIdx, entry.descLen);
+    }
+  //
+  return( true );
+  }  // End fcn readCache().
+
+
+//--- Write an IDD map to a cache file.
+//
+bool iddCache_write(const string& cacheFileName, const string& iddFileName, const iddMap& idd)
+  {
+  cacheHeader header;
+  struct stat st;
+  char iddDigest[33];
+  std::vector<cacheEntry> entries;
+  string chars;
+  string key, desc;
+  int atom;
+  //
+  // Build the table of entries, and the characters they index.
+  entries.reserve(idd.size());
+  for( atom=0; atom<(int)idd.size(); ++atom )
+    {
+    cacheEntry entry;
+    idd.getKeyword(atom, key);
+    idd.getDescriptor(atom, desc);
+    entry.keyIdx = (uint32_t)chars.size();
+    entry.keyLen = (uint32_t)key.size();
+    chars += key;
+    entry.descIdx = (uint32_t)chars.size();
+    entry.descLen = (uint32_t)desc.size();
+    chars += desc;
+    entries.push_back(entry);
+    }
+  //
+  // Record the time before the state of the IDD file, so that a change of
+  // the IDD file after it was read either changes its state, or is in the
+  // second the cache was written.
+  memset(&header, 0, sizeof(header));
+  header.writeTime = (int64_t)time(NULL);
+  if( 0 != stat(iddFileName.c_str(), &st) )
+    return( false );
+  digest_md5_fromFile(iddFileName.c_str(), iddDigest);
+  memcpy(header.magic, g_cacheMagic, sizeof(header.magic));
+  memcpy(header.iddDigest, iddDigest, sizeof(header.iddDigest));
+  header.iddSize = (int64_t)st.st_size;
+  header.iddModTime = (int64_t)st.st_mtime;
+  header.byteOrder = g_byteOrder;
+  header.entryCt = (uint32_t)entries.size();
+  header.charCt = (uint32_t)chars.size();
+  //
+  // Write a file private to this process and thread.  Threads of one
+  // process have different stacks, so the address of {header} tells them
+  // apart.
+  std::ostringstream tmpNameStream;
+  tmpNameStream << cacheFileName << ".tmp-"
+#ifdef _MSC_VER
+    << _getpid()
+#else
+    << getpid()
+#endif
+    << "-" << (const void*)&header;
+  const string tmpFileName = tmpNameStream.str();
+  FILE* fp = fopen(tmpFileName.c_str(), "wb");
+  if( fp == NULL )
+    return( false );
+  bool success = ( 1 == fwrite(&header, sizeof(header), 1, fp) );
+  if( success && ! entries.empty() )
+    success = ( 1 == fwrite(&entries[0], entries.size()*sizeof(cacheEntry), 1, fp) );
+  if( success && ! chars.empty() )
+    success = ( 1 == fwrite(chars.data(), chars.size(), 1, fp) );
+  success = ( 0 == fclose(fp) ) && success;
+  //
+  // Rename the file to the cache.  On Windows, {rename()} does not replace
+  // an existing file, such as a cache of an older IDD file.
+  if( success && 0 != rename(tmpFileName.c_str(), cacheFileName.c_str()) )
+    {
+    remove(cacheFileName.c_str());
+    success = ( 0 == rename(tmpFileName.c_str(), cacheFileName.c_str()) );
+    }
+  if( ! success )
+    remove(tmpFileName.c_str());
+  //
+  return( success );
+  }  // End fcn iddCache_write().
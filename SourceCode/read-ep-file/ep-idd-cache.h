@@ -0,0 +1,159 @@
+//--- Binary cache of an EnergyPlus input data dictionary (IDD) map.
+//
+/// \brief  Binary cache of an EnergyPlus input data dictionary (IDD) map.
+///
+/// Parsing the IDD file of EnergyPlus takes longer than any other step of
+/// preparing a run, although only a few of its keywords are checked.  The
+/// functions below write the \c iddMap of an IDD file to a compact binary
+/// file, and read it back, mapped to memory, on the next runs.  The cache
+/// records the MD5 digest of the IDD file it was written for, and is
+/// ignored if the IDD file changes.
+///
+/// Finding the digest takes about half as long as parsing the IDD file.
+/// Therefore the cache also records the size and modification time of the
+/// IDD file, and the time it was written.  If the size and modification
+/// time did not change, and the IDD file was last modified before the
+/// cache was written, the recorded digest is used.
+///
+/// The cache holds a header of 88 bytes, a table of the entries in the
+/// order of their atoms in the map, and the characters of the keywords and
+/// descriptors:
+/// \code
+///   char magic[16]; char iddDigest[32];
+///   int64 iddSize, iddModTime, writeTime;
+///   uint32 byteOrder, entryCt, charCt, reserved;
+///   struct { uint32 keyIdx, keyLen, descIdx, descLen; } entries[entryCt];
+///   char chars[charCt];
+/// \endcode
+/// Integers are in the byte order of the machine that wrote the cache.
+/// A cache written on a machine with another byte order is ignored.
+
+
+#if !defined(__EP_IDD_CACHE_H__)
+#define __EP_IDD_CACHE_H__
+
+
+//--- Includes.
+//
+#include <string>
+
+#include "ep-idd-map.h"
+
+
+//--- Preprocessor definitions.
+//
+/// Suffix appended to the name of an IDD file to get the name of its cache.
+#define IDD_CACHE_SUFFIX ".cache"
+
+
+//--- Functions.
+
+
+/// Read an IDD map from a cache file.
+///
+/// \param cacheFileName Name of the cache file.
+/// \param iddFileName Name of the IDD file.
+/// \retval idd Map to which the entries of the cache are added.
+/// \return \c true if the cache exists, is valid, and was written for the
+///   current content of the IDD file.  Otherwise, \c idd is not changed.
+bool iddCache_read(const std::string& cacheFileName, const std::string& iddFileName, iddMap& idd);
+
+
+/// Write an IDD map to a cache file.
+///
+/// Call this function right after parsing the IDD file, as the cache records
+/// the digest the IDD file has when the cache is written.  The cache is
+/// written to a temporary file, which is then renamed, so other processes
+/// read either no cache or a complete one.
+///
+/// \param cacheFileName Name of the cache file.
+/// \param iddFileName Name of the IDD file.
+/// \param idd Map to write.
+/// \return \c true on success.
+bool iddCache_write(const std::string& cacheFileName, const std::string& iddFileName, const iddMap& idd);
+
+
+#endif // __EP_IDD_CACHE_H__
+
+
+/*
+***********************************************************************************
+Copyright Notice
+----------------
+
+Functional Mock-up Unit Export of EnergyPlus (C)2013, The Regents of
+the University of California, through Lawrence Berkeley National
+Laboratory (subject to receipt of any required approvals from
+the U.S. Department of Energy). All rights reserved.
+
+If you have questions about your rights to use or distribute this software,
+please contact Berkeley Lab's Technology Transfer Department at
+TTD@lbl.gov.referring to "Functional Mock-up Unit Export
+of EnergyPlus (LBNL Ref 2013-088)".
+
+NOTICE: This software was produced by The Regents of the
+University of California under Contract No. DE-AC02-05CH11231
+with the Department of Energy.
+For 5 years from November 1, 2012, the Government is granted for itself
+and others acting on its behalf a nonexclusive, paid-up, irrevocable
+worldwide license in this data to reproduce, prepare derivative works,
+and perform publicly and display publicly, by or on behalf of the Government.
+There is provision for the possible extension of the term of this license.
+Subsequent to that period or any extension granted, the Government is granted
+for itself and others acting on its behalf a nonexclusive, paid-up, irrevocable
+worldwide license in this data to reproduce, prepare derivative works,
+distribute copies to the public, perform publicly and display publicly,
+and to permit others to do so. The specific term of the license can be identified
+by inquiry made to Lawrence Berkeley National Laboratory or DOE. Neither
+the United States nor the United States Department of Energy, nor any of their employees,
+makes any warranty, express or implied, or assumes any legal liability or responsibility
+for the accuracy, completeness, or usefulness of any data, apparatus, product,
+or process disclosed, or represents that its use would not infringe privately owned rights.
+
+
+Copyright (c) 2013, The Regents of the University of California, Department
+of Energy contract-operators of the Lawrence Berkeley National Laboratory.
+All rights reserved.
+
+1. Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+(1) Redistributions of source code must retain the copyright notice, this list
+of conditions and the following disclaimer.
+
+(2) Redistributions in binary form must reproduce the copyright notice, this list
+of conditions and the following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+(3) Neither the name of the University of California, Lawrence Berkeley
+National Laboratory, U.S. Dept. of Energy nor the names of its contributors
+may be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+2. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+3. You are under no obligation whatsoever to provide any bug fixes, patches,
+or upgrades to the features, functionality or performance of the source code
+("Enhancements") to anyone; however, if you choose to make your Enhancements
+available either publicly, or directly to Lawrence Berkeley National Laboratory,
+without imposing a separate written license agreement for such Enhancements,
+then you hereby grant the following license: a non-exclusive, royalty-free
+perpetual license to install, use, modify, prepare derivative works, incorporate
+into other computer software, distribute, and sublicense such enhancements or
+derivative works thereof, in binary and source code form.
+
+NOTE: This license corresponds to the "revised BSD" or "3-clause BSD"
+License and includes the following modification: Paragraph 3. has been added.
+
+
+***********************************************************************************
+*/
@@ -12,6 +12,10 @@
 
 
 //--- Preprocessor definitions.
+//
+//   Number of slots of the hash table of a new map.  Keep the table at most
+// half full, so searches end after a few slots.
+#define IDD_MAP_MIN_SLOTS 64
 
 
 //--- Types.
@@ -21,19 +25,178 @@
 
 
 //--- File-scope fcn prototypes.
+static inline char foldCase(char ch);
+static unsigned int hashKey(const char* key, std::size_t keyLen);
 
 
 //--- Functions.
 
 
+//--- Upper-case a character, as \c toupper() in the "C" locale.
+//
+static inline char foldCase(char ch){
+  return( (ch >= 'a' && ch <= 'z') ? (char)(ch - 'a' + 'A') : ch );
+}
+
+
+//--- Hash a keyword, ignoring its case.
+//
+//   FNV-1a hash.
+//
+static unsigned int hashKey(const char* key, std::size_t keyLen){
+  unsigned int hash = 2166136261u;
+  for( std::size_t idx=0; idx<keyLen; ++idx ){
+    hash ^= (unsigned char)foldCase(key[idx]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+
+//--- Construct an empty map.
+//
+iddMap::iddMap(void){
+}
+
+
+//--- Remove all keywords.
+//
+void iddMap::clear(void){
+  chars.clear();
+  entries.clear();
+  slots.clear();
+}
+
+
+//--- Find the slot of a keyword, or the empty slot where it belongs.
+//
+//   Assume the table has at least one empty slot.
+//
+int iddMap::findSlot(const char* key, std::size_t keyLen, unsigned int hash) const{
+  const std::size_t mask = slots.size() - 1;
+  std::size_t slot = hash & mask;
+  //
+  while( slots[slot] >= 0 ){
+    const entry& ent = entries[slots[slot]];
+    if( ent.hash == hash && ent.keyLen == keyLen ){
+      const char* const stored = chars.data() + ent.keyIdx;
+      std::size_t idx = 0;
+      while( idx < keyLen && stored[idx] == foldCase(key[idx]) )
+        ++idx;
+      if( idx == keyLen )
+        break;
+    }
+    slot = (slot + 1) & mask;
+  }
+  //
+  return (int)slot;
+}
+
+
+//--- Rebuild the hash table with {slotCt} slots, a power of two.
+//
+void iddMap::rehash(std::size_t slotCt){
+  slots.assign(slotCt, -1);
+  for( std::size_t atom=0; atom<entries.size(); ++atom ){
+    std::size_t slot = entries[atom].hash & (slotCt - 1);
+    while( slots[slot] >= 0 )
+      slot = (slot + 1) & (slotCt - 1);
+    slots[slot] = (int)atom;
+  }
+}
+
+
+//--- Set the descriptor of a keyword.
+//
+int iddMap::set(const char* key, std::size_t keyLen, const char* desc, std::size_t descLen){
+  const unsigned int hash = hashKey(key, keyLen);
+  //
+  if( 2*(entries.size()+1) > slots.size() )
+    rehash(slots.empty() ? IDD_MAP_MIN_SLOTS : 2*slots.size());
+  const int slot = findSlot(key, keyLen, hash);
+  //
+  if( slots[slot] >= 0 ){
+    // Here, replace the descriptor of an existing keyword.
+    entry& ent = entries[slots[slot]];
+    if( descLen > ent.descLen ){
+      ent.descIdx = chars.size();
+      chars.append(desc, descLen);
+    }
+    else{
+      chars.replace(ent.descIdx, descLen, desc, descLen);
+    }
+    ent.descLen = descLen;
+    return slots[slot];
+  }
+  //
+  // Here, add the keyword.
+  entry ent;
+  ent.keyIdx = chars.size();
+  ent.keyLen = keyLen;
+  for( std::size_t idx=0; idx<keyLen; ++idx )
+    chars.push_back(foldCase(key[idx]));
+  ent.descIdx = chars.size();
+  ent.descLen = descLen;
+  chars.append(desc, descLen);
+  ent.hash = hash;
+  slots[slot] = (int)entries.size();
+  entries.push_back(ent);
+  //
+  return slots[slot];
+}
+
+
+//--- Find the atom of a keyword.
+//
+int iddMap::find(const char* key, std::size_t keyLen) const{
+  if( slots.empty() )
+    return -1;
+  return slots[findSlot(key, keyLen, hashKey(key, keyLen))];
+}
+
+
+//--- Get the keyword of an atom.
+//
+void iddMap::getKeyword(int atom, string& key) const{
+  const entry& ent = entries[atom];
+  key.assign(chars, ent.keyIdx, ent.keyLen);
+}
+
+
+//--- Get the descriptor of an atom.
+//
+void iddMap::getDescriptor(int atom, string& desc) const{
+  const entry& ent = entries[atom];
+  desc.assign(chars, ent.descIdx, ent.descLen);
+}
+
+
+//--- Compare two maps.
+//
+bool iddMap::operator==(const iddMap& other) const{
+  if( size() != other.size() )
+    return false;
+  for( std::size_t atom=0; atom<entries.size(); ++atom ){
+    const entry& ent = entries[atom];
+    const int otherAtom = other.find(chars.data()+ent.keyIdx, ent.keyLen);
+    if( otherAtom < 0 )
+      return false;
+    const entry& otherEnt = other.entries[otherAtom];
+    if( 0 != chars.compare(ent.descIdx, ent.descLen, other.chars, otherEnt.descIdx, otherEnt.descLen) )
+      return false;
+  }
+  return true;
+}
+
+
 //--- Get descriptor for a given keyword.
 //
 bool iddMap_getDescriptor(const iddMap& idd, const string& key, string& desc){
   //
-  const iddMap::const_iterator it = idd.find(key);
+  const int atom = idd.find(key);
   //
-  if( idd.end() != it ){
-    desc = it->second;
+  if( atom >= 0 ){
+    idd.getDescriptor(atom, desc);
     return true;
   }
   //
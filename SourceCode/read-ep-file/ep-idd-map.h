@@ -58,9 +58,10 @@
 
 //--- Includes.
 
+#include <cstddef>
 #include <string>
 using std::string;
-#include <map>
+#include <vector>
 
 
 //--- Types.
@@ -79,9 +80,81 @@ using std::string;
 // thrown away as "comments".  For example, in the ShadowCalculation entry above,
 // fact that it's a "unique-object" doesn't get encoded in the data dictionary.
 //
-// hoho dml  Consider creating an {iddMap} class.
+//   Keywords are stored in upper case, and found in any case, as keywords of
+// IDD and IDF files are.  Each keyword is stored once, and is identified by
+// its atom, a number given in the order the keywords are added.  A caller
+// that dispatches on a few known keywords finds the atom of a keyword, and
+// compares numbers rather than strings.
+//   The keywords and descriptors are stored in one string, and found through
+// an open-addressing hash table, so a map of the whole IDD file takes a few
+// allocations rather than several per keyword.
 //
-typedef std::map<std::string, std::string> iddMap;
+class iddMap {
+
+public:
+
+  iddMap(void);
+
+  /// Number of keywords, which are the atoms 0 to \c size()-1.
+  std::size_t size(void) const { return entries.size(); }
+
+  /// \return \c true if the map has no keyword.
+  bool empty(void) const { return entries.empty(); }
+
+  /// Remove all keywords.
+  void clear(void);
+
+  /// Set the descriptor of a keyword, adding the keyword if it is new.
+  ///
+  /// \param key Keyword, in any case.
+  /// \param keyLen Number of characters of \c key.
+  /// \param desc Descriptor.
+  /// \param descLen Number of characters of \c desc.
+  /// \return Atom of the keyword.
+  int set(const char* key, std::size_t keyLen, const char* desc, std::size_t descLen);
+  int set(const std::string& key, const std::string& desc)
+    { return set(key.data(), key.size(), desc.data(), desc.size()); }
+
+  /// Find the atom of a keyword.
+  ///
+  /// \param key Keyword, in any case.
+  /// \param keyLen Number of characters of \c key.
+  /// \return Atom of the keyword, or -1 if the map does not have it.
+  int find(const char* key, std::size_t keyLen) const;
+  int find(const std::string& key) const { return find(key.data(), key.size()); }
+
+  /// Get the keyword of an atom, in upper case.
+  /// \param atom Atom, from 0 to \c size()-1.
+  /// \retval key Keyword.
+  void getKeyword(int atom, std::string& key) const;
+
+  /// Get the descriptor of an atom.
+  /// \param atom Atom, from 0 to \c size()-1.
+  /// \retval desc Descriptor.
+  void getDescriptor(int atom, std::string& desc) const;
+
+  /// \return \c true if both maps have the same keywords and descriptors,
+  ///   in any order.
+  bool operator==(const iddMap& other) const;
+  bool operator!=(const iddMap& other) const { return ! (*this == other); }
+
+private:
+
+  struct entry {
+    std::size_t keyIdx;   // Index of the keyword in {chars}.
+    std::size_t keyLen;
+    std::size_t descIdx;  // Index of the descriptor in {chars}.
+    std::size_t descLen;
+    unsigned int hash;
+  };
+
+  std::string chars;            // Keywords and descriptors.
+  std::vector<entry> entries;   // Indexed by atom.
+  std::vector<int> slots;       // Hash table of atoms, -1 if empty.
+
+  int findSlot(const char* key, std::size_t keyLen, unsigned int hash) const;
+  void rehash(std::size_t slotCt);
+};
 
 
 //--- Functions.
@@ -90,7 +163,7 @@ typedef std::map<std::string, std::string> iddMap;
 /// Get descriptor for a given keyword.
 ///
 /// \param idd The \c iddMap to query.
-/// \param key Keyword for which to retrieve the descriptor from the data dictionary.
+/// \param key Keyword for which to retrieve the descriptor from the data dictionary, in any case.
 /// \retval desc String containing the descriptor (blank if invalid key).
 /// \return \c true if \c key is valid, \c false otherwise.
 bool iddMap_getDescriptor(const iddMap& idd, const string& key, string& desc);
@@ -123,7 +196,8 @@ void iddMap_markDescriptorIdx(const string& desc, int markIdx, string& markedDes
 
 //--- Check an Input Data Dictionary has an expected keyword and descriptor.
 //
-//   Report on strict match (including capitalization) between expected entries.
+//   The keyword is found regardless of capitalization, as EnergyPlus reads it.
+// Only the descriptor must match the expected one exactly, including capitalization.
 //
 // \return 0 for success; 1 for missing keyword; 2 for incorrect descriptor.
 // \retval errStr Append error message, if any, to this string.
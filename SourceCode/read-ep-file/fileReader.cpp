@@ -8,6 +8,7 @@
 
 //--- Includes.
 
+#include <cstdio>
 #include <cstdlib>
 
 #include <iostream>
@@ -18,24 +19,86 @@ using std::endl;
 
 #include <sstream>
 
+#ifndef _MSC_VER
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
 #include "fileReader.h"
 
 
+//--- File-scope fcn prototypes.
+static bool readWholeFile(const string& fileName, string& content);
+
+
 ///////////////////////////////////////////////////////
 fileReader::fileReader(const string& fname){
   fileName = fname;
   lineNumber = 0;
   externalErrorFcn = 0;
+  externalErrorStream = 0;
+  buf = 0;
+  bufLen = 0;
+  pos = 0;
+  atEOF = false;
+  linePos = 0;
+  mapAddr = 0;
+  mapLen = 0;
 }
 
 ///////////////////////////////////////////////////////
+//
+//   On Linux and Mac OS X, map a regular file to memory.  Otherwise, or if the
+// mapping fails, read the file to memory.
+//   On Windows, the file is read to memory, rather than mapped, so that "\r\n"
+// can be replaced by '\n', as the \c std::ifstream that used to read the file
+// did in text mode.
+//
 void fileReader::open(){
-  fileStream.open(fileName.c_str(), std::ios::in);
-  if( ! fileStream.is_open() ){
+  bool isOpen = false;
+  close();
+#ifndef _MSC_VER
+  const int fd = ::open(fileName.c_str(), O_RDONLY);
+  if( fd >= 0 ){
+    struct stat st;
+    if( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 ){
+      void* addr = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if( addr != MAP_FAILED ){
+        madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+        mapAddr = addr;
+        mapLen = (size_t)st.st_size;
+      }
+    }
+    ::close(fd);
+    isOpen = ( mapAddr != 0 || readWholeFile(fileName, fileCopy) );
+  }
+#else
+  isOpen = readWholeFile(fileName, fileCopy);
+#endif
+  if( ! isOpen ){
      std::ostringstream os;
      os << "Cannot open file";
      reportError(os);
-     exit(1);
+     throw fileReaderError(fileName + ": " + os.str());
+  }
+  if( mapAddr != 0 ){
+    buf = (const char*)mapAddr;
+    bufLen = mapLen;
+  }
+  else{
+#ifdef _MSC_VER
+    // Replace "\r\n" by '\n'.
+    size_t idxOut = 0;
+    for( size_t idx=0; idx<fileCopy.size(); ++idx ){
+      if( fileCopy[idx] != '\r' || idx+1 == fileCopy.size() || fileCopy[idx+1] != '\n' )
+        fileCopy[idxOut++] = fileCopy[idx];
+    }
+    fileCopy.resize(idxOut);
+#endif
+    buf = fileCopy.data();
+    bufLen = fileCopy.size();
   }
   lineNumber = 1;
 }
@@ -45,10 +108,20 @@ void fileReader::open(){
 //
 void fileReader::close()
   {
-  if( fileStream.is_open() )
+#ifndef _MSC_VER
+  if( mapAddr != 0 )
     {
-    fileStream.close();
+    munmap(mapAddr, mapLen);
     }
+#endif
+  mapAddr = 0;
+  mapLen = 0;
+  string().swap(fileCopy);
+  buf = 0;
+  bufLen = 0;
+  pos = 0;
+  atEOF = false;
+  linePos = 0;
   lineNumber = 0;
   }  // End method fileReader::close().
 
@@ -61,16 +134,74 @@ void fileReader::attachErrorFcn(void (*errFcn)(
 }  // End method fileReader::attachErrorFcn().
 
 
-//--- Return the next character.
+//--- Attach an error stream.
 //
-char fileReader::getChar(void)
+void fileReader::attachErrorStream(std::ostream& errStream){
+  externalErrorStream = &errStream;
+}  // End method fileReader::attachErrorStream().
+
+
+//--- Build the set of the characters of {str}.
+//
+//   The set is kept if {str} did not change, as callers pass the same
+// delimiters for every token.  Return \c true if the set changed.
+//
+bool fileReader::charTable::update(const string& str){
+  if( valid && str == chars )
+    return false;
+  charScan_setChars(str, set);
+  chars = str;
+  valid = true;
+  return true;
+}  // End method fileReader::charTable::update().
+
+
+//--- Count the lines up to the current position.
+//
+//   Line numbers are counted on demand, rather than for every character, by
+// counting the '\n' characters read since the last count.
+//
+void fileReader::countLines(void)
   {
-  const int charAsInt = fileStream.get();
-  if( (int)'\n' == charAsInt )
+  if( linePos < pos )
     {
-    ++lineNumber;
+    lineNumber += (int)charScan_countChar(buf+linePos, buf+pos, '\n');
+    linePos = pos;
     }
-  else if( EOF == charAsInt )
+  }  // End method fileReader::countLines().
+
+
+//--- Return the current line number.
+//
+int fileReader::getLineNumber()
+  {
+  countLines();
+  return( lineNumber );
+  }  // End method fileReader::getLineNumber().
+
+
+//--- Return the next character, or EOF.
+//
+//   Like \c std::istream::get(), trying to read past the last character
+// sets the end-of-file state.
+//
+int fileReader::getRawChar(void)
+  {
+  if( pos < bufLen )
+    {
+    return( (unsigned char)buf[pos++] );
+    }
+  atEOF = true;
+  return( EOF );
+  }  // End method fileReader::getRawChar().
+
+
+//--- Return the next character.
+//
+char fileReader::getChar(void)
+  {
+  const int charAsInt = getRawChar();
+  if( EOF == charAsInt )
     {
     return( '\0' );
     }
@@ -84,29 +215,28 @@ char fileReader::getChar(void)
 // hoho dml  Note could return EOF status.
 //
 void fileReader::skipComment(const string& commentSign, int& lineNo){
-  char ch;
   //
-  if( ! fileStream.eof() ){
+  commentTable.update(commentSign);
+  if( ! atEOF ){
     while( 1 ){
       // Here, assume next content on current line may be a comment.
       // Get first non-space character.
-      skipSpace(lineNo);
-      if( fileStream.eof() )
-        break;
-      fileStream.get(ch);
-      // Check {ch}.
-      if( fileStream.eof() )
+      pos = (size_t)(charScan_findNonSpace(buf+pos, buf+bufLen) - buf);
+      if( pos == bufLen ){
+        atEOF = true;
         break;
-      if( commentSign.find(ch) == std::string::npos ){
+      }
+      // Check next character.
+      if( ! commentTable(buf[pos]) ){
         // Not a comment line.
-        fileStream.putback(ch);
         break;
       }
-      // Here, {ch} starts a comment.
+      // Here, next character starts a comment.
       //   Skip rest of line, then go back to check whether next line also
       // is a comment.
-      skipLine(lineNo);
+      skipToEndOfLine();
     }
+    lineNo = getLineNumber();
   }
   //
 }  // End method fileReader::skipComment().
@@ -127,93 +257,88 @@ void fileReader::skipComment(const string& commentSign, int& lineNo){
 // to check for a failure (hit illegal character, or zero-length token).
 //
 void fileReader::getToken(const string& delimiters, const string& illegalChars,
-  string& token){
+  fileReaderSpan& token){
   //
-  token = "";
-  char ch;
+  const size_t start = pos;
   //
-  if( ! fileStream.eof() ){
-    while( 1 ){
-      // Get next character (which may or may not be part of the token).
-      fileStream.get(ch);
-      // Reasons to end the token:
-      // ** Hit EOF.
-      // ** Hit a delimiter.
-      // ** Hit a comment (which is an error).
-      //   Note hitting EOL does not end a token.
-      if( fileStream.eof() )
-        break;
-      if( '\n' == ch )
-        ++lineNumber;
-      if( delimiters.find(ch) != std::string::npos ){
-        // Here, found delimiter.
-        //   Put delimiter back before finish.
-        fileStream.putback(ch);
-        break;
-      }
-      if( illegalChars.find(ch) != std::string::npos ){
-        // Error, illegal character.
-        std::ostringstream os;
-        os << "Encountered illegal character '" << ch << "' while reading a token.";
-        reportError(os);
-        exit(1);
-      }
-      // Here, still reading token.
-      token += ch;
+  if( delimTable.update(delimiters) | illegalTable.update(illegalChars) )
+    charScan_setChars(delimiters + illegalChars, tokenEndSet);
+  if( ! atEOF ){
+    // Reasons to end the token:
+    // ** Hit EOF.
+    // ** Hit a delimiter, which is left for the caller.
+    // ** Hit a comment (which is an error).
+    //   Note hitting EOL does not end a token.
+    pos = (size_t)(charScan_findFirstOf(buf+pos, buf+bufLen, tokenEndSet) - buf);
+    if( pos == bufLen ){
+      atEOF = true;
+    }
+    else if( ! delimTable(buf[pos]) ){
+      // Error, illegal character.
+      const char ch = buf[pos++];
+      std::ostringstream os;
+      os << "Encountered illegal character '" << ch << "' while reading a token.";
+      reportError(os);
+      throw fileReaderError(fileName + ": " + os.str());
     }
   }
   //
+  token = fileReaderSpan(buf+start, pos-start);
+  return;
+}  // End method fileReader::getToken().
+
+
+void fileReader::getToken(const string& delimiters, const string& illegalChars,
+  string& token){
+  //
+  fileReaderSpan span;
+  getToken(delimiters, illegalChars, span);
+  token.assign(span.data(), span.size());
+  //
   return;
 }  // End method fileReader::getToken().
 
 void fileReader::getToken(const string& delimiters, const string& illegalChars,
 	string& token, string& tokenExt){
 	//
-	token = "";
-	tokenExt = "";
-	char ch;
+	const size_t start = pos;
 	//
-	if (!fileStream.eof()){
-		while (1){
-			// Get next character (which may or may not be part of the token).
-			fileStream.get(ch);
-			// Reasons to end the token:
-			// ** Hit EOF.
-			// ** Hit a delimiter.
-			// ** Hit a comment (which is an error).
-			//   Note hitting EOL does not end a token.
-			if (fileStream.eof())
-				break;
-			if ('\n' == ch)
-				++lineNumber;
-			if (delimiters.find(ch) != std::string::npos){
-				// Here, found delimiter.
-				//   Put delimiter back before finish.
-				tokenExt += ch;
-				fileStream.putback(ch);
-				break;
-			}
-			//if (illegalChars.find(ch) != std::string::npos){
-			//	// Error, illegal character.
-			//	std::ostringstream os;
-			//	os << "Encountered illegal character '" << ch << "' while reading a token.";
-			//	reportError(os);
-			//	exit(1);
-			//}
-			// Here, still reading token.
-			token += ch;
-			tokenExt += ch;
-		}
+	// Unlike the other methods, do not check for illegal characters.
+	delimTable.update(delimiters);
+	if (!atEOF){
+		pos = (size_t)(charScan_findFirstOf(buf+pos, buf+bufLen, delimTable.set) - buf);
+		if (pos == bufLen)
+			atEOF = true;
 	}
+	token.assign(buf+start, pos-start);
+	// Here, found delimiter, which is also in {tokenExt}.
+	tokenExt.assign(buf+start, pos < bufLen ? pos-start+1 : pos-start);
 	//
 	return;
 }  // End method fileReader::getToken().
 
 
 ///////////////////////////////////////////////////////
+//
+//   Like \c std::getline(), sets the end-of-file state if the line does not end
+// with '\n', and leaves {line} unchanged if already at the end of the file.
+//
 void fileReader::getLine(string& line, int& lineNo){
-  getline(fileStream, line);
-  lineNo = lineNumber++;
+  const char* nl = atEOF ? buf+bufLen : charScan_findChar(buf+pos, buf+bufLen, '\n');
+  if( nl != buf+bufLen ){
+    line.assign(buf+pos, (size_t)(nl - (buf+pos)));
+    pos = (size_t)(nl - buf);
+    lineNo = getLineNumber();
+    ++pos;
+  }
+  else{
+    if( ! atEOF )
+      line.assign(buf+pos, bufLen-pos);
+    pos = bufLen;
+    atEOF = true;
+    lineNo = getLineNumber();
+    ++lineNumber;
+  }
   return;
 }
 
@@ -222,59 +347,105 @@ void fileReader::getLine(string& line, int& lineNo){
 //
 void fileReader::skipSpace(int& lineNo) {
   //
-  if( ! fileStream.eof() ){
-    while( 1 ){
-      // Get next character.
-      const char ch = getChar();
-      if( fileStream.eof() )
-        break;
-      if( ! isspace(ch) ){
-        // Return non-space to fileStream before finish.
-        fileStream.putback(ch);
-        break;
-      // Here, still consuming spaces.
-      }
-    }
+  if( ! atEOF ){
+    pos = (size_t)(charScan_findNonSpace(buf+pos, buf+bufLen) - buf);
+    if( pos == bufLen )
+      atEOF = true;
   }
   //
-  lineNo = lineNumber;
+  lineNo = getLineNumber();
   return;
 }  // End method fileReader::skipSpace().
 
 
+//--- Skip to the next line.
+//
+//   As reading a line with \c std::getline(), the line number increases even
+// if the line does not end with '\n'.
+//
+void fileReader::skipToEndOfLine(void)
+  {
+  const char* nl = atEOF ? buf+bufLen : charScan_findChar(buf+pos, buf+bufLen, '\n');
+  if( nl != buf+bufLen )
+    {
+    pos = (size_t)(nl - buf) + 1;
+    }
+  else
+    {
+    pos = bufLen;
+    atEOF = true;
+    countLines();
+    ++lineNumber;
+    }
+  }  // End method fileReader::skipToEndOfLine().
+
+
 ///////////////////////////////////////////////////////
 void fileReader::skipLine(int& lineNo){
-  string dummy;
-  getline(fileStream, dummy);
-  lineNo = ++lineNumber;
+  skipToEndOfLine();
+  lineNo = getLineNumber();
   return;
 }
 
 ///////////////////////////////////////////////////////
 void fileReader::skipLine(const int noOfLines, int& lineNo){
-  string dummy;
   for (int i = 0; i < noOfLines; i++){
-    getline(fileStream, dummy);
-    lineNo = ++lineNumber;
+    skipToEndOfLine();
+    lineNo = getLineNumber();
   }
   return;
 }
 
 
+//--- Skip past the next {ch} that is not in a comment.
+//
+//   Lines before the line of the next {ch} hold no {ch}, so their comments
+// need not be found.
+//
+bool fileReader::skipPast(char ch, const string& commentSign)
+  {
+  const char* const end = buf + bufLen;
+  //
+  commentTable.update(commentSign);
+  while( ! atEOF )
+    {
+    const char* const found = charScan_findChar(buf+pos, end, ch);
+    if( found == end )
+      {
+      pos = bufLen;
+      atEOF = true;
+      break;
+      }
+    const char* lineStart = found;
+    while( lineStart > buf+pos && lineStart[-1] != '\n' )
+      --lineStart;
+    const char* const comment = charScan_findFirstOf(lineStart, found, commentTable.set);
+    if( comment == found )
+      {
+      pos = (size_t)(found - buf) + 1;
+      return( true );
+      }
+    // Here, {found} is in a comment.
+    pos = (size_t)(comment - buf);
+    skipToEndOfLine();
+    }
+  //
+  return( false );
+  }  // End method fileReader::skipPast().
+
+
 ///////////////////////////////////////////////////////
 bool fileReader::moveForward(int skipCharCt){
-  while( skipCharCt > 0 ){
-    const int charAsInt = fileStream.get();
-    --skipCharCt;
-    if( (int)'\n' == charAsInt ){
-      ++lineNumber;
-    }
-    else if( EOF == charAsInt ){
-      // Hit EOF before ate \c skipCharCt characters.
-      return false;
-    }
+  if( skipCharCt <= 0 )
+    return true;
+  if( (size_t)skipCharCt > bufLen - pos ){
+    // Hit EOF before ate \c skipCharCt characters.
+    pos = bufLen;
+    atEOF = true;
+    return false;
   }
   // Here, ate {skipCharCt} characters, without hitting EOF.
+  pos += (size_t)skipCharCt;
   return true;
 }  // End method fileReader::moveForward().
 
@@ -283,10 +454,15 @@ bool fileReader::moveForward(int skipCharCt){
 //
 void fileReader::reportError(std::ostringstream& errorMessage){
   //
+  countLines();
   // Call user-supplied error fcn if available.
   if( externalErrorFcn ){
     (*externalErrorFcn)(errorMessage, fileName, lineNumber);
   }
+  else if( externalErrorStream ){
+    *externalErrorStream << "File " << fileName << ", line " << lineNumber << ": "
+      << errorMessage.str() << endl;
+  }
   else{
     // Here, no user-supplied error fcn.
     //   Note flush both {cout} and {cerr}, to avoid overlapped writes.
@@ -296,3 +472,21 @@ void fileReader::reportError(std::ostringstream& errorMessage){
     cerr.flush();
   }
 }  // End method fileReader::reportError().
+
+
+//--- Read a whole file to {content}.
+//
+//   Return \c false if the file cannot be opened.
+//
+static bool readWholeFile(const string& fileName, string& content){
+  char chunk[65536];
+  size_t ct;
+  FILE* fp = fopen(fileName.c_str(), "rb");
+  if( fp == NULL )
+    return false;
+  content.clear();
+  while( (ct = fread(chunk, 1, sizeof(chunk), fp)) > 0 )
+    content.append(chunk, ct);
+  fclose(fp);
+  return true;
+}  // End fcn readWholeFile().
@@ -12,12 +12,59 @@
 #if !defined(__FILEREADER_H__)
 #define __FILEREADER_H__
 
-#include <fstream>
+#include <cstddef>
+#include <iosfwd>
+#include <stdexcept>
 #include <string>
 
+#include "char-scan.h"
+
+
+///////////////////////////////////////////////////////
+/// Exception thrown when a \c fileReader cannot continue.
+///
+/// The error has already been passed to the error-reporting function.
+/// Callers that run in the process of an FMU catch it, rather than
+/// letting the reader terminate the process.
+class fileReaderError : public std::runtime_error {
+public:
+  fileReaderError(const std::string& msg) : std::runtime_error(msg) {}
+};
+
+
+///////////////////////////////////////////////////////
+/// Characters of a token, in the memory of the \c fileReader.
+///
+/// Like a \c std::string_view, but available to compilers older
+/// than C++17.  The characters remain valid until the \c fileReader
+/// is closed.
+class fileReaderSpan {
+public:
+  fileReaderSpan() : _data(0), _size(0) {}
+  fileReaderSpan(const char* data, std::size_t size) : _data(data), _size(size) {}
+
+  const char* data() const { return _data; }
+  std::size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+  char operator[](std::size_t idx) const { return _data[idx]; }
+
+  /// Copies the characters to a string.
+  std::string str() const { return std::string(_data, _size); }
+
+private:
+  const char* _data;
+  std::size_t _size;
+};
+
 
 ///////////////////////////////////////////////////////
 /// File reader for input parameter and weather  data.
+///
+/// The file is mapped to memory when it is opened, and read through
+/// a position in the mapping.  Tokens, spaces, comments and line ends
+/// are found with the functions of \c char-scan.h, which compare many
+/// characters at a time.  The line number is counted only when it is
+/// requested.
 class fileReader {
 
 public:
@@ -32,6 +79,10 @@ public:
   void attachErrorFcn(void (*errFcn)(
     std::ostringstream& errorMessage, const std::string& fileName, int lineNo));
 
+  /// Attach a stream, to which errors are written if no error-reporting function is attached.
+  /// \param errStream Stream that collects the \c fileReader errors.
+  void attachErrorStream(std::ostream& errStream);
+
   /// Gets the current line.
   /// \retval str String where the current line will be stored.
   /// \retval lineNo Integer where the current line number will be stored.
@@ -57,15 +108,26 @@ public:
   /// Skips all comments (and spaces) starting from the
   ///  current buffer position.
   ///
-  /// After execution, the pointer
-  /// of the \c ifstream points to the first character that is neither
+  /// After execution, the position
+  /// of the reader is at the first character that is neither
   ///  a comment nor a space.
   /// \param commentSign String containing all characters that indicate the
   ///       begin of a line comment.
   /// \retval lineNo Line number.
   void skipComment(const std::string& commentSign, int& lineNo);
 
-  /// Moves pointer of \c ifstream forward.
+  /// Skips past the next occurrence of a character that is not in a comment.
+  ///
+  /// Rather than reading every token up to the character, finds the next
+  /// occurrence of the character, and checks the part of its line before it
+  /// for a comment.  The reader must not be in a comment.
+  /// \param ch Character to skip past, for example ';' to skip an object.
+  /// \param commentSign String containing all characters that indicate the
+  ///       begin of a line comment.
+  /// \return \c true if the character was found, \c false if reached end of file.
+  bool skipPast(char ch, const std::string& commentSign);
+
+  /// Moves the position of the reader forward.
   /// \param skipCharCt Number of characters to move forward.
   /// \return \c false if moving the pointer is not possible due to end of file,
   ///         \c true otherwise.
@@ -92,9 +154,15 @@ public:
   //   delimiter with no actual token, returns without indication something out-of-ordinary happened.
   void getToken(const std::string& delimiters, const std::string& illegalChars, std::string& token, std::string& tokenExt);
 
+  /// Gets the current token, without copying it.
+  /// \param delimiters Characters that mark end of token.
+  /// \param illegalChars Characters that should never appear.  If encountered, reports and dies.
+  /// \retval token Characters of the current token, which remain valid until the file is closed.
+  void getToken(const std::string& delimiters, const std::string& illegalChars, fileReaderSpan& token);
+
   /// Gets the current line number.
   /// \retval The current line number.
-  inline int getLineNumber(){ return lineNumber; }
+  int getLineNumber();
 
   /// Opens the file, writes an error message if file cannot be opened.
   void open();
@@ -103,21 +171,55 @@ public:
   void close();
 
   /// Check for end-of-file.
-  bool isEOF(){ return fileStream.eof(); }
+  ///
+  /// As for a \c std::istream, end-of-file is reached by trying to
+  /// read past the last character, not by reading the last character.
+  bool isEOF(){ return atEOF; }
 
 protected:
 
   //--- Protected member data.
   std::string fileName;
-  std::ifstream fileStream;
   int lineNumber;
   void (*externalErrorFcn)(std::ostringstream& errorMessage, const std::string& fileName, int lineNo);
+  std::ostream* externalErrorStream;
 
   //--- Protected methods.
   void reportError(std::ostringstream& errorMessage);
 
 private:
   fileReader();
+  fileReader(const fileReader&);
+  fileReader& operator=(const fileReader&);
+
+  /// Set of the characters of a string, which is rebuilt only if the string changes.
+  struct charTable {
+    std::string chars;
+    charScanSet set;
+    bool valid;
+    charTable() : valid(false) {}
+    bool update(const std::string& str);
+    bool operator()(char ch) const { return set.has[(unsigned char)ch] != 0; }
+  };
+
+  //--- Private member data.
+  const char* buf;     // Content of the file.
+  std::size_t bufLen;  // Number of characters in \c buf.
+  std::size_t pos;     // Position of the next character to read.
+  bool atEOF;          // True if tried to read past the end of \c buf.
+  std::size_t linePos; // Position up to which \c lineNumber is counted.
+  void* mapAddr;       // Address of the mapping of the file, if any.
+  std::size_t mapLen;  // Length of the mapping.
+  std::string fileCopy;  // Content of the file, if it is not mapped.
+  charTable delimTable;
+  charTable illegalTable;
+  charScanSet tokenEndSet;  // Delimiters and illegal characters.
+  charTable commentTable;
+
+  //--- Private methods.
+  int getRawChar(void);
+  void skipToEndOfLine(void);
+  void countLines(void);
 };
 
 
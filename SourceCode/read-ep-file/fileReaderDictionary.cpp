@@ -11,6 +11,7 @@
 using std::string;
 
 #include <sstream>
+#include <vector>
 
 #include "fileReaderDictionary.h"
 
@@ -41,31 +42,28 @@ static const std::string IDD_COMMENT_CHARS_COMMENT = "!\\";
 
 ///////////////////////////////////////////////////////
 bool fileReaderDictionary::getKeywordAndDescriptor(string& keyword, string& desc){
-  bool onKeyword = 1;
+  int lineNo;
+  fileReaderSpan kw;
+  //
+  skipComment(IDD_COMMENT_CHARS_COMMENT, lineNo);
+  getToken(IDD_DELIMITERS, IDD_COMMENT_CHARS_TOKEN, kw);
+  keyword = kw.str();
+  capitalize(keyword);
+  //
+  return getDescriptor(kw, desc);
+}  // End method fileReaderDictionary::getKeywordAndDescriptor().
+
+
+//--- Get the descriptor of the object whose keyword was just read.
+//
+//   Read the fields up to the ';' that ends the object.
+//
+bool fileReaderDictionary::getDescriptor(const fileReaderSpan& keyword, string& desc){
   char ch;
+  int lineNo;
+  fileReaderSpan field;
   //
-  do{
-    int lineNo;
-    skipComment(IDD_COMMENT_CHARS_COMMENT, lineNo);
-    if( onKeyword ){
-      getToken(IDD_DELIMITERS, IDD_COMMENT_CHARS_TOKEN, keyword);
-      capitalize(keyword);
-      onKeyword = 0;
-    }
-    else{
-      string s;
-      getToken(IDD_DELIMITERS, IDD_COMMENT_CHARS_TOKEN, s);
-      if( ! containsChar("AN;", s[0]) ){
-        std::ostringstream os;
-        os << "For IDD keyword " << keyword
-           << ", expecting 'A' (alpha), 'N' (numeric), or ';', got '"
-           << s[0] << "'.";
-        fileReader::reportError(os);
-        return false; // error
-      }
-      if (s[0] != ';')
-        desc += s[0];
-    }
+  while( 1 ){
     skipComment(IDD_COMMENT_CHARS_COMMENT, lineNo);
     if (isEOF())
       return true;
@@ -76,28 +74,108 @@ bool fileReaderDictionary::getKeywordAndDescriptor(string& keyword, string& desc
       fileReader::reportError(os);
       return false; // error
     }
-  } while( ! ( ch==';' || isEOF() ) );
-  //
-  return true;
-}  // End method fileReaderDictionary::getKeywordAndDescriptor().
+    if( ch==';' || isEOF() )
+      return true;
+    skipComment(IDD_COMMENT_CHARS_COMMENT, lineNo);
+    getToken(IDD_DELIMITERS, IDD_COMMENT_CHARS_TOKEN, field);
+    const char mark = field.empty() ? '\0' : field[0];
+    if( ! containsChar("AN;", mark) ){
+      string kw = keyword.str();
+      capitalize(kw);
+      std::ostringstream os;
+      os << "For IDD keyword " << kw
+         << ", expecting 'A' (alpha), 'N' (numeric), or ';', got '"
+         << mark << "'.";
+      fileReader::reportError(os);
+      return false; // error
+    }
+    if (mark != ';')
+      desc += mark;
+  }
+}  // End method fileReaderDictionary::getDescriptor().
+
+
+//--- Skip the object whose keyword was just read.
+//
+//   Look only for the ';' that ends the object, outside of comments, which
+// may contain a ';'.  The fields are not checked.
+//
+void fileReaderDictionary::skipObject(void){
+  skipPast(';', IDD_COMMENT_CHARS_COMMENT);
+}  // End method fileReaderDictionary::skipObject().
 
 
 ///////////////////////////////////////////////////////
 void fileReaderDictionary::getMap(iddMap& idd){
+  //
+  fileReaderSpan kw;
+  string desc;
+  int lineNo;
   //
   while (! isEOF() ){
-    string kw = "";
-    string desc = "";
-    if( ! getKeywordAndDescriptor(kw, desc) ){
+    skipComment(IDD_COMMENT_CHARS_COMMENT, lineNo);
+    getToken(IDD_DELIMITERS, IDD_COMMENT_CHARS_TOKEN, kw);
+    desc.clear();
+    if( ! getDescriptor(kw, desc) ){
       std::ostringstream os;
       os << "fileReaderDictionary::getMap(): Exit with error.";
       fileReader::reportError(os);
-      exit(1);
+      throw fileReaderError(fileName + ": " + os.str());
     }
     // Store new keyword and descriptor.
     // hoho dml  Note no check whether overwriting an existing entry.
-    idd[kw] = desc;
-    int lineNo;
+    idd.set(kw.data(), kw.size(), desc.data(), desc.size());
     skipComment(IDD_COMMENT_CHARS_COMMENT, lineNo);
   }// end while
 }
+
+
+///////////////////////////////////////////////////////
+bool fileReaderDictionary::getMapCached(iddMap& idd){
+  const string cacheFileName = fileName + IDD_CACHE_SUFFIX;
+  //
+  if( iddCache_read(cacheFileName, fileName, idd) )
+    return true;
+  getMap(idd);
+  iddCache_write(cacheFileName, fileName, idd);
+  return false;
+}
+
+
+///////////////////////////////////////////////////////
+int fileReaderDictionary::getMap(iddMap& idd, const std::set<string>& keywords){
+  iddMap wanted;
+  std::set<string>::const_iterator it;
+  fileReaderSpan kw;
+  string desc;
+  int lineNo;
+  int foundCt = 0;
+  //
+  for( it=keywords.begin(); it!=keywords.end(); ++it )
+    wanted.set(*it, "");
+  std::vector<bool> found(wanted.size(), false);
+  //
+  skipComment(IDD_COMMENT_CHARS_COMMENT, lineNo);
+  while( ! isEOF() && foundCt < (int)wanted.size() ){
+    getToken(IDD_DELIMITERS, IDD_COMMENT_CHARS_TOKEN, kw);
+    const int atom = wanted.find(kw.data(), kw.size());
+    if( atom < 0 || found[atom] ){
+      skipObject();
+    }
+    else{
+      desc.clear();
+      if( ! getDescriptor(kw, desc) ){
+        std::ostringstream os;
+        os << "fileReaderDictionary::getMap(): Exit with error.";
+        fileReader::reportError(os);
+        throw fileReaderError(fileName + ": " + os.str());
+      }
+      idd.set(kw.data(), kw.size(), desc.data(), desc.size());
+      found[atom] = true;
+      ++foundCt;
+    }
+    skipComment(IDD_COMMENT_CHARS_COMMENT, lineNo);
+  }
+  //
+  return( foundCt );
+}
@@ -12,8 +12,12 @@
 #define __FILEREADERDICTIONARY_H__
 
 
+#include <set>
+#include <string>
+
 #include "fileReader.h"
 
+#include "ep-idd-cache.h"
 #include "ep-idd-map.h"
 
 
@@ -39,12 +43,51 @@ class fileReaderDictionary : public fileReader {
   ///  After execution, all keywords and their descriptors are stored
   ///  in the argument \c idd.
   ///
-  ///  \note In case of input error, the program terminates.
+  ///  \note In case of input error, the error is reported by this method,
+  ///  and a \c fileReaderError is thrown.
   ///
   /// \pre This method requires the input file stream to be open.
   /// \retval idd Map that contains the keywords and their descriptors.
   void getMap(iddMap& idd);
 
+  /// Gets the data descriptors of some keywords from the input file stream.
+  ///
+  ///  Objects of other keywords are skipped, looking only for the ';' that
+  ///  ends them, and their fields are not checked.  Reading stops as soon
+  ///  as all keywords are found, so for a keyword that appears more than
+  ///  once, the first descriptor is stored, rather than the last one as
+  ///  with \c getMap().
+  ///
+  ///  \note In case of input error, the error is reported by this method,
+  ///  and a \c fileReaderError is thrown.
+  ///
+  /// \pre This method requires the input file stream to be open.
+  /// \param keywords Keywords to get, in any case.
+  /// \retval idd Map that contains the keywords found and their descriptors.
+  /// \return Number of keywords found.
+  int getMap(iddMap& idd, const std::set<std::string>& keywords);
+
+  /// Gets all keywords and their corresponding data descriptors, from
+  ///  the binary cache of the IDD file if it is up to date.
+  ///
+  ///  The cache is the file with the name of the IDD file and suffix
+  ///  \c IDD_CACHE_SUFFIX, see \c ep-idd-cache.h.  If the cache is missing,
+  ///  or was written for another content of the IDD file, this method calls
+  ///  \c getMap() and writes the cache.  Failing to write the cache is not
+  ///  an error, as the next run will parse the IDD file again.
+  ///
+  ///  \note In case of input error, the error is reported by this method,
+  ///  and a \c fileReaderError is thrown.
+  ///
+  /// \pre This method requires the input file stream to be open.
+  /// \retval idd Map that contains the keywords and their descriptors.
+  /// \return \c true if the map was read from the cache.
+  bool getMapCached(iddMap& idd);
+
+  private:
+  bool getDescriptor(const fileReaderSpan& keyword, std::string& desc);
+  void skipObject(void);
+
 };
 
 
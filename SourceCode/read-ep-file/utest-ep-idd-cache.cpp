@@ -0,0 +1,298 @@
+//--- Unit test and benchmark for ep-idd-cache.cpp.
+//
+/// \brief  Unit test and benchmark for ep-idd-cache.cpp.
+///
+/// Reads an IDD file with \c fileReaderDictionary::getMap(), and checks
+/// that \c fileReaderDictionary::getMapCached() writes a cache on the first
+/// call, and reads the same map from it on the next calls.  Checks that a
+/// cache is ignored if the IDD file changed, or if the cache is truncated
+/// or damaged.  Reports the time to parse the IDD file, and to read the
+/// cache with and without finding the digest of the IDD file.
+///
+/// Build on Linux, from this directory, with
+///   g++ -O2 utest-ep-idd-cache.cpp char-scan.cpp ep-idd-cache.cpp ep-idd-map.cpp fileReader.cpp
+///     fileReaderDictionary.cpp ../utility/digest-md5.cpp ../utility/string-help.cpp -o utest-ep-idd-cache
+/// and run with the IDD file of EnergyPlus, for example
+///   ./utest-ep-idd-cache Energy+.idd
+
+
+//--- Includes.
+#include <assert.h>
+#include <stdio.h>
+#include <time.h>
+#include <utime.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+using std::string;
+using std::cout;
+using std::endl;
+
+#include "ep-idd-cache.h"
+#include "fileReaderDictionary.h"
+
+
+//--- File-scope constants.
+static const char* IDD_TEST_FILE = "utest-ep-idd-cache.idd";
+static const char* IDD_OTHER_TEST_FILE = "utest-ep-idd-cache-other.idd";
+static const char* CACHE_TEST_FILE = "utest-ep-idd-cache.idd" IDD_CACHE_SUFFIX;
+static const size_t CACHE_HEADER_SIZE = 88;
+static const int N_READ = 20;
+
+
+//--- Copy a file, or its first {maxLen} characters.
+//
+static void copyFile(const char* srcFileName, const char* dstFileName, size_t maxLen) {
+  std::ifstream in(srcFileName, std::ios::binary);
+  std::ostringstream content;
+  content << in.rdbuf();
+  std::ofstream out(dstFileName, std::ios::binary | std::ios::trunc);
+  out << content.str().substr(0, maxLen);
+}
+
+
+//--- Set the modification time of a file to {age} seconds ago.
+//
+static void setAge(const char* fileName, int age) {
+  struct utimbuf times;
+  times.actime = times.modtime = time(NULL) - age;
+  assert( 0 == utime(fileName, &times) );
+}
+
+
+//--- Get the map with {getMapCached()}, and return its result.
+//
+static bool getMapCached(const char* fileName, iddMap& idd) {
+  fileReaderDictionary frIdd(fileName);
+  frIdd.open();
+  idd.clear();
+  const bool fromCache = frIdd.getMapCached(idd);
+  frIdd.close();
+  return( fromCache );
+}
+
+
+//--- Time reading the cache.
+//
+static double timeRead(const iddMap& iddRef) {
+  iddMap idd;
+  clock_t tic = clock();
+  for( int idx=0; idx<N_READ; ++idx )
+    assert( getMapCached(IDD_TEST_FILE, idd) );
+  assert( idd == iddRef );
+  return( 1e3*(double)(clock()-tic)/CLOCKS_PER_SEC/N_READ );
+}
+
+
+//--- Main driver.
+//
+int main(int argc, const char* argv[]) {
+  //
+  iddMap iddRef, idd;
+  string desc;
+  string cache;
+  clock_t tic;
+  double tParse, tDigest, tStat;
+  //
+  if( 2 != argc ){
+    cout << "Error: missing filename\nUsage: " << argv[0] << "  <name of IDD file>\n";
+    return(1);
+  }
+  copyFile(argv[1], IDD_TEST_FILE, string::npos);
+  remove(CACHE_TEST_FILE);
+  //
+  // Parse the IDD file.
+  tic = clock();
+  {
+    fileReaderDictionary frIdd(IDD_TEST_FILE);
+    frIdd.open();
+    frIdd.getMap(iddRef);
+    frIdd.close();
+  }
+  tParse = 1e3*(double)(clock()-tic)/CLOCKS_PER_SEC;
+  assert( ! iddRef.empty() );
+  //
+  // The first call writes the cache, the next ones read it.  The IDD file
+  // was modified in the second the cache was written, so its digest is checked.
+  assert( ! getMapCached(IDD_TEST_FILE, idd) );
+  assert( idd == iddRef );
+  tDigest = timeRead(iddRef);
+  //
+  // The digest of an IDD file modified before the cache was written is
+  // not checked.
+  setAge(IDD_TEST_FILE, 3600);
+  remove(CACHE_TEST_FILE);
+  assert( ! getMapCached(IDD_TEST_FILE, idd) );
+  tStat = timeRead(iddRef);
+  //
+  // A cache for another IDD file is ignored, and leaves the map unchanged.
+  copyFile(argv[1], IDD_OTHER_TEST_FILE, string::npos);
+  {
+    std::ofstream(IDD_OTHER_TEST_FILE, std::ios::binary | std::ios::app) << "\n";
+  }
+  idd.clear();
+  assert( ! iddCache_read(CACHE_TEST_FILE, IDD_OTHER_TEST_FILE, idd) );
+  assert( idd.empty() );
+  remove(IDD_OTHER_TEST_FILE);
+  //
+  // An IDD file changed without changing its size is read again.
+  copyFile(argv[1], IDD_TEST_FILE, string::npos);
+  {
+    std::fstream idd(IDD_TEST_FILE, std::ios::binary | std::ios::in | std::ios::out);
+    const char first = (char)idd.get();
+    idd.seekp(0);
+    idd.put(first == '!' ? '#' : '!');
+  }
+  setAge(IDD_TEST_FILE, 1800);
+  assert( ! iddCache_read(CACHE_TEST_FILE, IDD_TEST_FILE, idd) );
+  assert( idd.empty() );
+  copyFile(argv[1], IDD_TEST_FILE, string::npos);
+  setAge(IDD_TEST_FILE, 3600);
+  assert( iddCache_read(CACHE_TEST_FILE, IDD_TEST_FILE, idd) );
+  assert( idd == iddRef );
+  //
+  // A truncated or damaged cache is ignored.
+  {
+    std::ifstream in(CACHE_TEST_FILE, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    cache = content.str();
+  }
+  assert( cache.size() > CACHE_HEADER_SIZE + 16 );
+  {
+    std::ofstream(CACHE_TEST_FILE, std::ios::binary | std::ios::trunc) << cache.substr(0, cache.size()-1);
+  }
+  idd.clear();
+  assert( ! iddCache_read(CACHE_TEST_FILE, IDD_TEST_FILE, idd) );
+  assert( idd.empty() );
+  //
+  // Index of the first keyword past the end of the characters.
+  {
+    string damaged = cache;
+    damaged.replace(CACHE_HEADER_SIZE, 4, "\xff\xff\xff\x7f");
+    std::ofstream(CACHE_TEST_FILE, std::ios::binary | std::ios::trunc) << damaged;
+  }
+  assert( ! iddCache_read(CACHE_TEST_FILE, IDD_TEST_FILE, idd) );
+  assert( idd.empty() );
+  //
+  // A damaged cache is rewritten.
+  assert( ! getMapCached(IDD_TEST_FILE, idd) );
+  assert( getMapCached(IDD_TEST_FILE, idd) );
+  assert( idd == iddRef );
+  //
+  // A changed IDD file replaces the cache.
+  {
+    std::ofstream(IDD_TEST_FILE, std::ios::binary | std::ios::app) << "\nUtest-Extra-Object,\n  A1;\n";
+  }
+  assert( ! getMapCached(IDD_TEST_FILE, idd) );
+  assert( idd.size() == iddRef.size()+1 && idd.find("UTEST-EXTRA-OBJECT") >= 0 );
+  idd.getDescriptor(idd.find("UTEST-EXTRA-OBJECT"), desc);
+  assert( desc == "A" );
+  assert( getMapCached(IDD_TEST_FILE, idd) );
+  assert( idd.size() == iddRef.size()+1 );
+  //
+  // An empty map.
+  idd.clear();
+  assert( iddCache_write(CACHE_TEST_FILE, IDD_TEST_FILE, idd) );
+  idd.set("X", "A");
+  assert( iddCache_read(CACHE_TEST_FILE, IDD_TEST_FILE, idd) );
+  assert( idd.size() == 1 );
+  //
+  // A cache that cannot be written is not an error.
+  assert( ! iddCache_write("utest-ep-idd-cache-missing/x.idd.cache", IDD_TEST_FILE, iddRef) );
+  //
+  remove(IDD_TEST_FILE);
+  remove(CACHE_TEST_FILE);
+  //
+  cout.setf(std::ios::fixed);
+  cout.precision(1);
+  cout << argv[1] << ": " << iddRef.size() << " keywords, getMap() " << tParse
+    << " ms, from cache with digest " << tDigest << " ms, from cache without digest "
+    << tStat << " ms" << endl;
+  //
+  return(0);
+}  // End fcn main().
+
+/*
+***********************************************************************************
+Copyright Notice
+----------------
+
+Functional Mock-up Unit Export of EnergyPlus (C)2013, The Regents of
+the University of California, through Lawrence Berkeley National
+Laboratory (subject to receipt of any required approvals from
+the U.S. Department of Energy). All rights reserved.
+
+If you have questions about your rights to use or distribute this software,
+please contact Berkeley Lab's Technology Transfer Department at
+TTD@lbl.gov.referring to "Functional Mock-up Unit Export
+of EnergyPlus (LBNL Ref 2013-088)".
+
+NOTICE: This software was produced by The Regents of the
+University of California under Contract No. DE-AC02-05CH11231
+with the Department of Energy.
+For 5 years from November 1, 2012, the Government is granted for itself
+and others acting on its behalf a nonexclusive, paid-up, irrevocable
+worldwide license in this data to reproduce, prepare derivative works,
+and perform publicly and display publicly, by or on behalf of the Government.
+There is provision for the possible extension of the term of this license.
+Subsequent to that period or any extension granted, the Government is granted
+for itself and others acting on its behalf a nonexclusive, paid-up, irrevocable
+worldwide license in this data to reproduce, prepare derivative works,
+distribute copies to the public, perform publicly and display publicly,
+and to permit others to do so. The specific term of the license can be identified
+by inquiry made to Lawrence Berkeley National Laboratory or DOE. Neither
+the United States nor the United States Department of Energy, nor any of their employees,
+makes any warranty, express or implied, or assumes any legal liability or responsibility
+for the accuracy, completeness, or usefulness of any data, apparatus, product,
+or process disclosed, or represents that its use would not infringe privately owned rights.
+
+
+Copyright (c) 2013, The Regents of the University of California, Department
+of Energy contract-operators of the Lawrence Berkeley National Laboratory.
+All rights reserved.
+
+1. Redistribution and use in source and binary forms, with or without modification,
+are permitted provided that the following conditions are met:
+
+(1) Redistributions of source code must retain the copyright notice, this list
+of conditions and the following disclaimer.
+
+(2) Redistributions in binary form must reproduce the copyright notice, this list
+of conditions and the following disclaimer in the documentation and/or other
+materials provided with the distribution.
+
+(3) Neither the name of the University of California, Lawrence Berkeley
+National Laboratory, U.S. Dept. of Energy nor the names of its contributors
+may be used to endorse or promote products derived from this software without
+specific prior written permission.
+
+2. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA,
+OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+
+3. You are under no obligation whatsoever to provide any bug fixes, patches,
+or upgrades to the features, functionality or performance of the source code
+("Enhancements") to anyone; however, if you choose to make your Enhancements
+available either publicly, or directly to Lawrence Berkeley National Laboratory,
+without imposing a separate written license agreement for such Enhancements,
+then you hereby grant the following license: a non-exclusive, royalty-free
+perpetual license to install, use, modify, prepare derivative works, incorporate
+into other computer software, distribute, and sublicense such enhancements or
+derivative works thereof, in binary and source code form.
+
+NOTE: This license corresponds to the "revised BSD" or "3-clause BSD"
+License and includes the following modification: Paragraph 3. has been added.
+
+
+***********************************************************************************
+*/
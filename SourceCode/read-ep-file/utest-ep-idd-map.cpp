@@ -8,6 +8,7 @@
 
 //--- Includes.
 #include <assert.h>
+#include <stdio.h>
 
 #include <string>
 using std::string;
@@ -29,9 +30,9 @@ int main(int argc, const char* argv[]) {
   const string keyMissing = "keyMissing";
   //
   iddMap idd;
-  idd[key1] = desc1;
-  idd[key2] = desc2;
-  idd[keyBad] = descBad;
+  idd.set(key1, desc1);
+  idd.set(key2, desc2);
+  idd.set(keyBad, descBad);
   //
   //-- Test fcn iddMap_getDescriptor().
   string descGot;
@@ -100,6 +101,58 @@ int main(int argc, const char* argv[]) {
   assert( 0 == errStr.compare("Input data dictionary does not contain key 'keyMissing'"
     "\nFor key 'key1', input data dictionary has descriptor 'AA', but expecting 'ANANAN'") );
   //
+  //-- Test class iddMap.
+  //   Keywords are found in any case, and stored in upper case.
+  string keyGot;
+  assert( 3 == idd.size() );
+  assert( 0 == idd.find("KEY1") && 0 == idd.find("Key1") );
+  assert( 2 == idd.find("KEYBAD") );
+  assert( -1 == idd.find(keyMissing) && -1 == idd.find("key") && -1 == idd.find("") );
+  idd.getKeyword(2, keyGot);
+  assert( 0 == keyGot.compare("KEYBAD") );
+  //
+  // Setting a keyword again keeps its atom, with a shorter or longer descriptor.
+  assert( 1 == idd.set("KEY2", "N") );
+  idd.getDescriptor(1, descGot);
+  assert( 0 == descGot.compare("N") );
+  assert( 1 == idd.set("kEy2", desc2 + desc2) );
+  idd.getDescriptor(1, descGot);
+  assert( descGot == desc2 + desc2 );
+  idd.getDescriptor(0, descGot);
+  assert( descGot == desc1 );
+  assert( 3 == idd.size() );
+  //
+  // Maps with the same entries are equal, whatever the order they were set in.
+  iddMap other;
+  other.set("KEYBAD", descBad);
+  other.set("KEY2", desc2);
+  assert( other != idd );
+  other.set("KEY1", desc1);
+  assert( other != idd );
+  other.set("key2", desc2 + desc2);
+  assert( other == idd );
+  other.set("key2", desc2);
+  assert( other != idd );
+  //
+  // The table grows as keywords are added.
+  iddMap big;
+  char keyBuf[32];
+  int atom;
+  for( atom=0; atom<1000; ++atom ){
+    sprintf(keyBuf, "Key:%d", atom);
+    assert( atom == big.set(keyBuf, desc1) );
+  }
+  for( atom=0; atom<1000; ++atom ){
+    sprintf(keyBuf, "KEY:%d", atom);
+    assert( atom == big.find(keyBuf) );
+    big.getKeyword(atom, keyGot);
+    assert( 0 == keyGot.compare(keyBuf) );
+  }
+  assert( -1 == big.find("KEY:1000") );
+  big.clear();
+  assert( big.empty() && -1 == big.find("KEY:0") );
+  assert( 0 == big.set("KEY:0", "") );
+  //
   return( 0 );
 }  // End fcn main().
 
@@ -0,0 +1,244 @@
+//--- Unit test and benchmark for the tokenizer of fileReader.cpp.
+//
+/// \brief  Unit test and benchmark for the tokenizer of fileReader.cpp.
+///
+/// Splits an IDD file and an IDF file into tokens, once with \c fileReader,
+/// and once with a reference reader that reads the file one character at
+/// a time from a \c std::ifstream, as \c fileReader used to.  Checks that
+/// both readers find the same tokens on the same lines, and reports the
+/// time each reader takes, and the time to read all keywords or a few
+/// keywords of the IDD file.  The IDF file is repeated to the requested size,
+/// for example 50 MB, in a temporary file.
+///
+/// Build on Linux, from this directory, with
+///   g++ -O2 utest-fileReader-speed.cpp char-scan.cpp ep-idd-cache.cpp ep-idd-map.cpp fileReader.cpp fileReaderDictionary.cpp
+///     ../utility/digest-md5.cpp ../utility/string-help.cpp -o utest-fileReader-speed
+/// and run with the IDD file of EnergyPlus, for example
+///   ./utest-fileReader-speed Energy+.idd in.idf 50
+
+
+//--- Includes.
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+using std::string;
+using std::cout;
+using std::endl;
+
+#include "fileReader.h"
+#include "fileReaderDictionary.h"
+
+
+//--- File-scope constants.
+static const string DELIMITERS = ",;";
+static const string ILLEGAL_CHARS = "!";
+static const string IDD_COMMENT_CHARS = "!\\";
+static const string IDF_COMMENT_CHARS = "!";
+static const char* IDF_TEST_FILE = "utest-fileReader-speed.idf";
+
+
+//--- A token and the line on which it starts.
+struct lineToken {
+  int lineNo;
+  string token;
+};
+
+
+//--- Reference reader, which reads one character at a time from a stream.
+//
+class streamReader {
+public:
+  streamReader(const char* fileName) : fileStream(fileName), lineNumber(1) {
+    assert( fileStream.is_open() );
+  }
+  bool isEOF() { return fileStream.eof(); }
+  void skipComment(const string& commentSign, int& lineNo) {
+    char ch;
+    if( fileStream.eof() )
+      return;
+    while( 1 ){
+      skipSpace(lineNo);
+      if( fileStream.eof() )
+        break;
+      fileStream.get(ch);
+      if( fileStream.eof() )
+        break;
+      if( commentSign.find(ch) == string::npos ){
+        fileStream.putback(ch);
+        break;
+      }
+      string dummy;
+      getline(fileStream, dummy);
+      lineNo = ++lineNumber;
+    }
+  }
+  void getToken(const string& delimiters, const string& illegalChars, string& token) {
+    char ch;
+    token = "";
+    if( fileStream.eof() )
+      return;
+    while( 1 ){
+      fileStream.get(ch);
+      if( fileStream.eof() )
+        break;
+      if( '\n' == ch )
+        ++lineNumber;
+      if( delimiters.find(ch) != string::npos ){
+        fileStream.putback(ch);
+        break;
+      }
+      assert( illegalChars.find(ch) == string::npos );
+      token += ch;
+    }
+  }
+  bool moveForward(int skipCharCt) {
+    assert( skipCharCt == 1 );
+    const int charAsInt = fileStream.get();
+    if( '\n' == charAsInt )
+      ++lineNumber;
+    return( EOF != charAsInt );
+  }
+private:
+  void skipSpace(int& lineNo) {
+    while( ! fileStream.eof() ){
+      const int charAsInt = fileStream.get();
+      if( EOF == charAsInt )
+        break;
+      if( '\n' == charAsInt )
+        ++lineNumber;
+      if( ! isspace(charAsInt) ){
+        fileStream.putback((char)charAsInt);
+        break;
+      }
+    }
+    lineNo = lineNumber;
+  }
+  std::ifstream fileStream;
+  int lineNumber;
+};
+
+
+//--- Split a file into tokens, with either reader.
+//
+template <class reader>
+static void tokenize(reader& rd, const string& commentChars, std::vector<lineToken>& tokens) {
+  lineToken lt;
+  tokens.clear();
+  while( 1 ){
+    rd.skipComment(commentChars, lt.lineNo);
+    rd.getToken(DELIMITERS, ILLEGAL_CHARS, lt.token);
+    tokens.push_back(lt);
+    // Consume the delimiter.
+    if( ! rd.moveForward(1) )
+      break;
+  }
+}
+
+
+//--- Time both readers on a file, and check that they agree.
+//
+static void compareReaders(const char* fileName, const string& commentChars) {
+  std::vector<lineToken> refTokens, tokens;
+  clock_t tic;
+  double tRef, tNew;
+  size_t i, nByte;
+  //
+  tic = clock();
+  {
+    streamReader rd(fileName);
+    tokenize(rd, commentChars, refTokens);
+  }
+  tRef = 1e3*(double)(clock()-tic)/CLOCKS_PER_SEC;
+  //
+  tic = clock();
+  {
+    fileReader rd(fileName);
+    rd.open();
+    tokenize(rd, commentChars, tokens);
+    rd.close();
+  }
+  tNew = 1e3*(double)(clock()-tic)/CLOCKS_PER_SEC;
+  //
+  assert( tokens.size() == refTokens.size() );
+  for( i=0, nByte=0; i<tokens.size(); ++i ){
+    assert( tokens[i].lineNo == refTokens[i].lineNo );
+    assert( tokens[i].token == refTokens[i].token );
+    nByte += tokens[i].token.size() + 1;
+  }
+  //
+  cout.setf(std::ios::fixed);
+  cout.precision(1);
+  cout << fileName << ": " << tokens.size() << " tokens, "
+    << 1e-6*(double)nByte << " MB of tokens, stream " << tRef << " ms, fileReader "
+    << tNew << " ms, speedup " << (tNew > 0 ? tRef/tNew : 0) << endl;
+}
+
+
+//--- Main driver.
+//
+int main(int argc, const char* argv[]) {
+  //
+  clock_t tic;
+  //
+  if( argc < 3 || argc > 4 ){
+    cout << "Error: missing filename\nUsage: " << argv[0]
+      << "  <name of IDD file>  <name of IDF file>  [size of IDF file in MB]\n";
+    return(1);
+  }
+  //
+  // The dictionary.
+  compareReaders(argv[1], IDD_COMMENT_CHARS);
+  {
+    fileReaderDictionary frIdd(argv[1]);
+    iddMap idd;
+    tic = clock();
+    frIdd.open();
+    frIdd.getMap(idd);
+    frIdd.close();
+    cout << argv[1] << ": getMap() read " << idd.size() << " keywords in "
+      << 1e3*(double)(clock()-tic)/CLOCKS_PER_SEC << " ms" << endl;
+  }
+  {
+    // Worst case for reading a few keywords: one is missing, so the whole
+    // file is read.
+    fileReaderDictionary frIdd(argv[1]);
+    std::set<string> keywords;
+    iddMap idd;
+    keywords.insert("ExternalInterface");
+    keywords.insert("ExternalInterface:FunctionalMockupUnitExport:To:Variable");
+    keywords.insert("No-Such-Keyword");
+    tic = clock();
+    frIdd.open();
+    frIdd.getMap(idd, keywords);
+    frIdd.close();
+    cout << argv[1] << ": getMap() of " << keywords.size() << " keywords found "
+      << idd.size() << " in " << 1e3*(double)(clock()-tic)/CLOCKS_PER_SEC << " ms" << endl;
+  }
+  //
+  // The input file, repeated to the requested size.
+  if( argc == 4 ){
+    const size_t size = (size_t)(atof(argv[3])*1e6);
+    std::ifstream in(argv[2], std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    assert( content.str().size() > 0 );
+    std::ofstream out(IDF_TEST_FILE, std::ios::binary);
+    for( size_t written=0; written<size; written+=content.str().size() )
+      out << content.str();
+    out.close();
+    compareReaders(IDF_TEST_FILE, IDF_COMMENT_CHARS);
+    remove(IDF_TEST_FILE);
+  }
+  else{
+    compareReaders(argv[2], IDF_COMMENT_CHARS);
+  }
+  //
+  return(0);
+}  // End fcn main().
@@ -48,10 +48,13 @@ int main(int argc, const char* argv[]) {
   frIdd.getMap(idd);
   //
   // Echo contents of IDD file.
-  iddMap::const_iterator it;
+  string key, desc;
+  int atom;
   cout << "(Keyword-->Descriptor) pairs in IDD file " << argv[1] << ":" << endl;
-  for( it=idd.begin(); it!=idd.end(); ++it ){
-    cout << "(" << it->first << "-->" << it->second << ")" << endl;
+  for( atom=0; atom<(int)idd.size(); ++atom ){
+    idd.getKeyword(atom, key);
+    idd.getDescriptor(atom, desc);
+    cout << "(" << key << "-->" << desc << ")" << endl;
   }
   //
   //-- Prepare input data file.
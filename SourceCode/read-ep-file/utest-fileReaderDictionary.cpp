@@ -8,7 +8,9 @@
 
 //--- Includes.
 #include <assert.h>
+#include <ctype.h>
 
+#include <set>
 #include <string>
 using std::string;
 
@@ -19,9 +21,14 @@ using std::endl;
 #include "fileReaderDictionary.h"
 
 
+//--- File-scope constants.
+static const string IDD_COMMENT_CHARS = "!\\";
+
+
 //--- Main driver.
 //
-//   Read an IDD file and echo its contents.
+//   Read an IDD file and echo its contents.  Then read some of its keywords
+// only, and check they match.
 //
 int main(int argc, const char* argv[]) {
   //
@@ -43,14 +50,54 @@ int main(int argc, const char* argv[]) {
   frIdd.getMap(idd);
   //
   // Echo contents.
-  iddMap::const_iterator it;
+  string key, desc;
+  int atom;
   cout << "(Keyword-->Descriptor) pairs in IDD file " << argv[1] << ":" << endl;
-  for( it=idd.begin(); it!=idd.end(); ++it ){
-    cout << "(" << it->first << "-->" << it->second << ")" << endl;
+  for( atom=0; atom<(int)idd.size(); ++atom ){
+    idd.getKeyword(atom, key);
+    idd.getDescriptor(atom, desc);
+    cout << "(" << key << "-->" << desc << ")" << endl;
   }
   //
   frIdd.close();
   //
+  // Read some of the keywords, given in lower case, and one that is missing.
+  std::set<string> keywords;
+  iddMap iddSome;
+  string someDesc;
+  for( atom=0; atom<(int)idd.size(); atom+=7 ){
+    idd.getKeyword(atom, key);
+    for( size_t ch=0; ch<key.size(); ++ch )
+      key[ch] = (char)tolower(key[ch]);
+    keywords.insert(key);
+  }
+  keywords.insert("No-Such-Keyword");
+  frIdd.open();
+  assert( frIdd.getMap(iddSome, keywords) == (int)keywords.size()-1 );
+  frIdd.close();
+  assert( iddSome.size() == keywords.size()-1 );
+  //
+  // Of a keyword that appears more than once, the first descriptor is read.
+  iddMap iddFirst;
+  int lineNo;
+  frIdd.open();
+  frIdd.skipComment(IDD_COMMENT_CHARS, lineNo);
+  while( ! frIdd.isEOF() ){
+    desc.clear();
+    assert( frIdd.getKeywordAndDescriptor(key, desc) );
+    if( iddFirst.find(key) < 0 )
+      iddFirst.set(key, desc);
+    frIdd.skipComment(IDD_COMMENT_CHARS, lineNo);
+  }
+  frIdd.close();
+  for( atom=0; atom<(int)iddSome.size(); ++atom ){
+    iddSome.getKeyword(atom, key);
+    iddSome.getDescriptor(atom, someDesc);
+    assert( iddFirst.find(key) >= 0 );
+    iddFirst.getDescriptor(iddFirst.find(key), desc);
+    assert( desc == someDesc );
+  }
+  //
   return(0);
 }  // End fcn main().
 
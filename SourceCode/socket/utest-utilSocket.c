@@ -0,0 +1,606 @@
+//--- Unit test for utilSocket.c.
+//
+/// \brief  Unit test for utilSocket.c.
+///
+/// Assembles and disassembles ASCII and binary buffers with an
+/// increasing number of doubles, checks the round trip, and reports
+/// the cost of both formats. Then exchanges data through three
+/// connections, which use the ASCII format, the binary format and
+/// shared memory, with different numbers of values. This checks that
+/// their state is kept apart, and that no buffer is allocated after
+/// the first exchange during an annual simulation with 10 minute
+/// time steps. As both ends run in this process, the reported time
+/// is the cost of an exchange without the scheduling latency.
+/// Then checks that an ASCII buffer that is longer than the header
+/// is read in several parts, and that a buffer with only a flag is read,
+/// and that a binary buffer with other numbers of values than the reader
+/// expects, a batch with longer rows than it holds, or a batch with fewer
+/// bytes than its steps need, is rejected.
+/// Then checks that the FMU accepts a client on the Unix domain socket
+/// or on the TCP socket, whichever it connects to. Finally, runs
+/// EnergyPlus in a child process to report the round trip time
+/// through a TCP socket, with and without the options set by
+/// setlowlatencysocketFMU, a Unix domain socket and shared memory,
+/// and the time per step if the inputs of several steps are exchanged
+/// in batches, or one step at a time with a server that cannot read
+/// batches.
+///
+/// Build on Linux, from this directory, with
+///   gcc -O3 utest-utilSocket.c utilSocket.c utilShm.c -lm -lrt -o utest-utilSocket
+
+
+//--- Includes.
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include "utilSocket.h"
+
+
+//--- File-scope constants.
+#define N_EXCHANGE 52560 // 365 days * 24 hours * 6 steps per hour
+#define UNIX_TEST_FILE "utest-utilSocket.sock"
+#define TRANSPORT_TCP  0
+#define TRANSPORT_UNIX 1
+#define TRANSPORT_SHM  2
+#define TRANSPORT_TCP_TUNED 3
+
+//--- Exchange one message through a pair of connected sockets.
+//
+//   Plays the server on {srv} and the FMU on {con}: the server writes
+// {nDbl} doubles, then the FMU reads them and writes them back.
+static void exchangeOnce(SocketConnection* srv, SocketConnection* con, int nDbl, double tim) {
+  int i, fla = 0, flaRea, nDblRea, nIntRea, nBooRea;
+  double timRea;
+  double dblVal[16], dblValRea[16];
+  assert( nDbl <= 16 );
+  for( i=0; i<nDbl; i++ ){
+    dblVal[i] = tim + i;
+  }
+  assert( 0 < writetosocketFMU(srv, &fla, &nDbl, &fla, &fla, &tim, dblVal, NULL, NULL) );
+  nDblRea = nDbl; nIntRea = 0; nBooRea = 0;
+  assert( 0 == readfromsocketFMU(con, &flaRea, &nDblRea, &nIntRea, &nBooRea, &timRea, dblValRea, NULL, NULL) );
+  assert( flaRea == 0 && nDblRea == nDbl && timRea == tim );
+  assert( 0 < writetosocketFMU(con, &fla, &nDblRea, &fla, &fla, &timRea, dblValRea, NULL, NULL) );
+  assert( 0 == readfromsocketFMU(srv, &flaRea, &nDblRea, &nIntRea, &nBooRea, &timRea, dblValRea, NULL, NULL) );
+  assert( flaRea == 0 && nDblRea == nDbl && timRea == tim );
+  for( i=0; i<nDbl; i++ ){
+    assert( dblValRea[i] == dblVal[i] );
+  }
+}
+
+
+//--- Read ASCII buffers that are longer than the initial read buffer,
+//    and a buffer that only contains a flag.
+//
+static void checkLongAsciiBuffer(void) {
+  const int nDbl = 5000;
+  int fd[2], i, rep, fla = 0, flaRea, nDblRea, nIntRea, nBooRea;
+  long nAlloc = 0;
+  double tim = 60.0, timRea;
+  double *dblVal = (double*)malloc(nDbl*sizeof(double));
+  double *dblValRea = (double*)malloc(nDbl*sizeof(double));
+  SocketConnection srv, con;
+  //
+  assert( 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fd) );
+  initconnectionFMU(&srv, fd[0]);
+  initconnectionFMU(&con, fd[1]);
+  for( rep=0; rep<2; rep++ ){
+    for( i=0; i<nDbl; i++ ){
+      dblVal[i] = -0.25*(i+rep);
+    }
+    assert( 0 < writetosocketFMU(&srv, &fla, &nDbl, &fla, &fla, &tim, dblVal, NULL, NULL) );
+    nDblRea = nDbl; nIntRea = 0; nBooRea = 0;
+    assert( 0 == readfromsocketFMU(&con, &flaRea, &nDblRea, &nIntRea, &nBooRea, &timRea, dblValRea, NULL, NULL) );
+    assert( flaRea == 0 && nDblRea == nDbl && timRea == tim );
+    for( i=0; i<nDbl; i++ ){
+      assert( dblValRea[i] == dblVal[i] );
+    }
+    // The read buffer is enlarged once, in the first exchange.
+    assert( con.readBufLen >= getrequiredbufferlengthFMU(nDbl, 0, 0) );
+    if( rep == 0 ) nAlloc = con.nAlloc;
+    assert( con.nAlloc == nAlloc );
+  }
+  assert( con.readLength == getrequiredbufferlengthFMU(nDbl, 0, 0) );
+  fla = 1;
+  assert( 0 < writetosocketFMU(&srv, &fla, &nDbl, &fla, &fla, &tim, dblVal, NULL, NULL) );
+  // The buffer only contains the version and the flag, which is shorter
+  // than a header. disassembleBufferFMU reports the missing values, but sets the flag.
+  flaRea = 0;
+  nDblRea = nDbl; nIntRea = 0; nBooRea = 0;
+  readfromsocketFMU(&con, &flaRea, &nDblRea, &nIntRea, &nBooRea, &timRea, dblValRea, NULL, NULL);
+  assert( flaRea == 1 );
+  freeconnectionFMU(&srv);
+  freeconnectionFMU(&con);
+  closeipcFMU(&fd[0]);
+  closeipcFMU(&fd[1]);
+  free(dblVal);
+  free(dblValRea);
+}
+
+
+//--- Reject binary buffers whose numbers of values differ from the
+//    expected ones, without writing past the arrays of the reader.
+//
+static void checkBinaryCounts(void) {
+  int fd[2], i, fla, flaRea, nDbl, nInt, nCha, nDblRea, nIntRea, nBooRea;
+  int intVal[2] = {7, 8};
+  double timRea, dblVal[4] = {1, 2, 3, 4}, dblValRea[4];
+  char buffer[BINARY_HEADER_LENGTH + 40];
+  SocketConnection con;
+  //
+  // Each case uses a new pair, as a rejected buffer is not read to its end.
+  for( i=0; i<4; i++ ){
+    assert( 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fd) );
+    initconnectionFMU(&con, fd[1]);
+    fla = (i == 3);
+    nDbl = (i == 0) ? 4 : 3;
+    nInt = (i == 1) ? 2 : 0;
+    nCha = assembleBinaryBufferFMU(BINARYVERSION, fla, nDbl, nInt, 0, 60.0, dblVal, intVal, NULL, buffer);
+    assert( nCha == write(fd[0], buffer, nCha) );
+    dblValRea[3] = -1;
+    nDblRea = 3; nIntRea = 0; nBooRea = 0;
+    if( i < 2 ){
+      // More doubles, or integers that have no array, are rejected.
+      assert( 0 != readfromsocketFMU(&con, &flaRea, &nDblRea, &nIntRea, &nBooRea, &timRea, dblValRea, NULL, NULL) );
+      assert( nDblRea == 3 && nIntRea == 0 );
+    }
+    else{
+      // The expected numbers, or no values with a flag, are accepted.
+      assert( 0 == readfromsocketFMU(&con, &flaRea, &nDblRea, &nIntRea, &nBooRea, &timRea, dblValRea, NULL, NULL) );
+      assert( flaRea == fla && nDblRea == (fla ? 0 : 3) && nIntRea == 0 );
+    }
+    assert( dblValRea[3] == -1 );
+    freeconnectionFMU(&con);
+    closeipcFMU(&fd[0]);
+    closeipcFMU(&fd[1]);
+  }
+}
+
+
+//--- Checks that a batch with longer rows than the reader holds is rejected.
+//
+static void checkBatchRowLength(void) {
+  int fd[2], i, fla = 0, flaRea, nDbl = 4, nStepRea, nDblRea;
+  double tim[2] = {0, 60}, timRea[2], dblVal[8], dblValRea[6];
+  SocketConnection srv, con;
+  //
+  assert( 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fd) );
+  initconnectionFMU(&srv, fd[0]);
+  initconnectionFMU(&con, fd[1]);
+  for( i=0; i<8; i++ ) dblVal[i] = i;
+  for( i=0; i<6; i++ ) dblValRea[i] = -1;
+  assert( 0 < writebatchtosocketFMU(&srv, 2, &fla, &nDbl, tim, dblVal) );
+  assert( 0 != readbatchfromsocketFMU(&con, 2, 3, &nStepRea, &flaRea, &nDblRea, timRea, dblValRea) );
+  assert( nStepRea == 0 );
+  for( i=0; i<6; i++ ) assert( dblValRea[i] == -1 );
+  // Shorter rows are stored with the stride of the longest row.
+  nDbl = 2;
+  assert( 0 < writebatchtosocketFMU(&srv, 2, &fla, &nDbl, tim, dblVal) );
+  assert( 0 == readbatchfromsocketFMU(&con, 2, 3, &nStepRea, &flaRea, &nDblRea, timRea, dblValRea) );
+  assert( nStepRea == 2 && nDblRea == 2 );
+  assert( dblValRea[0] == 0 && dblValRea[1] == 1 && dblValRea[2] == -1 );
+  assert( dblValRea[3] == 2 && dblValRea[4] == 3 && dblValRea[5] == -1 );
+  freeconnectionFMU(&srv);
+  freeconnectionFMU(&con);
+  closeipcFMU(&fd[0]);
+  closeipcFMU(&fd[1]);
+}
+
+
+//--- Writes a 32 bit integer in little-endian byte order, as in a batch header.
+//
+static void putInt32(char *buffer, int val) {
+  int i;
+  for( i=0; i<4; i++ ) buffer[i] = (char)(((unsigned int)val >> (8*i)) & 0xff);
+}
+
+
+//--- Checks that a batch with fewer bytes than its steps need is rejected.
+//
+static void checkBatchLength(void) {
+  const int nDbl = 10;
+  const int stepLen = getbinarybufferlengthFMU(nDbl, 0, 0);
+  int fd[2], i, nStepRea, flaRea, nDblRea;
+  double dblVal[10], timRea[2], dblValRea[20];
+  char buffer[BATCH_HEADER_LENGTH + 200];
+  SocketConnection con;
+  //
+  // The header announces two steps, but the batch only holds the first one.
+  for( i=0; i<nDbl; i++ ) dblVal[i] = i;
+  memcpy(buffer, BATCH_MAGIC, 4);
+  putInt32(buffer +  4, BATCHVERSION);
+  putInt32(buffer +  8, 2);
+  putInt32(buffer + 12, stepLen);
+  assert( stepLen == assembleBinaryBufferFMU(BATCHVERSION, 0, nDbl, 0, 0, 0.0,
+    dblVal, NULL, NULL, buffer + BATCH_HEADER_LENGTH) );
+  assert( 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fd) );
+  initconnectionFMU(&con, fd[1]);
+  assert( BATCH_HEADER_LENGTH + stepLen == write(fd[0], buffer, BATCH_HEADER_LENGTH + stepLen) );
+  assert( 0 != readbatchfromsocketFMU(&con, 2, nDbl, &nStepRea, &flaRea, &nDblRea, timRea, dblValRea) );
+  assert( nStepRea == 0 );
+  freeconnectionFMU(&con);
+  closeipcFMU(&fd[0]);
+  closeipcFMU(&fd[1]);
+}
+
+
+//--- Connect a client to the Unix domain socket or to the TCP socket, and
+//    check that the FMU accepts it on that socket.
+//
+static void checkAcceptFirst(int useUnix) {
+  int sockfd, unixsockfd, cliSockfd, conSockfd;
+  int fla = 0, nDbl = 1, flaRea, nDblRea, nIntRea, nBooRea;
+  double tim = 60.0, timRea, dblVal[1] = {1.5}, dblValRea[1];
+  struct sockaddr_in tcpAddr;
+  struct sockaddr_un unixAddr;
+  socklen_t addrLen = sizeof(tcpAddr);
+  SocketConnection srv, con;
+  //
+  sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  memset(&tcpAddr, 0, sizeof(tcpAddr));
+  tcpAddr.sin_family = AF_INET;
+  tcpAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  assert( 0 == bind(sockfd, (struct sockaddr*)&tcpAddr, sizeof(tcpAddr)) );
+  assert( 0 == listen(sockfd, 1) );
+  assert( 0 == getsockname(sockfd, (struct sockaddr*)&tcpAddr, &addrLen) );
+  unixsockfd = openunixsocketFMU(UNIX_TEST_FILE);
+  assert( unixsockfd >= 0 );
+  //
+  // The client connects before the FMU accepts, as the listen queue holds it.
+  cliSockfd = socket(useUnix ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+  if( useUnix ){
+    memset(&unixAddr, 0, sizeof(unixAddr));
+    unixAddr.sun_family = AF_UNIX;
+    strcpy(unixAddr.sun_path, UNIX_TEST_FILE);
+    assert( 0 == connect(cliSockfd, (struct sockaddr*)&unixAddr, sizeof(unixAddr)) );
+  }
+  else{
+    assert( 0 == connect(cliSockfd, (struct sockaddr*)&tcpAddr, sizeof(tcpAddr)) );
+  }
+  conSockfd = acceptfirstFMU(&sockfd, &unixsockfd);
+  assert( conSockfd >= 0 );
+  initconnectionFMU(&srv, cliSockfd);
+  initconnectionFMU(&con, conSockfd);
+  assert( 0 < writetosocketFMU(&srv, &fla, &nDbl, &fla, &fla, &tim, dblVal, NULL, NULL) );
+  nDblRea = nDbl; nIntRea = 0; nBooRea = 0;
+  assert( 0 == readfromsocketFMU(&con, &flaRea, &nDblRea, &nIntRea, &nBooRea, &timRea, dblValRea, NULL, NULL) );
+  assert( nDblRea == 1 && timRea == tim && dblValRea[0] == dblVal[0] );
+  freeconnectionFMU(&srv);
+  freeconnectionFMU(&con);
+  closeipcFMU(&cliSockfd);
+  closeipcFMU(&conSockfd);
+  closeipcFMU(&unixsockfd);
+  closeipcFMU(&sockfd);
+  remove(UNIX_TEST_FILE);
+}
+
+
+//--- Connect a pair of TCP sockets through the loopback interface.
+//
+//   {fd[0]} is the client, {fd[1]} the accepted connection.
+static void tcpPair(int fd[2]) {
+  int sockfd;
+  struct sockaddr_in addr;
+  socklen_t addrLen = sizeof(addr);
+  sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  assert( 0 == bind(sockfd, (struct sockaddr*)&addr, sizeof(addr)) );
+  assert( 0 == listen(sockfd, 1) );
+  assert( 0 == getsockname(sockfd, (struct sockaddr*)&addr, &addrLen) );
+  fd[0] = socket(AF_INET, SOCK_STREAM, 0);
+  assert( 0 == connect(fd[0], (struct sockaddr*)&addr, sizeof(addr)) );
+  fd[1] = accept(sockfd, NULL, NULL);
+  assert( fd[1] >= 0 );
+  closeipcFMU(&sockfd);
+}
+
+
+//--- Time round trips between this process, as the FMU, and a child process
+//    that plays EnergyPlus.
+//
+//   Uses the ASCII format through a socket, or shared memory, as selected
+// by {transport}. For TRANSPORT_TCP_TUNED, the FMU end of the TCP socket
+// is configured by setlowlatencysocketFMU, as done by the FMU.
+// Returns the mean round trip time in microseconds.
+static double timeRoundTrips(int transport, int nStep) {
+  const int nDbl = 16;
+  const int useShm = (transport == TRANSPORT_SHM);
+  int fd[2], i, step, status, fla = 0, flaRea, nDblRea, nIntRea, nBooRea;
+  double tim, timRea, dblVal[16], dblValRea[16];
+  struct timespec t0, t1;
+  SocketConnection con;
+  pid_t pid;
+  //
+  if( transport == TRANSPORT_TCP || transport == TRANSPORT_TCP_TUNED ){
+    tcpPair(fd);
+    if( transport == TRANSPORT_TCP_TUNED ){
+      assert( 0 == setlowlatencysocketFMU(&fd[1], getrequiredbufferlengthFMU(nDbl, 0, 0)) );
+    }
+  }
+  else{
+    assert( 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fd) );
+  }
+  initconnectionFMU(&con, fd[1]);
+  if( useShm ){
+    assert( 0 == shmcreateFMU(&con.shm, getbinarybufferlengthFMU(nDbl, 0, 0)) );
+  }
+  pid = fork();
+  assert( pid >= 0 );
+  if( pid == 0 ){
+    // EnergyPlus: attach, then send values and check the echo.
+    SocketConnection srv;
+    closeipcFMU(&fd[1]);
+    initconnectionFMU(&srv, fd[0]);
+    if( useShm && shmopenFMU(&srv.shm, con.shm.name) != 0 ) _exit(1);
+    for( step=0; step<nStep; step++ ){
+      tim = 600.0*step;
+      for( i=0; i<nDbl; i++ ) dblVal[i] = tim + i;
+      if( writetosocketFMU(&srv, &fla, &nDbl, &fla, &fla, &tim, dblVal, NULL, NULL) <= 0 ) _exit(2);
+      nDblRea = nDbl; nIntRea = 0; nBooRea = 0;
+      if( readfromsocketFMU(&srv, &flaRea, &nDblRea, &nIntRea, &nBooRea, &timRea, dblValRea, NULL, NULL) != 0 ) _exit(3);
+      if( nDblRea != nDbl || timRea != tim || dblValRea[nDbl-1] != dblVal[nDbl-1] ) _exit(4);
+    }
+    freeconnectionFMU(&srv);
+    _exit(0);
+  }
+  // FMU: echo the values.
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for( step=0; step<nStep; step++ ){
+    nDblRea = nDbl; nIntRea = 0; nBooRea = 0;
+    assert( 0 == readfromsocketFMU(&con, &flaRea, &nDblRea, &nIntRea, &nBooRea, &timRea, dblValRea, NULL, NULL) );
+    assert( 0 < writetosocketFMU(&con, &fla, &nDblRea, &fla, &fla, &timRea, dblValRea, NULL, NULL) );
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  assert( pid == waitpid(pid, &status, 0) );
+  assert( WIFEXITED(status) && WEXITSTATUS(status) == 0 );
+  assert( !useShm || shmisattachedFMU(&con.shm) );
+  freeconnectionFMU(&con);
+  closeipcFMU(&fd[0]);
+  closeipcFMU(&fd[1]);
+  return( (1e6*(t1.tv_sec-t0.tv_sec) + 1e-3*(t1.tv_nsec-t0.tv_nsec)) / nStep );
+}
+
+
+//--- Exchange {nBatch} batches of {nStep} steps between this process, as
+//    the FMU, and a child process that plays EnergyPlus, through TCP.
+//
+//   EnergyPlus sends version {serverVersion}, and returns for each step
+// twice the inputs at the end of the step. Unless it sends BATCHVERSION,
+// the steps are exchanged one at a time. Returns the mean time per step
+// in microseconds.
+static double timeBatches(int serverVersion, int nStep, int nBatch) {
+  const int nDbl = 16;
+  const double h = 600.0;
+  int fd[2], i, k, iBat, status, fla = 0, flaRea, nDblRea, nIntRea, nBooRea, nStepRea;
+  double *tim = (double*)malloc(nStep*sizeof(double));
+  double *timRea = (double*)malloc(nStep*sizeof(double));
+  double *dblVal = (double*)malloc(nStep*nDbl*sizeof(double));
+  double *dblValRea = (double*)malloc(nStep*nDbl*sizeof(double));
+  struct timespec t0, t1;
+  SocketConnection con;
+  pid_t pid;
+  //
+  tcpPair(fd);
+  assert( 0 == setlowlatencysocketFMU(&fd[1], getrequiredbufferlengthFMU(nDbl, 0, 0)) );
+  initconnectionFMU(&con, fd[1]);
+  pid = fork();
+  assert( pid >= 0 );
+  if( pid == 0 ){
+    // EnergyPlus: send the outputs at the start time, then reply to each batch.
+    SocketConnection srv;
+    int nDone = 0;
+    closeipcFMU(&fd[1]);
+    initconnectionFMU(&srv, fd[0]);
+    srv.serverVersion = BINARYVERSION;
+    srv.localVersion = serverVersion;
+    tim[0] = 0;
+    for( i=0; i<nDbl; i++ ) dblVal[i] = 0;
+    if( writetosocketFMU(&srv, &fla, &nDbl, &fla, &fla, &tim[0], dblVal, NULL, NULL) <= 0 ) _exit(1);
+    while( nDone < nStep*nBatch ){
+      nDblRea = nDbl;
+      if( readbatchfromsocketFMU(&srv, nStep, nDbl, &nStepRea, &flaRea, &nDblRea, timRea, dblValRea) != 0 ) _exit(2);
+      if( flaRea != 0 || nDblRea != nDbl ) _exit(3);
+      for( k=0; k<nStepRea; k++ ){
+        if( timRea[k] != h*(nDone+k) ) _exit(4);
+        tim[k] = timRea[k] + h;
+        for( i=0; i<nDbl; i++ ) dblVal[k*nDbl+i] = 2*dblValRea[k*nDbl+i];
+      }
+      if( serverVersion >= BATCHVERSION ){
+        if( writebatchtosocketFMU(&srv, nStepRea, &fla, &nDbl, tim, dblVal) <= 0 ) _exit(5);
+      }
+      else{
+        for( k=0; k<nStepRea; k++ ){
+          if( writetosocketFMU(&srv, &fla, &nDbl, &fla, &fla, &tim[k], &dblVal[k*nDbl], NULL, NULL) <= 0 ) _exit(5);
+        }
+      }
+      nDone += nStepRea;
+    }
+    freeconnectionFMU(&srv);
+    _exit(0);
+  }
+  // FMU: read the outputs at the start time, then exchange the batches.
+  nDblRea = nDbl; nIntRea = 0; nBooRea = 0;
+  assert( 0 == readfromsocketFMU(&con, &flaRea, &nDblRea, &nIntRea, &nBooRea, timRea, dblValRea, NULL, NULL) );
+  assert( con.serverVersion == serverVersion );
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  for( iBat=0; iBat<nBatch; iBat++ ){
+    for( k=0; k<nStep; k++ ){
+      tim[k] = h*(iBat*nStep+k);
+      for( i=0; i<nDbl; i++ ) dblVal[k*nDbl+i] = tim[k] + i;
+    }
+    nDblRea = nDbl;
+    assert( 0 == exchangebatchwithsocketFMU(&con, nStep, &fla, &nDbl, tim, dblVal,
+      nDbl, &nStepRea, &flaRea, &nDblRea, timRea, dblValRea) );
+    assert( nStepRea == nStep && flaRea == 0 && nDblRea == nDbl );
+    for( k=0; k<nStep; k++ ){
+      assert( timRea[k] == tim[k] + h );
+      for( i=0; i<nDbl; i++ ) assert( dblValRea[k*nDbl+i] == 2*dblVal[k*nDbl+i] );
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  assert( pid == waitpid(pid, &status, 0) );
+  assert( WIFEXITED(status) && WEXITSTATUS(status) == 0 );
+  freeconnectionFMU(&con);
+  closeipcFMU(&fd[0]);
+  closeipcFMU(&fd[1]);
+  free(tim);
+  free(timRea);
+  free(dblVal);
+  free(dblValRea);
+  return( (1e6*(t1.tv_sec-t0.tv_sec) + 1e-3*(t1.tv_nsec-t0.tv_nsec)) / (nStep*nBatch) );
+}
+
+
+//--- Main driver.
+//
+int main(int argc, const char* argv[]) {
+  //
+  const int nDblCon[] = {2, 16, 16};
+  const char* nameCon[] = {"ascii", "binary", "shared memory"};
+  int fd[3][2];
+  int iCon, step;
+  long nAlloc[3];
+  double tCon[3] = {0, 0, 0};
+  struct timespec t0, t1;
+  SocketConnection srv[3], con[3];
+  const int nDblList[] = {10, 100, 1000, 10000};
+  const int nRep = 200;
+  int iCase, i, rep, nDbl, bufLen, nCha;
+  int ver, fla, nDblRea, nIntRea, nBooRea;
+  double tim, tAsc, tBin;
+  double *dblVal, *dblValRea;
+  char *buffer;
+  clock_t tic;
+  //
+  printf("%8s  %16s  %16s\n", "nDbl", "ascii [us/msg]", "binary [us/msg]");
+  for( iCase=0; iCase<4; iCase++ ){
+    nDbl = nDblList[iCase];
+    dblVal = (double*)malloc(nDbl*sizeof(double));
+    dblValRea = (double*)malloc(nDbl*sizeof(double));
+    for( i=0; i<nDbl; i++ ){
+      dblVal[i] = 1.0/(i+3) - 1e5*i;
+    }
+    //
+    // ASCII round trip.
+    bufLen = getrequiredbufferlengthFMU(nDbl, 0, 0);
+    buffer = (char*)malloc(bufLen);
+    tic = clock();
+    for( rep=0; rep<nRep; rep++ ){
+      assert( 0 == assembleBufferFMU(0, nDbl, 0, 0, 3600.0, dblVal, NULL, NULL, &buffer, &bufLen) );
+      assert( 0 == disassembleBufferFMU(buffer, &ver, &fla, &nDblRea, &nIntRea, &nBooRea, &tim, dblValRea, NULL, NULL) );
+    }
+    tAsc = 1e6*(double)(clock()-tic)/CLOCKS_PER_SEC/nRep;
+    assert( fla == 0 && nDblRea == nDbl && tim == 3600.0 );
+    free(buffer);
+    //
+    // Binary round trip, which must reproduce the values exactly.
+    bufLen = getbinarybufferlengthFMU(nDbl, 0, 0);
+    buffer = (char*)malloc(bufLen);
+    tic = clock();
+    for( rep=0; rep<nRep; rep++ ){
+      nCha = assembleBinaryBufferFMU(BINARYVERSION, 0, nDbl, 0, 0, 3600.0, dblVal, NULL, NULL, buffer);
+      assert( nCha == bufLen );
+      assert( 0 == disassembleBinaryHeaderBufferFMU(buffer, &ver, &fla, &nDblRea, &nIntRea, &nBooRea, &tim) );
+      disassembleBinaryBufferFMU(buffer+BINARY_HEADER_LENGTH, nDblRea, nIntRea, nBooRea, dblValRea, NULL, NULL);
+    }
+    tBin = 1e6*(double)(clock()-tic)/CLOCKS_PER_SEC/nRep;
+    assert( ver == BINARYVERSION );
+    assert( fla == 0 && nDblRea == nDbl && nIntRea == 0 && nBooRea == 0 && tim == 3600.0 );
+    for( i=0; i<nDbl; i++ ){
+      assert( dblValRea[i] == dblVal[i] );
+    }
+    //
+    // A non-zero flag sends no values.
+    nCha = assembleBinaryBufferFMU(BINARYVERSION, 1, nDbl, 0, 0, 3600.0, dblVal, NULL, NULL, buffer);
+    assert( nCha == BINARY_HEADER_LENGTH );
+    assert( 0 == disassembleBinaryHeaderBufferFMU(buffer, &ver, &fla, &nDblRea, &nIntRea, &nBooRea, &tim) );
+    assert( fla == 1 && nDblRea == 0 );
+    free(buffer);
+    //
+    printf("%8d  %16.3f  %16.3f\n", nDbl, tAsc, tBin);
+    free(dblVal);
+    free(dblValRea);
+  }
+  //
+  // Three connections with different numbers of values, used in turn.
+  // The FMU creates the shared memory, and EnergyPlus attaches to it.
+  for( iCon=0; iCon<3; iCon++ ){
+    assert( 0 == socketpair(AF_UNIX, SOCK_STREAM, 0, fd[iCon]) );
+    initconnectionFMU(&srv[iCon], fd[iCon][0]);
+    initconnectionFMU(&con[iCon], fd[iCon][1]);
+  }
+  srv[1].serverVersion = BINARYVERSION;
+  assert( 0 == shmcreateFMU(&con[2].shm, getbinarybufferlengthFMU(16, 0, 0)) );
+  assert( 0 == shmisattachedFMU(&con[2].shm) );
+  assert( 0 == shmopenFMU(&srv[2].shm, con[2].shm.name) );
+  assert( 1 == shmisattachedFMU(&con[2].shm) );
+  shmunlinkFMU(&con[2].shm);
+  for( step=0; step<N_EXCHANGE; step++ ){
+    for( iCon=0; iCon<3; iCon++ ){
+      clock_gettime(CLOCK_MONOTONIC, &t0);
+      exchangeOnce(&srv[iCon], &con[iCon], nDblCon[iCon], 600.0*step);
+      clock_gettime(CLOCK_MONOTONIC, &t1);
+      tCon[iCon] += 1e6*(t1.tv_sec-t0.tv_sec) + 1e-3*(t1.tv_nsec-t0.tv_nsec);
+      if( step == 0 ){
+        nAlloc[iCon] = con[iCon].nAlloc;
+      }
+    }
+  }
+  // The buffers got their final size in the first exchange,
+  // and the shared memory does not use them.
+  for( iCon=0; iCon<3; iCon++ ){
+    assert( con[iCon].nAlloc == nAlloc[iCon] );
+  }
+  assert( nAlloc[2] == 0 );
+  assert( con[0].serverVersion == MAINVERSION );
+  assert( con[1].serverVersion == BINARYVERSION );
+  assert( con[2].serverVersion == BINARYVERSION );
+  assert( con[0].readLength == getrequiredbufferlengthFMU(2, 0, 0) );
+  assert( con[0].writeLength == getrequiredbufferlengthFMU(2, 0, 0) );
+  //
+  // A buffer that does not fit into the shared memory is rejected.
+  assert( NULL == shmgetwritebufferFMU(&con[2].shm, getbinarybufferlengthFMU(17, 0, 0)) );
+  //
+  printf("%16s  %16s  %16s\n", "connection", "allocations", "exchange [us]");
+  for( iCon=0; iCon<3; iCon++ ){
+    printf("%16s  %16ld  %16.3f\n", nameCon[iCon], nAlloc[iCon], tCon[iCon]/N_EXCHANGE);
+    freeconnectionFMU(&srv[iCon]);
+    freeconnectionFMU(&con[iCon]);
+    closeipcFMU(&fd[iCon][0]);
+    closeipcFMU(&fd[iCon][1]);
+  }
+  //
+  checkLongAsciiBuffer();
+  printf("Read ASCII buffers that are longer than the header.\n");
+  //
+  checkBinaryCounts();
+  printf("Rejected binary buffers with unexpected numbers of values.\n");
+  checkBatchRowLength();
+  printf("Rejected a batch with longer rows than the reader holds.\n");
+  checkBatchLength();
+  printf("Rejected a batch with fewer bytes than its steps need.\n");
+  //
+  checkAcceptFirst(1);
+  checkAcceptFirst(0);
+  printf("Accepted clients on the Unix domain socket and on the TCP socket.\n");
+  //
+  printf("%24s  %16s\n", "transport", "round trip [us]");
+  printf("%24s  %16.3f\n", "TCP socket", timeRoundTrips(TRANSPORT_TCP, N_EXCHANGE/10));
+  printf("%24s  %16.3f\n", "TCP socket, low latency", timeRoundTrips(TRANSPORT_TCP_TUNED, N_EXCHANGE/10));
+  printf("%24s  %16.3f\n", "Unix domain socket", timeRoundTrips(TRANSPORT_UNIX, N_EXCHANGE/10));
+  printf("%24s  %16.3f\n", "shared memory", timeRoundTrips(TRANSPORT_SHM, N_EXCHANGE/10));
+  //
+  printf("%24s  %16s\n", "exchange of 144 steps", "step [us]");
+  printf("%24s  %16.3f\n", "one step at a time", timeBatches(BINARYVERSION, 144, 20));
+  printf("%24s  %16.3f\n", "batch", timeBatches(BATCHVERSION, 144, N_EXCHANGE/144));
+  //
+  return( 0 );
+}  // End fcn main().
@@ -0,0 +1,258 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+///////////////////////////////////////////////////////
+/// \file   utilShm.c
+///
+/// \brief  Methods for exchanging data between the FMU
+///         and EnergyPlus through shared memory.
+///
+///////////////////////////////////////////////////////
+#include "utilShm.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+/// Counter that makes the names of the regions of a process unique.
+static uint32_t SHM_COUNTER = 0;
+
+////////////////////////////////////////////////////////////////
+/// Returns the header of the region.
+static ShmHeader* shmheaderFMU(const ShmChannel *shm){
+	return (ShmHeader*)shm->base;
+}
+
+////////////////////////////////////////////////////////////////
+/// Returns the start of a slot.
+static char* shmslotFMU(const ShmChannel *shm, int slot){
+	return shm->base + SHM_HEADER_LENGTH + (size_t)slot * shmheaderFMU(shm)->slotLength;
+}
+
+////////////////////////////////////////////////////////////////
+/// Maps the region of an open file descriptor.
+///
+///\return 0 if no error occurred.
+static int shmmapFMU(ShmChannel *shm, int fd, size_t size){
+	void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if ( base == MAP_FAILED ){
+		perror("mmap failed in shmmapFMU.");
+		return -1;
+	}
+	shm->base = (char*)base;
+	shm->size = size;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////
+/// Creates and maps a shared memory region as the server.
+///
+/// See utilShm.h.
+int shmcreateFMU(ShmChannel *shm, int slotLength){
+	int fd;
+	ShmHeader *hea;
+	// Align the slots to the size of a double.
+	const uint32_t slotLen = (uint32_t)((slotLength + 7) / 8 * 8);
+	const size_t size = SHM_HEADER_LENGTH + 2 * (size_t)slotLen;
+
+	if ( slotLength <= 0 )
+		return -1;
+	sprintf(shm->name, "/EnergyPlusToFMU-%ld-%u", (long)getpid(),
+		__atomic_fetch_add(&SHM_COUNTER, 1, __ATOMIC_RELAXED));
+	fd = shm_open(shm->name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+	if ( fd < 0 ){
+		perror("shm_open failed in shmcreateFMU.");
+		return -1;
+	}
+	shm->isLinked = 1;
+	shm->isServer = 1;
+	if ( ftruncate(fd, (off_t)size) != 0 || shmmapFMU(shm, fd, size) != 0 ){
+		close(fd);
+		shmcloseFMU(shm);
+		return -1;
+	}
+	close(fd);
+	// The region is zero-filled by ftruncate.
+	hea = shmheaderFMU(shm);
+	hea->version = SHM_VERSION;
+	hea->slotLength = slotLen;
+	memcpy(hea->magic, SHM_MAGIC, sizeof(hea->magic));
+	shm->seqRea = 0;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////
+/// Maps a shared memory region as the client and attaches to it.
+///
+/// See utilShm.h.
+int shmopenFMU(ShmChannel *shm, const char *name){
+	int fd;
+	struct stat st;
+	ShmHeader *hea;
+
+	fd = shm_open(name, O_RDWR, 0);
+	if ( fd < 0 ){
+		perror("shm_open failed in shmopenFMU.");
+		return -1;
+	}
+	if ( fstat(fd, &st) != 0 || st.st_size < SHM_HEADER_LENGTH
+		|| shmmapFMU(shm, fd, (size_t)st.st_size) != 0 ){
+		close(fd);
+		return -1;
+	}
+	close(fd);
+	strncpy(shm->name, name, sizeof(shm->name)-1);
+	shm->isServer = 0;
+	shm->isLinked = 0;
+	hea = shmheaderFMU(shm);
+	if ( memcmp(hea->magic, SHM_MAGIC, sizeof(hea->magic)) != 0
+		|| hea->version != SHM_VERSION
+		|| SHM_HEADER_LENGTH + 2 * (size_t)hea->slotLength > shm->size ){
+		fprintf(stderr, "Error: Shared memory region %s has an unknown layout.\n", name);
+		shmcloseFMU(shm);
+		return -1;
+	}
+	shm->seqRea = __atomic_load_n(&hea->seq[SHM_SLOT_SERVER], __ATOMIC_ACQUIRE);
+	__atomic_store_n(&hea->clientAttached, 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////
+/// Returns whether the client attached to the shared memory region.
+///
+/// See utilShm.h.
+int shmisattachedFMU(const ShmChannel *shm){
+	if ( shm->base == NULL )
+		return 0;
+	return __atomic_load_n(&shmheaderFMU(shm)->clientAttached, __ATOMIC_ACQUIRE) == 1;
+}
+
+////////////////////////////////////////////////////////////////
+/// Returns the slot into which a buffer can be assembled.
+///
+/// See utilShm.h.
+char* shmgetwritebufferFMU(ShmChannel *shm, int nCha){
+	if ( nCha < 0 || (uint32_t)nCha > shmheaderFMU(shm)->slotLength ){
+		fprintf(stderr, "Error: Buffer of %d bytes does not fit into shared memory slot.\n", nCha);
+		return NULL;
+	}
+	return shmslotFMU(shm, shm->isServer ? SHM_SLOT_SERVER : SHM_SLOT_CLIENT);
+}
+
+////////////////////////////////////////////////////////////////
+/// Publishes the buffer that was assembled in the slot.
+///
+/// See utilShm.h.
+int shmpostFMU(ShmChannel *shm, int nCha){
+	ShmHeader *hea = shmheaderFMU(shm);
+	const int slot = shm->isServer ? SHM_SLOT_SERVER : SHM_SLOT_CLIENT;
+	hea->nCha[slot] = (uint32_t)nCha;
+	// Publish the buffer before the reader can see the new sequence number.
+	__atomic_fetch_add(&hea->seq[slot], 1, __ATOMIC_RELEASE);
+	if ( syscall(SYS_futex, &hea->seq[slot], FUTEX_WAKE, INT_MAX, NULL, NULL, 0) < 0 ){
+		perror("futex wake failed in shmpostFMU.");
+		return -1;
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////
+/// Waits for the next buffer of the peer.
+///
+/// See utilShm.h.
+const char* shmwaitFMU(ShmChannel *shm, int sockfd, int *nCha){
+	ShmHeader *hea = shmheaderFMU(shm);
+	const int slot = shm->isServer ? SHM_SLOT_CLIENT : SHM_SLOT_SERVER;
+	const struct timespec timeout = {1, 0};
+	uint32_t seq;
+	char c;
+
+	while ( (seq = __atomic_load_n(&hea->seq[slot], __ATOMIC_ACQUIRE)) == shm->seqRea ){
+		// Sleep until the sequence number changes. The call returns
+		// immediately if it already changed after it was loaded above.
+		if ( syscall(SYS_futex, &hea->seq[slot], FUTEX_WAIT, seq, &timeout, NULL, 0) < 0
+			&& errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT ){
+			perror("futex wait failed in shmwaitFMU.");
+			return NULL;
+		}
+		// Stop waiting if the peer closed the socket.
+		if ( sockfd >= 0 && recv(sockfd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 0 ){
+			fprintf(stderr, "Error: The peer closed the connection while waiting for shared memory data.\n");
+			return NULL;
+		}
+	}
+	shm->seqRea = seq;
+	*nCha = (int)hea->nCha[slot];
+	if ( *nCha < 0 || (uint32_t)*nCha > hea->slotLength ){
+		fprintf(stderr, "Error: Shared memory slot has invalid length %d.\n", *nCha);
+		return NULL;
+	}
+	return shmslotFMU(shm, slot);
+}
+
+////////////////////////////////////////////////////////////////
+/// Removes the name of the shared memory region.
+///
+/// See utilShm.h.
+void shmunlinkFMU(ShmChannel *shm){
+	if ( shm->isLinked ){
+		shm_unlink(shm->name);
+		shm->isLinked = 0;
+	}
+}
+
+////////////////////////////////////////////////////////////////
+/// Unmaps the shared memory region, and removes its name if needed.
+///
+/// See utilShm.h.
+void shmcloseFMU(ShmChannel *shm){
+	shmunlinkFMU(shm);
+	if ( shm->base != NULL )
+		munmap(shm->base, shm->size);
+	shm->base = NULL;
+	shm->size = 0;
+}
+
+#else /* Shared memory is not available. */
+
+int shmcreateFMU(ShmChannel *shm, int slotLength){
+	return -1;
+}
+
+int shmopenFMU(ShmChannel *shm, const char *name){
+	return -1;
+}
+
+int shmisattachedFMU(const ShmChannel *shm){
+	return 0;
+}
+
+char* shmgetwritebufferFMU(ShmChannel *shm, int nCha){
+	return NULL;
+}
+
+int shmpostFMU(ShmChannel *shm, int nCha){
+	return -1;
+}
+
+const char* shmwaitFMU(ShmChannel *shm, int sockfd, int *nCha){
+	return NULL;
+}
+
+void shmunlinkFMU(ShmChannel *shm){
+}
+
+void shmcloseFMU(ShmChannel *shm){
+	shm->base = NULL;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,137 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+///////////////////////////////////////////////////////
+/// \file   utilShm.h
+///
+/// \brief  Methods for exchanging data between the FMU
+///         and EnergyPlus through shared memory.
+///
+/// The FMU (server) creates a shared memory region and announces
+/// its name in \c socket.cfg. A client that can use it maps the
+/// region and sets \c clientAttached before it connects to the
+/// socket. After the connection has been accepted, the server
+/// checks \c clientAttached and exchanges data through the shared
+/// memory, or through the socket if the client did not attach.
+/// The socket stays open, so that a client that exits is detected.
+///
+/// The region has one slot for each direction. Each slot holds one
+/// buffer in the binary format of \c utilSocket.h. As the server and
+/// the client exchange data in lockstep, a slot is never written
+/// before the previous buffer in it was read. A writer publishes a
+/// buffer by incrementing the sequence number of its slot, which
+/// the reader waits on with a futex.
+///
+/// Shared memory is only available on Linux. On other systems,
+/// \c shmcreateFMU fails and data are exchanged through the socket.
+///
+///////////////////////////////////////////////////////
+#ifndef _UTILSHM_H_
+#define _UTILSHM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** \val The characters that start the shared memory region. */
+#define SHM_MAGIC "EPFMUSHM"
+
+/** \val The version of the layout of the shared memory region. */
+#define SHM_VERSION 1
+
+/** \val The number of bytes before the first slot. */
+#define SHM_HEADER_LENGTH 64
+
+/** \val The slot written by the client (EnergyPlus). */
+#define SHM_SLOT_CLIENT 0
+/** \val The slot written by the server (FMU). */
+#define SHM_SLOT_SERVER 1
+
+/// Header at the start of the shared memory region.
+typedef struct ShmHeader {
+	char magic[8];           ///< \c SHM_MAGIC, without the terminating character.
+	uint32_t version;        ///< \c SHM_VERSION.
+	uint32_t slotLength;     ///< Number of bytes of each slot.
+	uint32_t clientAttached; ///< Set to 1 by the client before it connects to the socket.
+	uint32_t seq[2];         ///< Sequence number of the buffer in each slot.
+	uint32_t nCha[2];        ///< Number of bytes of the buffer in each slot.
+} ShmHeader;
+
+/// Process-local state of a shared memory channel.
+typedef struct ShmChannel {
+	char *base;         ///< Start of the mapped region, or \c NULL if not used.
+	size_t size;        ///< Number of bytes of the mapped region.
+	char name[64];      ///< Name of the region.
+	int isServer;       ///< 1 for the FMU, 0 for EnergyPlus.
+	int isLinked;       ///< 1 if the name of the region has not yet been removed.
+	uint32_t seqRea;    ///< Sequence number of the last buffer read.
+} ShmChannel;
+
+////////////////////////////////////////////////////////////////
+/// Creates and maps a shared memory region as the server.
+///
+/// The name of the region is unique in the process and written
+/// to \c shm->name.
+///
+///\param shm The channel, which must be zero-initialized.
+///\param slotLength The number of bytes of the largest buffer.
+///\return 0 if no error occurred.
+int shmcreateFMU(ShmChannel *shm, int slotLength);
+
+////////////////////////////////////////////////////////////////
+/// Maps a shared memory region as the client and attaches to it.
+///
+///\param shm The channel, which must be zero-initialized.
+///\param name The name of the region, as announced by the server.
+///\return 0 if no error occurred.
+int shmopenFMU(ShmChannel *shm, const char *name);
+
+////////////////////////////////////////////////////////////////
+/// Returns whether the client attached to the shared memory region.
+///
+///\param shm The channel.
+///\return 1 if the client attached, 0 otherwise.
+int shmisattachedFMU(const ShmChannel *shm);
+
+////////////////////////////////////////////////////////////////
+/// Returns the slot into which a buffer can be assembled.
+///
+///\param shm The channel.
+///\param nCha The number of bytes of the buffer.
+///\return The slot, or \c NULL if the buffer does not fit into it.
+char* shmgetwritebufferFMU(ShmChannel *shm, int nCha);
+
+////////////////////////////////////////////////////////////////
+/// Publishes the buffer that was assembled in the slot.
+///
+///\param shm The channel.
+///\param nCha The number of bytes of the buffer.
+///\return 0 if no error occurred.
+int shmpostFMU(ShmChannel *shm, int nCha);
+
+////////////////////////////////////////////////////////////////
+/// Waits for the next buffer of the peer.
+///
+/// While waiting, the function checks once per second whether the
+/// peer closed the socket \c sockfd, in which case it fails.
+///
+///\param shm The channel.
+///\param sockfd The socket of the connection, or a negative value
+///              if it should not be checked.
+///\param nCha The number of bytes of the buffer.
+///\return The buffer, or \c NULL if an error occurred.
+const char* shmwaitFMU(ShmChannel *shm, int sockfd, int *nCha);
+
+////////////////////////////////////////////////////////////////
+/// Removes the name of the shared memory region.
+///
+/// The region stays mapped. The server calls this function once
+/// the client attached or the connection was accepted without it.
+///
+///\param shm The channel.
+void shmunlinkFMU(ShmChannel *shm);
+
+////////////////////////////////////////////////////////////////
+/// Unmaps the shared memory region, and removes its name if needed.
+///
+///\param shm The channel.
+void shmcloseFMU(ShmChannel *shm);
+
+#endif /* _UTILSHM_H_ */
@@ -21,18 +21,19 @@
 #include "utilSocket.h"
 
 #ifdef _MSC_VER // Microsoft compiler
+#ifndef MSG_WAITALL
+#define MSG_WAITALL 0x8 // do not complete until packet is completely filled
+#endif
 #else
 #include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/un.h>
 #endif
 
 
-static FILE *f1 = NULL; 
-static int REQUIRED_READ_LENGTH  = 0;
-static int REQUIRED_WRITE_LENGTH = 0;
-
-/// This will be overwritten to contain the
-/// version number of the server
-int SERVER_VERSION = 0;
+static FILE *f1 = NULL;
 
 // FIX: Increase HEADER_LENGTH for large number of Input/Output variables.
 // This was necessary to address issues reported by several users  when 
@@ -52,14 +53,15 @@ int SERVER_VERSION = 0;
 ///\param toAdd The character array that will be appended to \c buffer
 ///\param bufLen The length of the character array \c buffer. This parameter will
 ///              be set to the new size of \c buffer if memory was reallocated.
+///\param nBufCha The number of characters in \c buffer prior and after the call.
+///               Tracking it avoids calling \c strlen on the growing buffer.
 ///\return 0 if no error occurred.
-int save_appendFMU(char* *buffer, const char *toAdd, int *bufLen){
+int save_appendFMU(char* *buffer, const char *toAdd, int *bufLen, int *nBufCha){
 	const int size = 1024;
 	const int nNewCha = strlen(toAdd);
-	const int nBufCha = strlen(*buffer);
 	// reallocate memory if needed
-	if ( *bufLen < nNewCha + nBufCha + 1){
-		*bufLen = *bufLen + size * (((nNewCha + nBufCha) / size)+1);
+	if ( *bufLen < nNewCha + *nBufCha + 1){
+		*bufLen = *bufLen + size * (((nNewCha + *nBufCha) / size)+1);
 		*buffer = (char*)realloc(*buffer, *bufLen);
 		if (*buffer == NULL) {
 			perror("Realloc failed in save_appendFMU.");
@@ -70,7 +72,34 @@ int save_appendFMU(char* *buffer, const char *toAdd, int *bufLen){
 		}
 	}
 	// append toAdd to buffer
-	strcpy(*buffer + strlen(*buffer), toAdd);
+	memcpy(*buffer + *nBufCha, toAdd, nNewCha + 1);
+	*nBufCha += nNewCha;
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////
+/// Makes sure that a buffer of a connection has a minimum length.
+///
+/// The buffer is only reallocated if it is shorter than \c nCha,
+/// so that it can be reused for all messages of the same size.
+///
+///\param con The connection, whose allocation counter is incremented.
+///\param buffer The buffer.
+///\param bufLen The length of \c buffer prior and after the call.
+///\param nCha The required number of characters.
+///\return 0 if no error occurred.
+static int reservebufferFMU(SocketConnection *con, char* *buffer, int *bufLen, int nCha){
+	char *newBuf;
+	if ( *bufLen >= nCha )
+		return 0;
+	newBuf = (char*)realloc(*buffer, nCha);
+	if (newBuf == NULL) {
+		perror("Realloc failed in reservebufferFMU.");
+		return EXIT_FAILURE;
+	}
+	*buffer = newBuf;
+	*bufLen = nCha;
+	con->nAlloc++;
 	return 0;
 }
 
@@ -95,52 +124,54 @@ int assembleBufferFMU(int flag,
 {
 	int i;
 	int retVal;
+	int nBufCha = 0; // number of characters in buffer
 	char temCha[1024]; // temporary character array
-	memset((char*) *buffer, '\0', *bufLen);
+	// save_appendFMU terminates the string, hence the buffer
+	// does not need to be cleared.
 	// Set up how many values will be in buffer
 	// This is an internally used version number to make update
 	// of the format possible later without braking old versions
 	sprintf(temCha, "%d ", MAINVERSION);
-	retVal = save_appendFMU(buffer, temCha, bufLen);
+	retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 	if ( retVal != 0 ) return retVal;
 	sprintf(temCha, "%d ", flag);
-	retVal = save_appendFMU(buffer, temCha, bufLen);
+	retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 	if ( retVal != 0 ) return retVal;
 	if ( flag == 0 ){
 		// Only process data if the flag is zero.
 		sprintf(temCha, "%d ", nDbl);
-		retVal = save_appendFMU(buffer, temCha, bufLen);
+		retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 		if ( retVal != 0 ) return retVal;
 		sprintf(temCha, "%d ", nInt);
-		retVal = save_appendFMU(buffer, temCha, bufLen);
+		retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 		if ( retVal != 0 ) return retVal;
 		sprintf(temCha, "%d ", nBoo);
-		retVal = save_appendFMU(buffer, temCha, bufLen);
+		retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 		if ( retVal != 0 ) return retVal;
 		sprintf(temCha,"%20.15e ", curSimTim);
-		retVal = save_appendFMU(buffer, temCha, bufLen);
+		retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 		if ( retVal != 0 ) return retVal;
 		// add values to buffer
 		for(i = 0; i < nDbl; i++){
 			sprintf(temCha,"%20.15e ", dblVal[i]);
-			retVal = save_appendFMU(buffer, temCha, bufLen);
+			retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 			if ( retVal != 0 ) return retVal;
 		}
 		for(i = 0; i < nInt; i++){
 			sprintf(temCha,"%d ", intVal[i]);
-			retVal = save_appendFMU(buffer, temCha, bufLen);
+			retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 			if ( retVal != 0 ) return retVal;
 		}
 		for(i = 0; i < nBoo; i++){
 			sprintf(temCha,"%d ", booVal[i]);
-			retVal = save_appendFMU(buffer, temCha, bufLen);
+			retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 			if ( retVal != 0 ) return retVal;
 		}
 	}
 	// For the Java server to read the line, the line
 	// needs to be terminated with '\n'
 	sprintf(temCha,"\n");
-	retVal = save_appendFMU(buffer, temCha, bufLen);
+	retVal = save_appendFMU(buffer, temCha, bufLen, &nBufCha);
 	if ( retVal != 0 ) return retVal;
 	// No error, return 0
 	return 0;
@@ -217,6 +248,7 @@ int getDoubleCheckErrorFMU(const char *nptr, char **endptr,
 /// a long enough buffer for the read operation.
 ///
 ///\param buffer The buffer that contains the values to be parsed.
+///\param version The version number sent by the server.
 ///\param flag The communication flag.
 ///\param nDbl The number of double values received.
 ///\param nInt The number of integer values received.
@@ -224,7 +256,7 @@ int getDoubleCheckErrorFMU(const char *nptr, char **endptr,
 ///\return 0 if no error occurred.
 int disassembleHeaderBufferFMU(const char* buffer,
 	char **endptr, const int base,
-	int *fla,
+	int *version, int *fla,
 	int *nDbl, int *nInt, int *nBoo)
 {
 	int retVal;    // return value
@@ -235,7 +267,7 @@ int disassembleHeaderBufferFMU(const char* buffer,
 	*nInt = 0;
 	*nBoo = 0;
 	// version number
-	retVal = getIntCheckErrorFMU(buffer, endptr, base, &SERVER_VERSION);
+	retVal = getIntCheckErrorFMU(buffer, endptr, base, version);
 	if ( retVal )
 		return retVal;
 	//////////////////////////////////////////////////////
@@ -258,6 +290,7 @@ int disassembleHeaderBufferFMU(const char* buffer,
 /// Disassembles the buffer that has been received through the IPC.
 ///
 ///\param buffer The buffer that contains the values to be parsed.
+///\param version The version number sent by the server.
 ///\param flag The communication flag.
 ///\param nDbl The number of double values received.
 ///\param nInt The number of integer values received.
@@ -267,7 +300,7 @@ int disassembleHeaderBufferFMU(const char* buffer,
 ///\param booVal The array that stores the boolean values.
 ///\return 0 if no error occurred.
 int disassembleBufferFMU(const char* buffer,
-	int *fla,
+	int *version, int *fla,
 	int *nDbl, int *nInt, int *nBoo,
 	double *curSimTim,
 	double dblVal[], int intVal[], int booVal[])
@@ -277,7 +310,7 @@ int disassembleBufferFMU(const char* buffer,
 	const int base = 10;
 	char *endptr = 0;
 	retVal = disassembleHeaderBufferFMU(buffer, &endptr, base,
-		fla, nDbl, nInt, nBoo);
+		version, fla, nDbl, nInt, nBoo);
 	if ( retVal ) {
 #ifdef NDEBUG
 		fprintf(f1, "Error while disassembling the header of the buffer.\n");
@@ -330,11 +363,397 @@ int disassembleBufferFMU(const char* buffer,
 	return retVal;
 }
 
+////////////////////////////////////////////////////////////////
+/// Writes a 32 bit integer in little-endian byte order.
+///
+///\param buffer The buffer into which the value will be written.
+///\param val The value.
+static void putInt32LEFMU(char *buffer, int val){
+	const uint32_t u = (uint32_t)val;
+	buffer[0] = (char)( u        & 0xFF);
+	buffer[1] = (char)((u >>  8) & 0xFF);
+	buffer[2] = (char)((u >> 16) & 0xFF);
+	buffer[3] = (char)((u >> 24) & 0xFF);
+}
+
+////////////////////////////////////////////////////////////////
+/// Reads a 32 bit integer in little-endian byte order.
+///
+///\param buffer The buffer that contains the value.
+///\return The value.
+static int getInt32LEFMU(const char *buffer){
+	const unsigned char *b = (const unsigned char *)buffer;
+	return (int)((uint32_t)b[0] | ((uint32_t)b[1] << 8)
+		| ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24));
+}
+
+////////////////////////////////////////////////////////////////
+/// Writes an IEEE-754 double in little-endian byte order.
+///
+///\param buffer The buffer into which the value will be written.
+///\param val The value.
+static void putDoubleLEFMU(char *buffer, double val){
+	uint64_t u;
+	int i;
+	memcpy(&u, &val, sizeof(u));
+	for(i = 0; i < 8; i++){
+		buffer[i] = (char)((u >> (8*i)) & 0xFF);
+	}
+}
+
+////////////////////////////////////////////////////////////////
+/// Reads an IEEE-754 double in little-endian byte order.
+///
+///\param buffer The buffer that contains the value.
+///\return The value.
+static double getDoubleLEFMU(const char *buffer){
+	const unsigned char *b = (const unsigned char *)buffer;
+	uint64_t u = 0;
+	double val;
+	int i;
+	for(i = 0; i < 8; i++){
+		u |= ((uint64_t)b[i]) << (8*i);
+	}
+	memcpy(&val, &u, sizeof(val));
+	return val;
+}
+
+/////////////////////////////////////////////////////////////////
+/// Returns the length of a binary buffer.
+///
+///\param nDbl Number of double values.
+///\param nInt Number of integer values.
+///\param nBoo Number of boolean values.
+///\return The number of bytes of the binary buffer.
+int getbinarybufferlengthFMU(const int nDbl, const int nInt, const int nBoo){
+	return BINARY_HEADER_LENGTH + 8 * nDbl + 4 * (nInt + nBoo);
+}
+
+////////////////////////////////////////////////////////////////
+/// Assembles the binary buffer that will be exchanged through the IPC.
+///
+/// The buffer starts with \c BINARY_MAGIC, followed by the version,
+/// the flag, the number of doubles, integers and booleans as 32 bit
+/// integers, and the current simulation time. The values follow the
+/// header. All numbers are written in little-endian byte order.
+///
+///\param version The version number of the socket interface of the writer.
+///\param flag The communication flag.
+///\param nDbl The number of double values.
+///\param nInt The number of integer values.
+///\param nBoo The number of boolean values.
+///\param curSimTim The current simulation time.
+///\param dblVal The array that stores the double values.
+///\param intVal The array that stores the integer values.
+///\param booVal The array that stores the boolean values.
+///\param buffer The buffer into which the values will be written. It must
+///              have at least \c getbinarybufferlengthFMU(nDbl, nInt, nBoo) bytes.
+///\return The number of bytes written to \c buffer.
+int assembleBinaryBufferFMU(int version, int flag,
+	int nDbl, int nInt, int nBoo,
+	double curSimTim,
+	double dblVal[], int intVal[], int booVal[],
+	char *buffer)
+{
+	int i;
+	char *pos = buffer + BINARY_HEADER_LENGTH;
+	// Only send data if the flag is zero.
+	if ( flag != 0 ){
+		nDbl = 0;
+		nInt = 0;
+		nBoo = 0;
+	}
+	memcpy(buffer, BINARY_MAGIC, 4);
+	putInt32LEFMU(buffer +  4, version);
+	putInt32LEFMU(buffer +  8, flag);
+	putInt32LEFMU(buffer + 12, nDbl);
+	putInt32LEFMU(buffer + 16, nInt);
+	putInt32LEFMU(buffer + 20, nBoo);
+	putDoubleLEFMU(buffer + 24, curSimTim);
+	for(i = 0; i < nDbl; i++, pos += 8){
+		putDoubleLEFMU(pos, dblVal[i]);
+	}
+	for(i = 0; i < nInt; i++, pos += 4){
+		putInt32LEFMU(pos, intVal[i]);
+	}
+	for(i = 0; i < nBoo; i++, pos += 4){
+		putInt32LEFMU(pos, booVal[i]);
+	}
+	return (int)(pos - buffer);
+}
+
+/////////////////////////////////////////////////////////////////
+/// Disassembles the header of a binary buffer.
+///
+///\param buffer The buffer that contains at least \c BINARY_HEADER_LENGTH bytes.
+///\param version The version number sent by the server.
+///\param fla The communication flag.
+///\param nDbl The number of double values received.
+///\param nInt The number of integer values received.
+///\param nBoo The number of boolean values received.
+///\param curSimTim The current simulation time received.
+///\return 0 if no error occurred.
+int disassembleBinaryHeaderBufferFMU(const char* buffer,
+	int *version, int *fla, int *nDbl, int *nInt, int *nBoo, double *curSimTim)
+{
+	if ( memcmp(buffer, BINARY_MAGIC, 4) != 0 ){
+		fprintf(stderr, "Error: Binary buffer does not start with %s.\n", BINARY_MAGIC);
+		return EXIT_FAILURE;
+	}
+	*version = getInt32LEFMU(buffer + 4);
+	*fla  = getInt32LEFMU(buffer +  8);
+	*nDbl = getInt32LEFMU(buffer + 12);
+	*nInt = getInt32LEFMU(buffer + 16);
+	*nBoo = getInt32LEFMU(buffer + 20);
+	*curSimTim = getDoubleLEFMU(buffer + 24);
+	if ( *nDbl < 0 || *nInt < 0 || *nBoo < 0 ){
+		fprintf(stderr, "Error: Binary buffer has negative number of values.\n");
+		return EXIT_FAILURE;
+	}
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////////
+/// Disassembles the values of a binary buffer.
+///
+///\param buffer The buffer that contains the values that follow the header.
+///\param nDbl The number of double values.
+///\param nInt The number of integer values.
+///\param nBoo The number of boolean values.
+///\param dblVal The array that stores the double values.
+///\param intVal The array that stores the integer values.
+///\param booVal The array that stores the boolean values.
+void disassembleBinaryBufferFMU(const char* buffer,
+	int nDbl, int nInt, int nBoo,
+	double dblVal[], int intVal[], int booVal[])
+{
+	int i;
+	const char *pos = buffer;
+	for(i = 0; i < nDbl; i++, pos += 8){
+		dblVal[i] = getDoubleLEFMU(pos);
+	}
+	for(i = 0; i < nInt; i++, pos += 4){
+		intVal[i] = getInt32LEFMU(pos);
+	}
+	for(i = 0; i < nBoo; i++, pos += 4){
+		booVal[i] = getInt32LEFMU(pos);
+	}
+}
+
+/////////////////////////////////////////////////////////////////
+/// Checks the numbers of values announced by the header of a binary
+/// buffer against the numbers the reader expects.
+///
+/// The numbers must be the expected ones, which are the numbers of
+/// values the arrays of the reader hold, except that a buffer with a
+/// flag that is not zero may have no values. Integers and booleans
+/// are rejected if the reader has no array for them.
+///
+///\param fla The communication flag of the buffer.
+///\param nDbl The number of double values of the buffer.
+///\param nInt The number of integer values of the buffer.
+///\param nBoo The number of boolean values of the buffer.
+///\param nDblExp The expected number of double values.
+///\param nIntExp The expected number of integer values.
+///\param nBooExp The expected number of boolean values.
+///\param intVal The array for the integer values, or \c NULL.
+///\param booVal The array for the boolean values, or \c NULL.
+///\return The number of bytes of the buffer, including its header,
+///        or 0 if the numbers are not accepted.
+static size_t checkbinarycountsFMU(int fla, int nDbl, int nInt, int nBoo,
+	int nDblExp, int nIntExp, int nBooExp,
+	const int intVal[], const int booVal[])
+{
+	size_t len;
+	const int empty = ( fla != 0 && nDbl == 0 && nInt == 0 && nBoo == 0 );
+	if ( !empty && ( nDbl != nDblExp || nInt != nIntExp || nBoo != nBooExp ) ){
+		fprintf(stderr, "Error: Binary buffer has %d doubles, %d integers and %d booleans, "
+			"but %d, %d and %d are expected.\n", nDbl, nInt, nBoo, nDblExp, nIntExp, nBooExp);
+		return 0;
+	}
+	if ( ( nInt > 0 && intVal == NULL ) || ( nBoo > 0 && booVal == NULL ) ){
+		fprintf(stderr, "Error: Binary buffer has integers or booleans, which cannot be stored.\n");
+		return 0;
+	}
+	len = BINARY_HEADER_LENGTH + 8 * (size_t)nDbl + 4 * ((size_t)nInt + (size_t)nBoo);
+	if ( len > BINARY_MAX_LENGTH ){
+		fprintf(stderr, "Error: Binary buffer of %lu bytes is too long.\n", (unsigned long)len);
+		return 0;
+	}
+	return len;
+}
+
+/////////////////////////////////////////////////////////////////
+/// Reads exactly \c nCha bytes from the socket.
+///
+/// The bytes are requested with \c MSG_WAITALL, so that one call
+/// usually returns all of them. The loop only continues if the call
+/// was interrupted by a signal, in which case it is repeated, or
+/// returned a part of the bytes.
+///
+///\param sockfd The socket file descripter.
+///\param buffer The buffer into which the bytes will be written.
+///\param nCha The number of bytes to read.
+///\return \c nCha if no error occurred, or a negative value otherwise.
+static int readnfromsocketFMU(const int *sockfd, char *buffer, int nCha){
+	int retVal;
+	int nRea = 0;
+	while ( nRea < nCha ){
+		retVal = recv(*sockfd, buffer + nRea, nCha - nRea, MSG_WAITALL);
+		if ( retVal == 0 )
+			return -1; // The server closed the socket.
+#ifndef _MSC_VER
+		if ( retVal < 0 && errno == EINTR )
+			continue;
+#endif
+		if ( retVal < 0 )
+			return retVal;
+		nRea += retVal;
+	}
+	return nRea;
+}
+
+/////////////////////////////////////////////////////////////////
+/// Writes exactly \c nCha bytes to the socket.
+///
+/// The loop continues if a call was interrupted by a signal, or
+/// wrote only a part of the bytes.
+///
+///\param sockfd The socket file descripter.
+///\param buffer The buffer that contains the bytes.
+///\param nCha The number of bytes to write.
+///\return \c nCha if no error occurred, or a negative value otherwise.
+static int writentosocketFMU(const int *sockfd, const char *buffer, int nCha){
+	int retVal;
+	int nWri = 0;
+	while ( nWri < nCha ){
+#ifdef _MSC_VER
+		retVal = send(*sockfd, buffer + nWri, nCha - nWri, 0);
+#else
+		retVal = write(*sockfd, buffer + nWri, nCha - nWri);
+		if ( retVal < 0 && errno == EINTR )
+			continue;
+#endif
+		if ( retVal < 0 )
+			return retVal;
+		nWri += retVal;
+	}
+	return nWri;
+}
+
+/////////////////////////////////////////////////////////////////
+/// Reads a binary buffer from the socket.
+///
+/// This method is called by \c readfromsocketFMU if the server
+/// sent a binary buffer, after it read the first
+/// \c FRAME_PREFIX_LENGTH bytes, which are \c BINARY_MAGIC.
+/// The rest of the header and the values are read with one call each.
+///
+///\param con The connection.
+///\param flaRea Communication flag read from the socket stream.
+///\param nDblRea Number of double values to read.
+///\param nIntRea Number of integer values to read.
+///\param nBooRea Number of boolean values to read.
+///\param curSimTim Current simulation time in seconds read from socket.
+///\param dblValRea Double values read from socket.
+///\param intValRea Integer values read from socket.
+///\param boolValRea Boolean values read from socket.
+///\return 0 if no error occurred.
+static int readbinaryfromsocketFMU(SocketConnection *con, int *flaRea,
+	int *nDblRea, int *nIntRea, int *nBooRea,
+	double *curSimTim,
+	double dblValRea[], int intValRea[], int booValRea[])
+{
+	int retVal;
+	int nCha;
+	int nDbl, nInt, nBoo;
+	size_t len;
+	char header[BINARY_HEADER_LENGTH];
+
+	memcpy(header, BINARY_MAGIC, FRAME_PREFIX_LENGTH);
+	retVal = readnfromsocketFMU(&con->sockfd, header + FRAME_PREFIX_LENGTH,
+		BINARY_HEADER_LENGTH - FRAME_PREFIX_LENGTH);
+	if ( retVal < 0 )
+		return retVal;
+	retVal = disassembleBinaryHeaderBufferFMU(header, &con->serverVersion,
+		flaRea, &nDbl, &nInt, &nBoo, curSimTim);
+	if ( retVal != 0 )
+		return retVal;
+	len = checkbinarycountsFMU(*flaRea, nDbl, nInt, nBoo,
+		*nDblRea, *nIntRea, *nBooRea, intValRea, booValRea);
+	if ( len == 0 )
+		return -1;
+	*nDblRea = nDbl;
+	*nIntRea = nInt;
+	*nBooRea = nBoo;
+	nCha = (int)(len - BINARY_HEADER_LENGTH);
+	if ( nCha == 0 )
+		return 0;
+	if ( reservebufferFMU(con, &con->readBuffer, &con->readBufLen, nCha) != 0 )
+		return -1;
+	retVal = readnfromsocketFMU(&con->sockfd, con->readBuffer, nCha);
+	if ( retVal < 0 )
+		return retVal;
+	disassembleBinaryBufferFMU(con->readBuffer, nDbl, nInt, nBoo,
+		dblValRea, intValRea, booValRea);
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////////
+/// Reads a binary buffer from the shared memory of the connection.
+///
+/// This method is called by \c readfromsocketFMU if the client
+/// attached to the shared memory.
+///
+///\param con The connection.
+///\param flaRea Communication flag read from the shared memory.
+///\param nDblRea Number of double values to read.
+///\param nIntRea Number of integer values to read.
+///\param nBooRea Number of boolean values to read.
+///\param curSimTim Current simulation time in seconds read from the shared memory.
+///\param dblValRea Double values read from the shared memory.
+///\param intValRea Integer values read from the shared memory.
+///\param boolValRea Boolean values read from the shared memory.
+///\return 0 if no error occurred.
+static int readbinaryfromshmFMU(SocketConnection *con, int *flaRea,
+	int *nDblRea, int *nIntRea, int *nBooRea,
+	double *curSimTim,
+	double dblValRea[], int intValRea[], int booValRea[])
+{
+	int retVal;
+	int nCha;
+	int nDbl, nInt, nBoo;
+	size_t len;
+	const char *buffer;
+
+	buffer = shmwaitFMU(&con->shm, con->sockfd, &nCha);
+	if ( buffer == NULL || nCha < BINARY_HEADER_LENGTH )
+		return -1;
+	retVal = disassembleBinaryHeaderBufferFMU(buffer, &con->serverVersion,
+		flaRea, &nDbl, &nInt, &nBoo, curSimTim);
+	if ( retVal != 0 )
+		return retVal;
+	len = checkbinarycountsFMU(*flaRea, nDbl, nInt, nBoo,
+		*nDblRea, *nIntRea, *nBooRea, intValRea, booValRea);
+	if ( len == 0 )
+		return -1;
+	if ( len > (size_t)nCha ){
+		fprintf(stderr, "Error: Shared memory buffer is shorter than its header announces.\n");
+		return -1;
+	}
+	*nDblRea = nDbl;
+	*nIntRea = nInt;
+	*nBooRea = nBoo;
+	disassembleBinaryBufferFMU(buffer + BINARY_HEADER_LENGTH, nDbl, nInt, nBoo,
+		dblValRea, intValRea, booValRea);
+	return 0;
+}
+
 /////////////////////////////////////////////////////////////////
 /// Writes data to the socket.
 ///
 /// Clients can call this method to write data to the socket.
-///\param sockfd Socket file descripter
+///\param con The connection.
 ///\param flaWri Communication flag to write to the socket stream.
 ///\param nDblWri Number of double values to write.
 ///\param nIntWri Number of integer values to write.
@@ -345,24 +764,22 @@ int disassembleBufferFMU(const char* buffer,
 ///\param boolValWri Boolean values to write.
 ///\sa int establishclientsocket(uint16_t *portNo)
 ///\return The exit value of \c send, or a negative value if an error occured.
-int writetosocketFMU(const int *sockfd,
+int writetosocketFMU(SocketConnection *con,
 	const int *flaWri,
 	const int *nDblWri, const int *nIntWri, const int *nBooWri,
 	double *curSimTim,
 	double dblValWri[], int intValWri[], int booValWri[])
 {
 	int retVal;
-	// buffer used to exchange data
+	int bufLen;
 	char *buffer;
-	int bufLen = REQUIRED_WRITE_LENGTH;
 	// FMU Export - needs to modify bufLen as written below so that writetosocket can be used
 	// as a standalone function in the FMI functions.
-	if ( REQUIRED_WRITE_LENGTH < 1 ){
-		REQUIRED_WRITE_LENGTH = getrequiredbufferlengthFMU(*nDblWri, *nIntWri, *nBooWri);
-		if ( REQUIRED_WRITE_LENGTH <= 0 ){
+	if ( con->writeLength < 1 ){
+		con->writeLength = getrequiredbufferlengthFMU(*nDblWri, *nIntWri, *nBooWri);
+		if ( con->writeLength <= 0 ){
 			return -1;
 		}
-		bufLen = REQUIRED_WRITE_LENGTH;
 	}
 #ifdef NDEBUG
 	if (f1 == NULL) // open file
@@ -376,26 +793,55 @@ int writetosocketFMU(const int *sockfd,
 	/////////////////////////////////////////////////////
 	// make sure that the socketFD is valid
 	// 
-	if (*sockfd < 0 ){
+	if (con->sockfd < 0 ){
 		fprintf(stderr, "Error: Called write to socket with negative socket number.\n");
-		fprintf(stderr, "       sockfd : %d\n",  *sockfd);
+		fprintf(stderr, "       sockfd : %d\n",  con->sockfd);
 #ifdef NDEBUG
 		fprintf(f1, "Error: Called write to socket with negative socket number.\n");
-		fprintf(f1, "       sockfd : %d\n",  *sockfd);
+		fprintf(f1, "       sockfd : %d\n",  con->sockfd);
 		fflush(f1);
 #endif
 		return -1; // return a negative value in case of an error
 	}
 
 	/////////////////////////////////////////////////////
-	// allocate storage for buffer
+	// If the client attached to the shared memory, assemble the
+	// binary buffer directly in the shared memory.
+	if ( con->shm.base != NULL ){
+		bufLen = getbinarybufferlengthFMU(*nDblWri, *nIntWri, *nBooWri);
+		buffer = shmgetwritebufferFMU(&con->shm, bufLen);
+		if ( buffer == NULL )
+			return -1;
+		bufLen = assembleBinaryBufferFMU(con->localVersion, *flaWri, *nDblWri, *nIntWri, *nBooWri,
+			*curSimTim,
+			dblValWri, intValWri, booValWri,
+			buffer);
+		if ( shmpostFMU(&con->shm, bufLen) != 0 )
+			return -1;
+		return bufLen;
+	}
+
+	/////////////////////////////////////////////////////
+	// Use the binary format if the server announced that it
+	// can read it. Otherwise, fall back to the ASCII format.
+	if ( con->serverVersion >= BINARYVERSION ){
+		bufLen = getbinarybufferlengthFMU(*nDblWri, *nIntWri, *nBooWri);
+		if ( reservebufferFMU(con, &con->writeBuffer, &con->writeBufLen, bufLen) != 0 )
+			return -1;
+		bufLen = assembleBinaryBufferFMU(con->localVersion, *flaWri, *nDblWri, *nIntWri, *nBooWri,
+			*curSimTim,
+			dblValWri, intValWri, booValWri,
+			con->writeBuffer);
+		return writentosocketFMU(&con->sockfd, con->writeBuffer, bufLen);
+	}
+
+	/////////////////////////////////////////////////////
+	// make sure that the buffer of the connection is large enough
 #ifdef NDEBUG
-	fprintf(f1, "Assembling buffer.\n", *sockfd);
+	fprintf(f1, "Assembling buffer.\n", con->sockfd);
 #endif
 
-	buffer = (char *)malloc(bufLen);
-	if (buffer == NULL) {
-		perror("malloc failed in writetosocketFMU.");
+	if ( reservebufferFMU(con, &con->writeBuffer, &con->writeBufLen, con->writeLength) != 0 ) {
 #ifdef NDEBUG
 		fprintf(f1, "malloc failed in writetosocketFMU.\n");
 #endif
@@ -403,10 +849,13 @@ int writetosocketFMU(const int *sockfd,
 	}
 	//////////////////////////////////////////////////////
 	// copy arguments to buffer
+	bufLen = con->writeBufLen;
 	retVal = assembleBufferFMU(*flaWri, *nDblWri, *nIntWri, *nBooWri,
 		*curSimTim,
 		dblValWri, intValWri, booValWri,
-		&buffer, &bufLen);
+		&con->writeBuffer, &con->writeBufLen);
+	if ( con->writeBufLen != bufLen )
+		con->nAlloc++;
 
 	if (retVal != 0 ){
 		fprintf(stderr, "Error: Failed to allocate memory for buffer before writing to socket.\n");
@@ -418,20 +867,21 @@ int writetosocketFMU(const int *sockfd,
 		fprintf(f1, "       Message: %s\n",  strerror(errno));
 		fflush(f1);
 #endif
-		free(buffer);
+		// save_appendFMU sets the buffer to NULL if realloc failed.
+		con->writeBufLen = 0;
 		return -1; // return a negative value in case of an error
 	}
 	//////////////////////////////////////////////////////
 	// write to socket
 #ifdef NDEBUG
-	fprintf(f1, "Write to socket with fd = %d\n", *sockfd);
-	fprintf(f1, "Buffer        = %s\n", buffer);
+	fprintf(f1, "Write to socket with fd = %d\n", con->sockfd);
+	fprintf(f1, "Buffer        = %s\n", con->writeBuffer);
 #endif
 
 #ifdef _MSC_VER
-	retVal = send(*sockfd,buffer,strlen(buffer), 0);
+	retVal = send(con->sockfd,con->writeBuffer,strlen(con->writeBuffer), 0);
 #else
-	retVal = write(*sockfd,buffer,strlen(buffer));
+	retVal = write(con->sockfd,con->writeBuffer,strlen(con->writeBuffer));
 #endif
 
 #ifdef NDEBUG
@@ -450,20 +900,20 @@ int writetosocketFMU(const int *sockfd,
 		fflush(f1);
 #endif
 	}
-	free(buffer);
 	return retVal;
 
 }
 /////////////////////////////////////////////////////////////////
-/// Returns the required socket buffer length by reading from
-/// the socket how many data it contains.
-/// This method also set the global variable \c SERVER_VERSION
+/// Returns the required socket buffer length by parsing the header
+/// of the ASCII buffer that is being read into \c con->readBuffer.
+/// This method also sets the version number of the server
+/// in \c con.
 ///
-///\param sockfd Socket file descriptor
+///\param con The connection, whose read buffer contains the characters
+///           received so far, terminated by '\0'.
 ///\return nCha The nunber of characters needed to store the buffer
-int getRequiredReadBufferLengthFMU(const int *sockfd){
+int getRequiredReadBufferLengthFMU(SocketConnection *con){
 	int retVal;
-	char buffer[HEADER_LENGTH];
 	const int base = 10;
 	char *endptr = NULL;
 	int fla  = 0;
@@ -471,23 +921,11 @@ int getRequiredReadBufferLengthFMU(const int *sockfd){
 	int nInt = 0;
 	int nBoo = 0;
 
-	memset(buffer, '\0', HEADER_LENGTH);
-#ifdef _MSC_VER
-	// MSG_WAITALL is not in the winsock2.h file, at least not on my system...
-#define MSG_WAITALL 0x8 // do not complete until packet is completely filled
-	retVal = recv(*sockfd, buffer, HEADER_LENGTH, MSG_PEEK);
-#else
-	retVal = recv(*sockfd, buffer, HEADER_LENGTH, MSG_PEEK);
-#endif
-	if ( retVal < 1 ){
-		perror("Failed to peek at socket.");
-		return retVal;
-	}
-	retVal =  disassembleHeaderBufferFMU(buffer, &endptr, base,
-		&fla, &nDbl, &nInt, &nBoo);
-	if ( retVal < 0 ){
-		perror("Failed to disassemble header buffer.");
-		return retVal;
+	retVal =  disassembleHeaderBufferFMU(con->readBuffer, &endptr, base,
+		&con->serverVersion, &fla, &nDbl, &nInt, &nBoo);
+	if ( retVal != 0 ){
+		fprintf(stderr, "Error: Failed to disassemble header buffer.\n");
+		return -1;
 	}
 	return getrequiredbufferlengthFMU(nDbl, nInt, nBoo);
 }
@@ -516,11 +954,32 @@ int getrequiredbufferlengthFMU(const int nDbl, const int nInt, const int nBoo){
 }
 
 /////////////////////////////////////////////////////////////////
-/// Reads data from the socket.
+/// Reads the first \c FRAME_PREFIX_LENGTH bytes of a buffer from
+/// the socket into the read buffer of the connection.
 ///
-/// Clients can call this method to exchange data through the socket.
+/// The read buffer holds at least the header of an ASCII buffer,
+/// so that its length can be determined if it is longer than the
+/// read buffer.
+///
+///\param con The connection.
+///\return 0 if no error occurred.
+static int readprefixfromsocketFMU(SocketConnection *con){
+	if ( reservebufferFMU(con, &con->readBuffer, &con->readBufLen, HEADER_LENGTH) != 0 ) {
+#ifdef NDEBUG
+		fprintf(f1, "malloc failed in readprefixfromsocketFMU.\n");
+#endif
+		return -1;
+	}
+	if ( readnfromsocketFMU(&con->sockfd, con->readBuffer, FRAME_PREFIX_LENGTH) < 0 )
+		return -1;
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////////
+/// Reads the rest of a binary or ASCII buffer from the socket,
+/// after its prefix has been read by \c readprefixfromsocketFMU.
 ///
-///\param sockfd Socket file descripter
+///\param con The connection.
 ///\param flaRea Communication flag read from the socket stream.
 ///\param nDblRea Number of double values to read.
 ///\param nIntRea Number of integer values to read.
@@ -529,50 +988,23 @@ int getrequiredbufferlengthFMU(const int nDbl, const int nInt, const int nBoo){
 ///\param dblValRea Double values read from socket.
 ///\param intValRea Integer values read from socket.
 ///\param boolValRea Boolean values read from socket.
-///\sa int establishclientsocket(uint16_t *portNo)
-int readfromsocketFMU(const int *sockfd, int *flaRea,
+///\return 0 if no error occurred.
+static int readbodyfromsocketFMU(SocketConnection *con, int *flaRea,
 	int *nDblRea, int *nIntRea, int *nBooRea,
 	double *curSimTim,
 	double dblValRea[], int intValRea[], int booValRea[])
 {
 	int retVal;
-	char *inpBuf;
-	/////////////////////////////////////////////////////
-	// make sure that the socketFD is valid
-	if (*sockfd < 0 ){
-		fprintf(stderr, "Error: Called read from socket with negative socket number.\n");
-		fprintf(stderr, "       sockfd : %d\n",  *sockfd);
-#ifdef NDEBUG
-		fprintf(f1, "Error: Called read from socket with negative socket number.\n");
-		fprintf(f1, "       sockfd : %d\n",  *sockfd);
-		fflush(f1);
-#endif
-		return -1; // return a negative value in case of an error
+	int version, fla, nDbl, nInt, nBoo;
+	char *endptr = 0;
+	if ( memcmp(con->readBuffer, BINARY_MAGIC, FRAME_PREFIX_LENGTH) == 0 ){
+		return readbinaryfromsocketFMU(con, flaRea,
+			nDblRea, nIntRea, nBooRea,
+			curSimTim,
+			dblValRea, intValRea, booValRea);
 	}
 
-	// In the first call, set the socket buffer length
-	// This is done here since we know how many data we need to read.
-	if ( REQUIRED_READ_LENGTH < 1 ){
-		// Peak into the socket message to see how many data we need to read
-		// This is required to assign enough storage for the buffer.
-		// This call also sets the version number SERVER_VERSION
-		// that is sent by the server.
-		REQUIRED_READ_LENGTH = getRequiredReadBufferLengthFMU(sockfd);
-		if ( REQUIRED_READ_LENGTH <= 0 )
-			return -1;
-	}
-	// Increase the buffer that is used to store the data
-	inpBuf = (char*) malloc(REQUIRED_READ_LENGTH * sizeof(char));
-	if (inpBuf == NULL) {
-		perror("malloc failed in readfromsocketFMU.");
-#ifdef NDEBUG
-		fprintf(f1, "malloc failed in readfromsocketFMU.\n");
-#endif
-		free(inpBuf);
-		return -1;
-	}
-	memset(inpBuf, '\0', REQUIRED_READ_LENGTH);
-	retVal = readbufferfromsocketFMU(sockfd, inpBuf, &REQUIRED_READ_LENGTH);
+	retVal = readbufferfromsocketFMU(con, FRAME_PREFIX_LENGTH);
 	if (retVal < 0){
 #ifdef NDEBUG
 #ifdef _MSC_VER
@@ -582,51 +1014,141 @@ int readfromsocketFMU(const int *sockfd, int *flaRea,
 #endif
 		fflush(f1);
 #endif
-		free(inpBuf);
 		return retVal;
 	}
+	// Reject more values than the arrays hold before any is copied.
+	// A buffer with only the version and the flag has no complete header,
+	// and is left to disassembleBufferFMU, which sets the flag.
+	if ( disassembleHeaderBufferFMU(con->readBuffer, &endptr, 10,
+		&version, &fla, &nDbl, &nInt, &nBoo) == 0
+		&& ( nDbl > *nDblRea || nInt > *nIntRea || nBoo > *nBooRea
+		|| (nInt > 0 && intValRea == NULL) || (nBoo > 0 && booValRea == NULL) ) ){
+		fprintf(stderr, "Error: Buffer has %d doubles, %d integers and %d booleans, but only %d, %d and %d can be read.\n",
+			nDbl, nInt, nBoo, *nDblRea, *nIntRea, *nBooRea);
+		return -1;
+	}
 	//////////////////////////////////////////////////////
 	// disassemble buffer and store values in function argument
-	retVal = disassembleBufferFMU(inpBuf,
-		flaRea,
+	retVal = disassembleBufferFMU(con->readBuffer,
+		&con->serverVersion, flaRea,
 		nDblRea, nIntRea, nBooRea,
 		curSimTim,
 		dblValRea, intValRea, booValRea);
 #ifdef NDEBUG
 	fprintf(f1, "Disassembled buffer.\n");
 #endif
-    free(inpBuf);
-    return retVal;
+	// Keep the required length of the read buffer of the connection.
+	if ( retVal == 0 && *flaRea == 0 && con->readLength < 1 )
+		con->readLength = getrequiredbufferlengthFMU(*nDblRea, *nIntRea, *nBooRea);
+	return retVal;
 }
 
 /////////////////////////////////////////////////////////////////
-/// Reads a character buffer from the socket.
+/// Reads data from the socket.
 ///
-/// This method is called by \c readfromsocket.
+/// Clients can call this method to exchange data through the socket.
 ///
-///\param sockfd The socket file descripter.
-///\param buffer The buffer into which the values will be written.
-///\param bufLen The buffer length prior to the call.
-///\return The exit value of the \c read command.
-int readbufferfromsocketFMU(const int *sockfd, 
-	char *buffer, int *bufLen){
+///\param con The connection.
+///\param flaRea Communication flag read from the socket stream.
+///\param nDblRea Number of double values to read.
+///\param nIntRea Number of integer values to read.
+///\param nBooRea Number of boolean values to read.
+///\param curSimTim Current simulation time in seconds read from socket.
+///\param dblValRea Double values read from socket.
+///\param intValRea Integer values read from socket.
+///\param boolValRea Boolean values read from socket.
+///\sa int establishclientsocket(uint16_t *portNo)
+int readfromsocketFMU(SocketConnection *con, int *flaRea,
+	int *nDblRea, int *nIntRea, int *nBooRea,
+	double *curSimTim,
+	double dblValRea[], int intValRea[], int booValRea[])
+{
+	/////////////////////////////////////////////////////
+	// make sure that the socketFD is valid
+	if (con->sockfd < 0 ){
+		fprintf(stderr, "Error: Called read from socket with negative socket number.\n");
+		fprintf(stderr, "       sockfd : %d\n",  con->sockfd);
+#ifdef NDEBUG
+		fprintf(f1, "Error: Called read from socket with negative socket number.\n");
+		fprintf(f1, "       sockfd : %d\n",  con->sockfd);
+		fflush(f1);
+#endif
+		return -1; // return a negative value in case of an error
+	}
+
+	// Read from the shared memory if the client attached to it.
+	if ( con->shm.base != NULL ){
+		return readbinaryfromshmFMU(con, flaRea,
+			nDblRea, nIntRea, nBooRea,
+			curSimTim,
+			dblValRea, intValRea, booValRea);
+	}
+
+	// Read the first bytes of the buffer, which tell whether the
+	// server sent a binary or an ASCII buffer.
+	if ( readprefixfromsocketFMU(con) != 0 )
+		return -1;
+	return readbodyfromsocketFMU(con, flaRea,
+		nDblRea, nIntRea, nBooRea,
+		curSimTim,
+		dblValRea, intValRea, booValRea);
+}
+
+/////////////////////////////////////////////////////////////////
+/// Reads the remainder of an ASCII buffer from the socket.
+///
+/// This method is called by \c readfromsocketFMU after it read the
+/// first \c nRea characters into \c con->readBuffer.
+/// The server sends the next buffer only after it received the reply
+/// to this one. Hence, the buffer is complete when the last character
+/// received is '\n', and the received characters are not scanned
+/// for the end of the line. If the buffer is longer than the read
+/// buffer, the read buffer is enlarged to the length announced by
+/// the header.
+///
+///\param con The connection.
+///\param nRea The number of characters that have already been read.
+///\return The number of characters of the buffer, or a negative value
+///        if an error occurred.
+int readbufferfromsocketFMU(SocketConnection *con, int nRea){
 		int retVal;
-		int reachedEnd = 0;
-		// The number 8192 needs to be the same as in Server.java
-		int maxChaRea = 8192;
-		int chaSta = 0;
-		// Loop until we read the '\n' character
-		do {
+		int nCha;
+		int maxChaRea;
+		char *buffer = con->readBuffer;
+		while ( buffer[nRea-1] != '\n' ){
+			// Keep one character to terminate the string.
+			maxChaRea = con->readBufLen - nRea - 1;
+			if ( maxChaRea < 1 ){
+				// The header has been received, as it is shorter than
+				// the read buffer. Enlarge the buffer to the length it announces.
+				buffer[nRea] = '\0';
+				nCha = getRequiredReadBufferLengthFMU(con);
+				if ( nCha <= 0 )
+					return -1;
+				if ( nCha <= con->readBufLen ){
+					fprintf(stderr, "Error: The buffer is too short for the data sent by the server.\n");
+					return -1;
+				}
+				if (con->serverVersion == 1){
+					fprintf(stderr, "Error: This version of the socket interface cannot process such large data.\n");
+#ifdef NDEBUG
+					fprintf(f1, "Error: This version of the socket interface cannot process such large data.\n");
+#endif
+					return -1;
+				}
+				if ( reservebufferFMU(con, &con->readBuffer, &con->readBufLen, nCha) != 0 )
+					return -1;
+				buffer = con->readBuffer;
+				continue;
+			}
 #ifdef _MSC_VER
-			// MSG_WAITALL is not in the winsock2.h file, at least not on my system...
-#define MSG_WAITALL 0x8 /* do not complete until packet is completely filled */
-			retVal = recv(*sockfd, buffer, *bufLen, 0);
+			retVal = recv(con->sockfd, &buffer[nRea], maxChaRea, 0);
 #else
-			retVal = read(*sockfd, &buffer[chaSta], maxChaRea);
+			retVal = read(con->sockfd, &buffer[nRea], maxChaRea);
 #endif
 
 #ifdef NDEBUG
-			fprintf(f1, "In readbufferfromsocketFMU: Read %d chars, maximum is %d.\n", retVal, REQUIRED_READ_LENGTH);
+			fprintf(f1, "In readbufferfromsocketFMU: Read %d chars, maximum is %d.\n", retVal, maxChaRea);
 #endif
 			//FMU export - retVal stderr needed  to be deactivated to avoid the server to close too early
 			if ( retVal == 0 ){
@@ -638,29 +1160,18 @@ int readbufferfromsocketFMU(const int *sockfd,
 				//fprintf(stderr, "Error: Unspecified error when reading from socket.\n");
 				return retVal;
 			}
-			
-			// Check if we received '\n', in which case we finish the reading
-			if ( NULL == memchr(&buffer[chaSta], '\n', retVal) ){
-				chaSta += retVal;
-				if (SERVER_VERSION == 1){
-					fprintf(stderr, "Error: This version of the socket interface cannot process such large data.\n");
-#ifdef NDEBUG
-					fprintf(f1, "Error: This version of the socket interface cannot process such large data.\n");
-#endif
-					return -1;
-				}
-			}
-			else{
-				reachedEnd = 1; // found the end of the string
-			} 
-		} while(reachedEnd == 0);
-		return retVal;
+			nRea += retVal;
+		}
+		// The buffer is reused, hence terminate the string
+		// instead of clearing the buffer before each read.
+		buffer[nRea] = '\0';
+		return nRea;
 }
 /////////////////////////////////////////////////////////////////
 /// Exchanges data with the socket.
 ///
 /// Clients can call this method to exchange data through the socket.
-///\param sockfd Socket file descripter
+///\param con The connection.
 ///\param flaWri Communication flag to write to the socket stream.
 ///\param flaRea Communication flag read from the socket stream.
 ///\param nDblWri Number of double values to write.
@@ -679,7 +1190,7 @@ int readbufferfromsocketFMU(const int *sockfd,
 ///\param boolValRea Boolean values read from socket.
 ///\sa int establishclientsocket(uint16_t *portNo)
 ///\return The exit value of \c send or \c read, or a negative value if an error occured.
-int exchangewithsocketFMUex(const int *sockfd,
+int exchangewithsocketFMUex(SocketConnection *con,
 	const int *flaWri, int *flaRea,
 	const int *nDblWri, const int *nIntWri, const int *nBooWri,
 	int *nDblRea, int *nIntRea, int *nBooRea,
@@ -703,17 +1214,15 @@ int exchangewithsocketFMUex(const int *sockfd,
 
 		// In the first call, set the socket buffer length
 		// This is done here since we know how many data we need to send.
-		if ( REQUIRED_WRITE_LENGTH < 1 ){
-			REQUIRED_WRITE_LENGTH = getrequiredbufferlengthFMU(*nDblWri, *nIntWri, *nBooWri);
-			if ( REQUIRED_WRITE_LENGTH <= 0 )
+		if ( con->writeLength < 1 ){
+			con->writeLength = getrequiredbufferlengthFMU(*nDblWri, *nIntWri, *nBooWri);
+			if ( con->writeLength <= 0 )
 				return -1;
-			// Increase the buffer length for the socket
-			//   retVal = setrequiredbufferlength(*sockfd, REQUIRED_WRITE_LENGTH, SO_SNDBUF);
-			//   if ( retVal != 0 )
-			//     return retVal;
+			// The buffer lengths of the socket are set by
+			// setlowlatencysocketFMU when the connection is accepted.
 		}
 
-		retVal = writetosocketFMU(sockfd, flaWri,
+		retVal = writetosocketFMU(con, flaWri,
 			nDblWri, nIntWri, nBooWri,
 			simTimWri,
 			dblValWri, intValWri, booValWri);
@@ -722,7 +1231,7 @@ int exchangewithsocketFMUex(const int *sockfd,
 			fprintf(f1, "Reading from socket.\n");
 			fflush(f1);
 #endif
-			retVal = readfromsocketFMU(sockfd, flaRea,
+			retVal = readfromsocketFMU(con, flaRea,
 				nDblRea, nIntRea, nBooRea,
 				simTimRea,
 				dblValRea, intValRea, booValRea);
@@ -738,7 +1247,7 @@ int exchangewithsocketFMUex(const int *sockfd,
 /// Exchanges data with the socket.
 ///
 /// Clients can call this method to exchange data through the socket.
-///\param sockfd Socket file descripter
+///\param con The connection.
 ///\param flaWri Communication flag to write to the socket stream.
 ///\param flaRea Communication flag read from the socket stream.
 ///\param nDblWri Number of double values to write.
@@ -749,7 +1258,7 @@ int exchangewithsocketFMUex(const int *sockfd,
 ///\param dblValRea Double values read from socket.
 ///\sa int establishclientsocket(uint16_t *portNo)
 ///\return The exit value of \c send or \c read, or a negative value if an error occured.
-int exchangedoubleswithsocketFMUex(const int *sockfd,
+int exchangedoubleswithsocketFMUex(SocketConnection *con,
 	const int *flaWri, int *flaRea,
 	const int *nDblWri,
 	int *nDblRea,
@@ -762,7 +1271,7 @@ int exchangedoubleswithsocketFMUex(const int *sockfd,
 		int nBooRea = 0;
 		int intValRea[1]; // allocate array of non-zero size
 		int booValRea[1]; // allocate array of non-zero size
-		return exchangewithsocketFMUex(sockfd,
+		return exchangewithsocketFMUex(con,
 			flaWri, flaRea,
 			nDblWri, &zer, &zer,
 			nDblRea, &nIntRea, &nBooRea,
@@ -772,6 +1281,376 @@ int exchangedoubleswithsocketFMUex(const int *sockfd,
 			dblValRea, intValRea, booValRea);
 }
 
+/////////////////////////////////////////////////////////////////
+/// Writes a batch of buffers with double values to the socket.
+///
+/// The batch starts with \c BATCH_MAGIC, followed by the version, the
+/// number of steps and the number of bytes of the buffers that follow,
+/// as 32 bit integers in little-endian byte order. Then, each step is
+/// written as a binary buffer.
+///
+///\param con The connection.
+///\param nStep Number of steps.
+///\param flaWri Communication flag to write for each step.
+///\param nDblWri Number of double values to write for each step.
+///\param simTimWri Simulation time of each step.
+///\param dblValWri Double values to write, one row of \c nDblWri values for each step.
+///\return The number of bytes written, or a negative value if an error occurred.
+int writebatchtosocketFMU(SocketConnection *con, int nStep,
+	const int *flaWri, const int *nDblWri,
+	double simTimWri[], double dblValWri[])
+{
+	int k;
+	int nCha = 0;
+	const int stepLen = getbinarybufferlengthFMU(*nDblWri, 0, 0);
+
+	if ( nStep < 1 || con->sockfd < 0 )
+		return -1;
+	if ( reservebufferFMU(con, &con->writeBuffer, &con->writeBufLen,
+		BATCH_HEADER_LENGTH + nStep * stepLen) != 0 )
+		return -1;
+	for(k = 0; k < nStep; k++){
+		nCha += assembleBinaryBufferFMU(con->localVersion, *flaWri, *nDblWri, 0, 0,
+			simTimWri[k],
+			dblValWri + (size_t)k * (*nDblWri), NULL, NULL,
+			con->writeBuffer + BATCH_HEADER_LENGTH + nCha);
+	}
+	memcpy(con->writeBuffer, BATCH_MAGIC, 4);
+	putInt32LEFMU(con->writeBuffer +  4, con->localVersion);
+	putInt32LEFMU(con->writeBuffer +  8, nStep);
+	putInt32LEFMU(con->writeBuffer + 12, nCha);
+	return writentosocketFMU(&con->sockfd, con->writeBuffer, BATCH_HEADER_LENGTH + nCha);
+}
+
+/////////////////////////////////////////////////////////////////
+/// Reads a batch of buffers with double values from the socket.
+///
+/// If the peer sent a single buffer instead of a batch, it is read
+/// as a batch with one step. Reading stops at the first step whose
+/// flag is not zero.
+///
+///\param con The connection.
+///\param nStepMax Maximum number of steps that fit into the arrays.
+///\param nDblMax Maximum number of double values of a step. A step with
+///               more values is rejected before its values are copied.
+///\param nStepRea Number of steps read.
+///\param flaRea Communication flag of the last step read.
+///\param nDblRea Number of double values read for each step.
+///\param simTimRea Simulation time of each step read.
+///\param dblValRea Double values read, one row of \c nDblMax values for each step,
+///                 of which the first \c nDblRea are set.
+///\return 0 if no error occurred.
+int readbatchfromsocketFMU(SocketConnection *con, int nStepMax, int nDblMax, int *nStepRea,
+	int *flaRea, int *nDblRea,
+	double simTimRea[], double dblValRea[])
+{
+	int retVal;
+	int k;
+	int nStep, nCha, pos, nDbl, nInt, nBoo;
+	int stepLen = 0;
+	char header[BATCH_HEADER_LENGTH];
+
+	*nStepRea = 0;
+	if ( con->sockfd < 0 || readprefixfromsocketFMU(con) != 0 )
+		return -1;
+	if ( memcmp(con->readBuffer, BATCH_MAGIC, FRAME_PREFIX_LENGTH) != 0 ){
+		*nDblRea = nDblMax;
+		nInt = 0;
+		nBoo = 0;
+		retVal = readbodyfromsocketFMU(con, flaRea,
+			nDblRea, &nInt, &nBoo,
+			simTimRea,
+			dblValRea, NULL, NULL);
+		if ( retVal == 0 )
+			*nStepRea = 1;
+		return retVal;
+	}
+	retVal = readnfromsocketFMU(&con->sockfd, header + FRAME_PREFIX_LENGTH,
+		BATCH_HEADER_LENGTH - FRAME_PREFIX_LENGTH);
+	if ( retVal < 0 )
+		return retVal;
+	con->serverVersion = getInt32LEFMU(header +  4);
+	nStep              = getInt32LEFMU(header +  8);
+	nCha               = getInt32LEFMU(header + 12);
+	if ( nStep < 1 || nStep > nStepMax || nCha > BINARY_MAX_LENGTH
+		|| (size_t)nCha < (size_t)nStep * BINARY_HEADER_LENGTH ){
+		fprintf(stderr, "Error: Batch with %d steps and %d bytes cannot be read into %d steps.\n",
+			nStep, nCha, nStepMax);
+		return -1;
+	}
+	if ( reservebufferFMU(con, &con->readBuffer, &con->readBufLen, nCha) != 0 )
+		return -1;
+	retVal = readnfromsocketFMU(&con->sockfd, con->readBuffer, nCha);
+	if ( retVal < 0 )
+		return retVal;
+	// Disassemble the buffer of each step, which all have the length of the
+	// first one. Each header is checked to be inside the batch before it is read.
+	for(k = 0, pos = 0; k < nStep; k++){
+		if ( pos > nCha - BINARY_HEADER_LENGTH ){
+			fprintf(stderr, "Error: Step %d of batch is outside of its %d bytes.\n", k, nCha);
+			return -1;
+		}
+		retVal = disassembleBinaryHeaderBufferFMU(con->readBuffer + pos, &con->serverVersion,
+			flaRea, &nDbl, &nInt, &nBoo, &simTimRea[k]);
+		if ( retVal != 0 )
+			return retVal;
+		if ( k == 0 )
+			*nDblRea = nDbl;
+		if ( nDbl < 0 || nDbl > nDblMax || nDbl != *nDblRea || nInt != 0 || nBoo != 0 ){
+			fprintf(stderr, "Error: Step %d of batch has an invalid number of values.\n", k);
+			return -1;
+		}
+		if ( k == 0 ){
+			stepLen = getbinarybufferlengthFMU(nDbl, 0, 0);
+			if ( (size_t)nCha != (size_t)nStep * stepLen ){
+				fprintf(stderr, "Error: Batch of %d steps of %d bytes has %d bytes.\n",
+					nStep, stepLen, nCha);
+				return -1;
+			}
+		}
+		disassembleBinaryBufferFMU(con->readBuffer + pos + BINARY_HEADER_LENGTH, nDbl, 0, 0,
+			dblValRea + (size_t)k * nDblMax, NULL, NULL);
+		pos += stepLen;
+		*nStepRea = k + 1;
+		if ( *flaRea != 0 )
+			break;
+	}
+	return 0;
+}
+
+/////////////////////////////////////////////////////////////////
+/// Exchanges double values of several steps with the socket.
+///
+/// For each step, the values of \c dblValWri are written, and the
+/// values computed by the server for the end of the step are read
+/// into \c dblValRea. If the server sent a version of at least
+/// \c BATCHVERSION, all steps are written in one batch and read in
+/// one batch. Otherwise, one buffer is written and read for each step.
+///
+///\param con The connection.
+///\param nStep Number of steps.
+///\param flaWri Communication flag to write for each step.
+///\param nDblWri Number of double values to write for each step.
+///\param simTimWri Simulation time of each step to write.
+///\param dblValWri Double values to write, one row of \c nDblWri values for each step.
+///\param nDblMax Maximum number of double values of a step to read.
+///               A step with more values is rejected before its values are copied.
+///\param nStepRea Number of steps read, which is smaller than \c nStep
+///                if the server sent a flag that is not zero.
+///\param flaRea Communication flag of the last step read.
+///\param nDblRea Number of double values read for each step.
+///\param simTimRea Simulation time of each step read.
+///\param dblValRea Double values read, one row of \c nDblMax values for each step,
+///                 of which the first \c nDblRea are set.
+///\return 0 if no error occurred.
+int exchangebatchwithsocketFMU(SocketConnection *con, int nStep,
+	const int *flaWri, const int *nDblWri,
+	double simTimWri[], double dblValWri[],
+	int nDblMax, int *nStepRea, int *flaRea, int *nDblRea,
+	double simTimRea[], double dblValRea[])
+{
+	int retVal;
+	int k;
+	int nDbl = 0;
+	int nIntRea = 0, nBooRea = 0;
+	const int zer = 0;
+
+	*nStepRea = 0;
+	// Shared memory has a slot for one buffer, and exchanging it
+	// costs less than a round trip through the socket.
+	if ( con->serverVersion >= BATCHVERSION && con->shm.base == NULL ){
+		if ( writebatchtosocketFMU(con, nStep, flaWri, nDblWri, simTimWri, dblValWri) < 0 )
+			return -1;
+		return readbatchfromsocketFMU(con, nStep, nDblMax, nStepRea,
+			flaRea, nDblRea, simTimRea, dblValRea);
+	}
+	for(k = 0; k < nStep; k++){
+		if ( writetosocketFMU(con, flaWri, nDblWri, &zer, &zer,
+			&simTimWri[k], dblValWri + (size_t)k * (*nDblWri), NULL, NULL) < 0 )
+			return -1;
+		// Each row holds nDblMax values, and a step with more is rejected.
+		*nDblRea = nDblMax;
+		nIntRea = 0;
+		nBooRea = 0;
+		retVal = readfromsocketFMU(con, flaRea, nDblRea, &nIntRea, &nBooRea,
+			&simTimRea[k], dblValRea + (size_t)k * nDblMax, NULL, NULL);
+		if ( retVal != 0 )
+			return retVal;
+		// All steps have the number of values of the first one.
+		if ( k == 0 )
+			nDbl = *nDblRea;
+		if ( *nDblRea != nDbl ){
+			fprintf(stderr, "Error: Step %d has %d values, but the first step has %d.\n",
+				k, *nDblRea, nDbl);
+			return -1;
+		}
+		*nStepRea = k + 1;
+		if ( *flaRea != 0 )
+			break;
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////
+/// Initializes a connection.
+///
+/// The buffer lengths and the version number of the server
+/// are set when data are exchanged for the first time.
+///
+///\param con The connection.
+///\param sockfd Socket file descripter of the connection.
+void initconnectionFMU(SocketConnection *con, int sockfd){
+	memset(con, 0, sizeof(SocketConnection));
+	con->sockfd = sockfd;
+	con->localVersion = BINARYVERSION;
+}
+
+///////////////////////////////////////////////////////////
+/// Frees the buffers of a connection.
+///
+/// The socket is not closed by this function, but the
+/// shared memory is unmapped.
+///
+///\param con The connection.
+void freeconnectionFMU(SocketConnection *con){
+	shmcloseFMU(&con->shm);
+	free(con->readBuffer);
+	free(con->writeBuffer);
+	con->readBuffer  = NULL;
+	con->writeBuffer = NULL;
+	con->readBufLen  = 0;
+	con->writeBufLen = 0;
+}
+
+///////////////////////////////////////////////////////////
+/// Opens a Unix domain socket that listens for a connection.
+///
+/// An existing file with the same name is removed first.
+///
+///\param path The path of the socket file.
+///\return The socket file descripter, or -1 if an error occurred
+///        or if Unix domain sockets are not available.
+int openunixsocketFMU(const char *path){
+#ifdef _MSC_VER
+	return -1;
+#else
+	int sockfd;
+	struct sockaddr_un addr;
+	if ( strlen(path) >= sizeof(addr.sun_path) ){
+		fprintf(stderr, "Error: Unix domain socket path %s is too long.\n", path);
+		return -1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+	sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if ( sockfd < 0 ){
+		perror("Failed to open Unix domain socket.");
+		return -1;
+	}
+	unlink(path);
+	if ( bind(sockfd, (struct sockaddr *)&addr, sizeof(addr)) != 0
+		|| listen(sockfd, 1) != 0 ){
+		perror("Failed to bind or listen to Unix domain socket.");
+		close(sockfd);
+		unlink(path);
+		return -1;
+	}
+	return sockfd;
+#endif
+}
+
+///////////////////////////////////////////////////////////
+/// Accepts a connection on the first of two listening sockets
+/// that a client connects to.
+///
+/// If both sockets have a pending connection, the Unix domain
+/// socket is used.
+///
+///\param sockfd The listening TCP socket.
+///\param unixsockfd The listening Unix domain socket, or a negative
+///                  value if there is none.
+///\return The socket file descripter of the connection, or a negative
+///        value if an error occurred.
+int acceptfirstFMU(const int *sockfd, const int *unixsockfd){
+#ifdef _MSC_VER
+	return accept(*sockfd, NULL, NULL);
+#else
+	fd_set readfds;
+	int retVal;
+	if ( *unixsockfd < 0 )
+		return accept(*sockfd, NULL, NULL);
+	do {
+		FD_ZERO(&readfds);
+		FD_SET(*sockfd, &readfds);
+		FD_SET(*unixsockfd, &readfds);
+		retVal = select((*sockfd > *unixsockfd ? *sockfd : *unixsockfd) + 1,
+			&readfds, NULL, NULL, NULL);
+	} while ( retVal < 0 && errno == EINTR );
+	if ( retVal < 0 ){
+		perror("select failed in acceptfirstFMU.");
+		return -1;
+	}
+	if ( FD_ISSET(*unixsockfd, &readfds) )
+		return accept(*unixsockfd, NULL, NULL);
+	return accept(*sockfd, NULL, NULL);
+#endif
+}
+
+///////////////////////////////////////////////////////////
+/// Configures a connected socket for the exchange of one small
+/// message per time step in each direction.
+///
+/// For TCP sockets, this disables the Nagle algorithm, which
+/// otherwise can delay a message until the previous one was
+/// acknowledged. For all sockets, the send and receive buffers are
+/// enlarged to hold at least one message, so that a message is
+/// not split because the buffer is full.
+///
+///\param sockfd The socket file descripter.
+///\param bufLen The length of the longest message.
+///\return 0 if no error occurred.
+int setlowlatencysocketFMU(const int *sockfd, int bufLen){
+	int retVal = 0;
+	int one = 1;
+	int curLen;
+	int optNam[2];
+	int i;
+	int isTcp;
+#ifdef _MSC_VER
+	int optLen;
+	// Windows sockets of this interface are always TCP sockets.
+	isTcp = 1;
+#else
+	struct sockaddr_storage addr;
+	socklen_t addrLen = sizeof(addr);
+	socklen_t optLen;
+	isTcp = getsockname(*sockfd, (struct sockaddr *)&addr, &addrLen) == 0
+		&& (addr.ss_family == AF_INET || addr.ss_family == AF_INET6);
+#endif
+
+	optNam[0] = SO_SNDBUF;
+	optNam[1] = SO_RCVBUF;
+	if ( isTcp ){
+		if ( setsockopt(*sockfd, IPPROTO_TCP, TCP_NODELAY, (const char *)&one, sizeof(one)) != 0 ){
+			perror("Failed to set TCP_NODELAY.");
+			retVal = -1;
+		}
+	}
+	for(i = 0; i < 2; i++){
+		// Only enlarge the buffer, as the system default may be larger.
+		optLen = sizeof(curLen);
+		if ( getsockopt(*sockfd, SOL_SOCKET, optNam[i], (char *)&curLen, &optLen) == 0
+			&& curLen >= bufLen )
+			continue;
+		if ( setsockopt(*sockfd, SOL_SOCKET, optNam[i], (const char *)&bufLen, sizeof(bufLen)) != 0 ){
+			perror("Failed to set the socket buffer length.");
+			retVal = -1;
+		}
+	}
+	return retVal;
+}
+
 ///////////////////////////////////////////////////////////
 /// Closes the inter process communication socket.
 ///
@@ -44,11 +44,77 @@
 #include <limits.h>
 #include <math.h>
 #include <errno.h>
+#include <stdint.h>
+#include "utilShm.h"
 
 /** \val The main version of the socket interface.
 */
 #define MAINVERSION 2
 
+/** \val The first version of the socket interface that can read and
+ *       write binary buffers. A server that sends this version, or a
+ *       later one, is answered with binary buffers.
+ */
+#define BINARYVERSION 3
+
+/** \val The characters that start a binary buffer. The first character
+ *       cannot start an ASCII buffer, which starts with the version number.
+ */
+#define BINARY_MAGIC "#BIN"
+
+/** \val The number of bytes of the header of a binary buffer:
+ *       magic, version, flag, nDbl, nInt, nBoo and the simulation time.
+ */
+#define BINARY_HEADER_LENGTH 32
+
+/** \val The maximum number of bytes of a binary buffer that is read.
+ *       A header that announces more values is rejected before the
+ *       values are read.
+ */
+#define BINARY_MAX_LENGTH 0x40000000
+
+/** \val The number of bytes that are read first from each buffer.
+ *       A binary buffer starts with \c BINARY_MAGIC, which has this
+ *       length, and the shortest ASCII buffer, \c "2 1 \n", is longer.
+ */
+#define FRAME_PREFIX_LENGTH 4
+
+/** \val The first version of the socket interface that can read and
+ *       write batches of binary buffers, which hold the values of
+ *       several steps. A server that sends this version, or a later
+ *       one, is sent batches by \c exchangebatchwithsocketFMU.
+ */
+#define BATCHVERSION 4
+
+/** \val The characters that start a batch of binary buffers. */
+#define BATCH_MAGIC "#BAT"
+
+/** \val The number of bytes of the header of a batch: magic, version,
+ *       number of steps and number of bytes of the buffers that follow.
+ */
+#define BATCH_HEADER_LENGTH 16
+
+/// State of a connection with the server.
+///
+/// Each FMU instance owns one connection, so that instances with
+/// different numbers of inputs and outputs can run in the same process.
+/// The buffers are allocated when data are exchanged for the first
+/// time and reused for all later messages, so that exchanging data
+/// does not allocate memory once the buffers have their final size.
+typedef struct SocketConnection {
+	int sockfd;        ///< Socket file descripter of the connection.
+	int serverVersion; ///< Version number sent by the server, or 0 if not yet known.
+	int localVersion;  ///< Version number written into binary buffers.
+	int readLength;    ///< Required length of the ASCII read buffer, or 0 if not yet known.
+	int writeLength;   ///< Required length of the ASCII write buffer, or 0 if not yet known.
+	char *readBuffer;  ///< Buffer used to read from the socket.
+	int readBufLen;    ///< Length of \c readBuffer.
+	char *writeBuffer; ///< Buffer used to write to the socket.
+	int writeBufLen;   ///< Length of \c writeBuffer.
+	long nAlloc;       ///< Number of times a buffer was allocated or enlarged.
+	ShmChannel shm;    ///< Shared memory used instead of the socket, if \c shm.base is not \c NULL.
+} SocketConnection;
+
 ////////////////////////////////////////////////////////////////
 /// Assembles the buffer that will be exchanged through the IPC.
 ///
@@ -68,6 +134,70 @@ int assembleBufferFMU(int flag,
 		   double dblVal[], int intVal[], int booVal[],
 		   char* *buffer, int *bufLen);
 
+////////////////////////////////////////////////////////////////
+/// Assembles the binary buffer that will be exchanged through the IPC.
+///
+/// The buffer starts with \c BINARY_MAGIC, followed by the version,
+/// the flag, the number of doubles, integers and booleans as 32 bit
+/// integers, and the current simulation time. The values follow the
+/// header. All numbers are written in little-endian byte order.
+///
+///\param version The version number of the socket interface of the writer.
+///\param flag The communication flag.
+///\param nDbl The number of double values.
+///\param nInt The number of integer values.
+///\param nBoo The number of boolean values.
+///\param curSimTim The current simulation time.
+///\param dblVal The array that stores the double values.
+///\param intVal The array that stores the integer values.
+///\param booVal The array that stores the boolean values.
+///\param buffer The buffer into which the values will be written. It must
+///              have at least \c getbinarybufferlengthFMU(nDbl, nInt, nBoo) bytes.
+///\return The number of bytes written to \c buffer.
+int assembleBinaryBufferFMU(int version, int flag,
+		   int nDbl, int nInt, int nBoo,
+		   double curSimTim,
+		   double dblVal[], int intVal[], int booVal[],
+		   char *buffer);
+
+/////////////////////////////////////////////////////////////////
+/// Disassembles the header of a binary buffer.
+///
+///\param buffer The buffer that contains at least \c BINARY_HEADER_LENGTH bytes.
+///\param version The version number sent by the server.
+///\param fla The communication flag.
+///\param nDbl The number of double values received.
+///\param nInt The number of integer values received.
+///\param nBoo The number of boolean values received.
+///\param curSimTim The current simulation time received.
+///\return 0 if no error occurred.
+int disassembleBinaryHeaderBufferFMU(const char* buffer,
+			    int *version, int *fla, int *nDbl, int *nInt, int *nBoo,
+			    double *curSimTim);
+
+/////////////////////////////////////////////////////////////////
+/// Disassembles the values of a binary buffer.
+///
+///\param buffer The buffer that contains the values that follow the header.
+///\param nDbl The number of double values.
+///\param nInt The number of integer values.
+///\param nBoo The number of boolean values.
+///\param dblVal The array that stores the double values.
+///\param intVal The array that stores the integer values.
+///\param booVal The array that stores the boolean values.
+void disassembleBinaryBufferFMU(const char* buffer,
+		      int nDbl, int nInt, int nBoo,
+		      double dblVal[], int intVal[], int booVal[]);
+
+/////////////////////////////////////////////////////////////////
+/// Returns the length of a binary buffer.
+///
+///\param nDbl Number of double values.
+///\param nInt Number of integer values.
+///\param nBoo Number of boolean values.
+///\return The number of bytes of the binary buffer.
+int getbinarybufferlengthFMU(const int nDbl, const int nInt, const int nBoo);
+
 /////////////////////////////////////////////////////////////////
 /// Gets an integer and does the required error checking.
 ///
@@ -100,6 +230,7 @@ int getDoubleCheckErrorFMU(const char *nptr, char **endptr,
 /// a long enough buffer for the read operation.
 ///
 ///\param buffer The buffer that contains the values to be parsed.
+///\param version The version number sent by the server.
 ///\param flag The communication flag.
 ///\param nDbl The number of double values received.
 ///\param nInt The number of integer values received.
@@ -107,12 +238,13 @@ int getDoubleCheckErrorFMU(const char *nptr, char **endptr,
 ///\return 0 if no error occurred.
 int disassembleHeaderBufferFMU(const char* buffer,
 			    char **endptr, const int base,
-			    int *fla, int *nDbl, int *nInt, int *nBoo);
+			    int *version, int *fla, int *nDbl, int *nInt, int *nBoo);
 
 /////////////////////////////////////////////////////////////////
 /// Disassembles the buffer that has been received through the IPC.
 ///
 ///\param buffer The buffer that contains the values to be parsed.
+///\param version The version number sent by the server.
 ///\param flag The communication flag.
 ///\param nDbl The number of double values received.
 ///\param nInt The number of integer values received.
@@ -122,7 +254,7 @@ int disassembleHeaderBufferFMU(const char* buffer,
 ///\param booVal The array that stores the boolean values.
 ///\return 0 if no error occurred.
 int disassembleBufferFMU(const char* buffer,
-		      int *fla,
+		      int *version, int *fla,
 		      int *nDbl, int *nInt, int *nBoo,
 		      double *curSimTim,
 		      double dblVal[], int intVal[], int booVal[]);
@@ -149,7 +281,7 @@ int getsockethost(const char *const docname, char *const hostname);
 /// Writes data to the socket.
 ///
 /// Clients can call this method to write data to the socket.
-///\param sockfd Socket file descripter
+///\param con The connection.
 ///\param flaWri Communication flag to write to the socket stream.
 ///\param nDblWri Number of double values to write.
 ///\param nIntWri Number of integer values to write.
@@ -160,20 +292,22 @@ int getsockethost(const char *const docname, char *const hostname);
 ///\param boolValWri Boolean values to write.
 ///\sa int establishclientsocket(uint16_t *portNo)
 ///\return The exit value of \c send, or a negative value if an error occured.
-int writetosocketFMU(const int *sockfd, 
+int writetosocketFMU(SocketConnection *con,
 		  const int *flaWri,
 		  const int *nDblWri, const int *nIntWri, const int *nBooWri,
 		  double *curSimTim,
 		  double dblValWri[], int intValWri[], int booValWri[]);
 
 /////////////////////////////////////////////////////////////////
-/// Returns the required socket buffer length by reading from
-/// the socket how many data it contains.
-/// This method also set the global variable \c SERVER_VERSION
+/// Returns the required socket buffer length by parsing the header
+/// of the ASCII buffer that is being read into \c con->readBuffer.
+/// This method also sets the version number of the server
+/// in \c con.
 ///
-///\param sockfd Socket file descripter
+///\param con The connection, whose read buffer contains the characters
+///           received so far, terminated by '\0'.
 ///\return nCha The nunber of characters needed to store the buffer
-int getRequiredReadBufferLengthFMU(const int *sockfd);
+int getRequiredReadBufferLengthFMU(SocketConnection *con);
 
 /////////////////////////////////////////////////////////////////
 /// Returns the required socket buffer length.
@@ -188,38 +322,43 @@ int getrequiredbufferlengthFMU(const int nDbl, const int nInt, const int nBoo);
 //
 /// Clients can call this method to exchange data through the socket.
 ///
-///\param sockfd Socket file descripter
+///\param con The connection.
 ///\param flaRea Communication flag read from the socket stream.
-///\param nDblRea Number of double values to read.
-///\param nIntRea Number of integer values to read.
-///\param nBooRea Number of boolean values to read.
+///\param nDblRea Number of double values to read. On entry, the number
+///               of values \c dblValRea holds. A binary buffer with
+///               another number of values is rejected, unless its
+///               flag is not zero and it has no values.
+///\param nIntRea Number of integer values to read, as \c nDblRea.
+///\param nBooRea Number of boolean values to read, as \c nDblRea.
 ///\param curSimTim Current simulation time in seconds read from socket.
 ///\param dblValRea Double values read from socket.
-///\param intValRea Integer values read from socket.
-///\param boolValRea Boolean values read from socket.
+///\param intValRea Integer values read from socket, or \c NULL if none are expected.
+///\param boolValRea Boolean values read from socket, or \c NULL if none are expected.
 ///\sa int establishclientsocket(uint16_t *portNo)
-int readfromsocketFMU(const int *sockfd, int *flaRea, 
+int readfromsocketFMU(SocketConnection *con, int *flaRea,
 		   int *nDblRea, int *nIntRea, int *nBooRea,
 		   double *curSimTim,
 		   double dblValRea[], int intValRea[], int booValRea[]);
 
 /////////////////////////////////////////////////////////////////
-/// Reads a character buffer from the socket.
+/// Reads the remainder of an ASCII buffer from the socket.
 ///
-/// This method is called by \c readfromsocket.
+/// This method is called by \c readfromsocketFMU after it read the
+/// first \c nRea characters into \c con->readBuffer. It returns once
+/// the last character received is '\n', and enlarges the read buffer
+/// to the length announced by the header if the buffer is longer.
 ///
-///\param sockfd The socket file descripter.
-///\param buffer The buffer into which the values will be written.
-///\param bufLen The buffer length prior to the call.
-///\return The exit value of the \c read command.
-int readbufferfromsocketFMU(const int *sockfd,
-			 char *buffer, int *bufLen);
+///\param con The connection.
+///\param nRea The number of characters that have already been read.
+///\return The number of characters of the buffer, or a negative value
+///        if an error occurred.
+int readbufferfromsocketFMU(SocketConnection *con, int nRea);
 
 /////////////////////////////////////////////////////////////////
 /// Exchanges data with the socket.
 ///
 /// Clients can call this method to exchange data through the socket.
-///\param sockfd Socket file descripter
+///\param con The connection.
 ///\param flaWri Communication flag to write to the socket stream.
 ///\param flaRea Communication flag read from the socket stream.
 ///\param nDblWri Number of double values to write.
@@ -238,7 +377,7 @@ int readbufferfromsocketFMU(const int *sockfd,
 ///\param boolValRea Boolean values read from socket.
 ///\sa int establishclientsocket(uint16_t *portNo)
 ///\return The exit value of \c send or \c read, or a negative value if an error occured.
-int exchangewithsocketFMUex(const int *sockfd, 
+int exchangewithsocketFMUex(SocketConnection *con,
 		       const int *flaWri, int *flaRea,
 		       const int *nDblWri, const int *nIntWri, const int *nBooWri,
 		       int *nDblRea, int *nIntRea, int *nBooRea,
@@ -251,7 +390,7 @@ int exchangewithsocketFMUex(const int *sockfd,
 /// Exchanges data with the socket.
 ///
 /// Clients can call this method to exchange data through the socket.
-///\param sockfd Socket file descripter
+///\param con The connection.
 ///\param flaWri Communication flag to write to the socket stream.
 ///\param flaRea Communication flag read from the socket stream.
 ///\param nDblWri Number of double values to write.
@@ -262,7 +401,7 @@ int exchangewithsocketFMUex(const int *sockfd,
 ///\param dblValRea Double values read from socket.
 ///\sa int establishclientsocket(uint16_t *portNo)
 ///\return The exit value of \c send or \c read, or a negative value if an error occured.
-int exchangedoubleswithsocketFMUex(const int *sockfd, 
+int exchangedoubleswithsocketFMUex(SocketConnection *con,
 			      const int *flaWri, int *flaRea,
 			      const int *nDblWri,
 			      int *nDblRea,
@@ -271,6 +410,136 @@ int exchangedoubleswithsocketFMUex(const int *sockfd,
 			      double *simTimRea,
 			      double dblValRea[]);
 
+/////////////////////////////////////////////////////////////////
+/// Writes a batch of buffers with double values to the socket.
+///
+/// The batch starts with \c BATCH_MAGIC, followed by the version, the
+/// number of steps and the number of bytes of the buffers that follow,
+/// as 32 bit integers in little-endian byte order. Then, each step is
+/// written as a binary buffer.
+///
+///\param con The connection.
+///\param nStep Number of steps.
+///\param flaWri Communication flag to write for each step.
+///\param nDblWri Number of double values to write for each step.
+///\param simTimWri Simulation time of each step.
+///\param dblValWri Double values to write, one row of \c nDblWri values for each step.
+///\return The number of bytes written, or a negative value if an error occurred.
+int writebatchtosocketFMU(SocketConnection *con, int nStep,
+			  const int *flaWri, const int *nDblWri,
+			  double simTimWri[], double dblValWri[]);
+
+/////////////////////////////////////////////////////////////////
+/// Reads a batch of buffers with double values from the socket.
+///
+/// If the peer sent a single buffer instead of a batch, it is read
+/// as a batch with one step. Reading stops at the first step whose
+/// flag is not zero.
+///
+///\param con The connection.
+///\param nStepMax Maximum number of steps that fit into the arrays.
+///\param nDblMax Maximum number of double values of a step. A step with
+///               more values is rejected before its values are copied.
+///\param nStepRea Number of steps read.
+///\param flaRea Communication flag of the last step read.
+///\param nDblRea Number of double values read for each step.
+///\param simTimRea Simulation time of each step read.
+///\param dblValRea Double values read, one row of \c nDblMax values for each step,
+///                 of which the first \c nDblRea are set.
+///\return 0 if no error occurred.
+int readbatchfromsocketFMU(SocketConnection *con, int nStepMax, int nDblMax, int *nStepRea,
+			   int *flaRea, int *nDblRea,
+			   double simTimRea[], double dblValRea[]);
+
+/////////////////////////////////////////////////////////////////
+/// Exchanges double values of several steps with the socket.
+///
+/// For each step, the values of \c dblValWri are written, and the
+/// values computed by the server for the end of the step are read
+/// into \c dblValRea. If the server sent a version of at least
+/// \c BATCHVERSION, all steps are written in one batch and read in
+/// one batch. Otherwise, one buffer is written and read for each step.
+///
+///\param con The connection.
+///\param nStep Number of steps.
+///\param flaWri Communication flag to write for each step.
+///\param nDblWri Number of double values to write for each step.
+///\param simTimWri Simulation time of each step to write.
+///\param dblValWri Double values to write, one row of \c nDblWri values for each step.
+///\param nDblMax Maximum number of double values of a step to read.
+///               A step with more values is rejected before its values are copied.
+///\param nStepRea Number of steps read, which is smaller than \c nStep
+///                if the server sent a flag that is not zero.
+///\param flaRea Communication flag of the last step read.
+///\param nDblRea Number of double values read for each step.
+///\param simTimRea Simulation time of each step read.
+///\param dblValRea Double values read, one row of \c nDblMax values for each step,
+///                 of which the first \c nDblRea are set.
+///\return 0 if no error occurred.
+int exchangebatchwithsocketFMU(SocketConnection *con, int nStep,
+			       const int *flaWri, const int *nDblWri,
+			       double simTimWri[], double dblValWri[],
+			       int nDblMax, int *nStepRea, int *flaRea, int *nDblRea,
+			       double simTimRea[], double dblValRea[]);
+
+///////////////////////////////////////////////////////////
+/// Initializes a connection.
+///
+/// The buffer lengths and the version number of the server
+/// are set when data are exchanged for the first time.
+///
+///\param con The connection.
+///\param sockfd Socket file descripter of the connection.
+void initconnectionFMU(SocketConnection *con, int sockfd);
+
+///////////////////////////////////////////////////////////
+/// Frees the buffers of a connection.
+///
+/// The socket is not closed by this function, but the
+/// shared memory is unmapped.
+///
+///\param con The connection.
+void freeconnectionFMU(SocketConnection *con);
+
+///////////////////////////////////////////////////////////
+/// Opens a Unix domain socket that listens for a connection.
+///
+/// An existing file with the same name is removed first.
+///
+///\param path The path of the socket file.
+///\return The socket file descripter, or -1 if an error occurred
+///        or if Unix domain sockets are not available.
+int openunixsocketFMU(const char *path);
+
+///////////////////////////////////////////////////////////
+/// Accepts a connection on the first of two listening sockets
+/// that a client connects to.
+///
+/// If both sockets have a pending connection, the Unix domain
+/// socket is used.
+///
+///\param sockfd The listening TCP socket.
+///\param unixsockfd The listening Unix domain socket, or a negative
+///                  value if there is none.
+///\return The socket file descripter of the connection, or a negative
+///        value if an error occurred.
+int acceptfirstFMU(const int *sockfd, const int *unixsockfd);
+
+///////////////////////////////////////////////////////////
+/// Configures a connected socket for the exchange of one small
+/// message per time step in each direction.
+///
+/// For TCP sockets, this disables the Nagle algorithm, which
+/// otherwise can delay a message until the previous one was
+/// acknowledged. For all sockets, the send and receive buffers are
+/// enlarged to hold at least one message, so that a message is
+/// not split because the buffer is full.
+///
+///\param sockfd The socket file descripter.
+///\param bufLen The length of the longest message.
+///\return 0 if no error occurred.
+int setlowlatencysocketFMU(const int *sockfd, int bufLen);
+
 ///////////////////////////////////////////////////////////
 /// Closes the inter process communication socket.
 ///
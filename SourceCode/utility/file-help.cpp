@@ -10,6 +10,16 @@
 //
 #include "file-help.h"
 
+#include <cstdio>
+
+#ifdef _MSC_VER
+  #include <windows.h>
+#else
+  #include <errno.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
 
 //--- Identify file basename.
 //
@@ -59,3 +69,91 @@ bool openOutputFile(std::ofstream& fileStream, const char *const fileName, std::
   //
   return( 1 );
   }  // End fcn openOutputFile().
+
+
+#ifndef _MSC_VER
+//--- Copy the contents of one file to another.
+//
+//   Use copy_file_range() where available, which lets the kernel copy the
+// data without passing it through user space.  Fall back on plain reads and
+// writes.
+//
+static bool copyFileContents(const int srcFd, const int dstFd)
+  {
+#if defined(__linux__) && defined(__GLIBC__) && \
+  ( __GLIBC__ > 2 || ( __GLIBC__ == 2 && __GLIBC_MINOR__ >= 27 ) )
+  ssize_t copied;
+  while( 0 < (copied = copy_file_range(srcFd, NULL, dstFd, NULL, 1<<30, 0)) )
+    ;
+  if( 0 == copied )
+    return( 1 );
+  // Here, the call is not supported for these files.  Retry with read/write,
+  // only if nothing was copied yet.
+  if( 0 != lseek(dstFd, 0, SEEK_CUR) )
+    return( 0 );
+#endif
+  char buf[65536];
+  ssize_t nRead;
+  while( 0 < (nRead = read(srcFd, buf, sizeof(buf))) )
+    {
+    ssize_t nDone = 0;
+    while( nDone < nRead )
+      {
+      const ssize_t nWritten = write(dstFd, buf+nDone, nRead-nDone);
+      if( 0 > nWritten )
+        {
+        if( EINTR == errno )
+          continue;
+        return( 0 );
+        }
+      nDone += nWritten;
+      }
+    }
+  return( 0 == nRead );
+  }  // End fcn copyFileContents().
+#endif
+
+
+//--- Make a file available under a new name.
+//
+//   Note not under unit test.
+//
+bool linkOrCopyFile(const char *const srcFileName, const char *const dstFileName,
+  std::string& errStr)
+  {
+  //
+  // Replace any existing file, which may be a link to a previous source.
+  remove(dstFileName);
+  //
+#ifdef _MSC_VER
+  if( CreateHardLinkA(dstFileName, srcFileName, NULL) ||
+    CopyFileA(srcFileName, dstFileName, FALSE) )
+    return( 1 );
+#else
+  if( 0 == link(srcFileName, dstFileName) )
+    return( 1 );
+  // Here, could not link, for example across file systems.
+  const int srcFd = open(srcFileName, O_RDONLY);
+  if( 0 <= srcFd )
+    {
+    const int dstFd = open(dstFileName, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    bool copied = 0;
+    if( 0 <= dstFd )
+      {
+      copied = copyFileContents(srcFd, dstFd);
+      copied = ( 0 == close(dstFd) ) && copied;
+      if( ! copied )
+        remove(dstFileName);
+      }
+    close(srcFd);
+    if( copied )
+      return( 1 );
+    }
+#endif
+  //
+  if( 0 != errStr.size() )
+    errStr.push_back('\n');
+  errStr.append("Failed to link or copy file '").append(srcFileName)
+    .append("' to '").append(dstFileName).push_back('\'');
+  return( 0 );
+  }  // End fcn linkOrCopyFile().
@@ -46,6 +46,22 @@ bool openOutputFile(std::ofstream& fileStream, const char *const fileName, std::
   std::string& errStr);
 
 
+//--- Make a file available under a new name, without copying it if possible.
+//
+//   Create {dstFileName} as a hard link to {srcFileName}.  If that fails, for
+// example because the files are on different file systems, copy the contents,
+// in the kernel where the system supports it.  An existing {dstFileName} is
+// replaced.
+//   As a hard link shares the contents, the caller must not write to
+// {dstFileName}.
+//
+// \return TRUE on success.
+// \param errStr, contains error message in case fcn fails.
+//
+bool linkOrCopyFile(const char *const srcFileName, const char *const dstFileName,
+  std::string& errStr);
+
+
 #endif // __FILE_HELP_H__
 
 
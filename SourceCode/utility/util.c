@@ -21,12 +21,23 @@
 /// All rights reserved.
 ///////////////////////////////////////////////////////
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // for nftw()
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include "util.h"
 
+#ifdef _MSC_VER
+#include <direct.h>
+#else
+#include <ftw.h>
+#include <time.h>
+#endif
+
 int debug;  // Control for debug information
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -79,6 +90,133 @@ int deleteTmpDir(char* tmpPat){
 	return 0;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// Create a directory.
+///
+/// This calls the system directly rather than a shell,
+/// as forking a large process is slow.
+///
+///\param dirNam The path of the directory
+///\return 0 if no error occurred
+/////////////////////////////////////////////////////////////////////////
+int createDir(const char* dirNam){
+#ifdef _MSC_VER
+	return _mkdir(dirNam);
+#else
+	return mkdir(dirNam, 0777);
+#endif
+}
+
+#ifndef _MSC_VER
+//////////////////////////////////////////////////////////////////////////
+/// Remove one entry of a directory tree, for nftw().
+/////////////////////////////////////////////////////////////////////////
+static int removeDirEntry(const char* path, const struct stat* st,
+	int flag, struct FTW* ftw){
+	// Only the path is needed.
+	(void)st;
+	(void)flag;
+	(void)ftw;
+	return remove(path);
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+/// Remove a directory and all its content.
+///
+/// Symbolic links are removed, not followed.
+///
+///\param dirNam The path of the directory
+///\return 0 if no error occurred
+/////////////////////////////////////////////////////////////////////////
+int removeDir(const char* dirNam){
+#ifdef _MSC_VER
+	WIN32_FIND_DATAA findData;
+	HANDLE hFind;
+	char* path;
+	int retVal = 0;
+
+	path = (char *)calloc(sizeof(char), strlen(dirNam) + MAX_PATH + 3);
+	if (path == NULL){
+		printError("Fail to allocate memory for path.\n");
+		return -1;
+	}
+	sprintf(path, "%s\\*", dirNam);
+	hFind = FindFirstFileA(path, &findData);
+	if (hFind != INVALID_HANDLE_VALUE){
+		do {
+			if (strcmp(findData.cFileName, ".") == 0 || strcmp(findData.cFileName, "..") == 0)
+				continue;
+			sprintf(path, "%s\\%s", dirNam, findData.cFileName);
+			if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+				&& !(findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)){
+				if (removeDir(path) != 0)
+					retVal = -1;
+			}
+			else if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ? !RemoveDirectoryA(path) : !DeleteFileA(path)){
+				retVal = -1;
+			}
+		} while (FindNextFileA(hFind, &findData));
+		FindClose(hFind);
+	}
+	free(path);
+	if (!RemoveDirectoryA(dirNam))
+		retVal = -1;
+	return retVal;
+#else
+	// Visit the content before the directory, and do not follow links.
+	return nftw(dirNam, removeDirEntry, 16, FTW_DEPTH | FTW_PHYS);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// Get the time of a monotonic clock.
+///
+/// Use differences between two calls to measure elapsed time.
+///
+///\return The time in seconds.
+/////////////////////////////////////////////////////////////////////////////
+double getWallClockTime(void){
+#ifdef _MSC_VER
+	LARGE_INTEGER count;
+	LARGE_INTEGER freq;
+	QueryPerformanceCounter(&count);
+	QueryPerformanceFrequency(&freq);
+	return (double)count.QuadPart / (double)freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////
+/// Get the processor time used by the calling thread.
+///
+/// Use differences between two calls to measure the processor time
+/// used in between. The time used by child processes is not included.
+///
+///\return The time in seconds.
+/////////////////////////////////////////////////////////////////////////////
+double getCpuTime(void){
+#ifdef _MSC_VER
+	FILETIME creationTime;
+	FILETIME exitTime;
+	FILETIME kernelTime;
+	FILETIME userTime;
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return 0.0;
+	// FILETIME counts intervals of 100 nanoseconds
+	return 1e-7 * ((double)(((ULONGLONG)kernelTime.dwHighDateTime << 32) | kernelTime.dwLowDateTime)
+		+ (double)(((ULONGLONG)userTime.dwHighDateTime << 32) | userTime.dwLowDateTime));
+#else
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0.0;
+	return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////////
 /// Get temporary path
 ///
@@ -34,6 +34,14 @@ void doubleToCommaString(char* buffer, double r);
 
 int deleteTmpDir(char* tmpPat);
 
+int createDir(const char* dirNam);
+
+int removeDir(const char* dirNam);
+
+double getWallClockTime(void);
+
+double getCpuTime(void);
+
 char *getTmpPath(const char *nam, int length);
 
 void printDebug(const char* msg);
@@ -70,7 +70,9 @@ int fmuLocCoun=0;
 void findFileDelete()
 {
 	struct stat stat_p;
-	int res;
+	DIR *dirp;
+	struct dirent *dp;
+	size_t len;
 
 	if (stat(VARCFG, &stat_p) >= 0)
 	{
@@ -90,11 +92,16 @@ void findFileDelete()
 	}
 	if (stat(FRUNWEAFILE, &stat_p) >= 0){
 		// cleanup .epw files
-#ifdef _MSC_VER
-		res = system("del *.epw");
-#else
-		res = system("rm -f *.epw");
-#endif
+		dirp = opendir(".");
+		if (dirp != NULL){
+			while ((dp = readdir(dirp)) != NULL){
+				len = strlen(dp->d_name);
+				if (len > 4 && strcmp(dp->d_name + len - 4, ".epw") == 0){
+					remove(dp->d_name);
+				}
+			}
+			closedir(dirp);
+		}
 	}
 }
 
@@ -279,28 +286,41 @@ int write_socket_cfg(ModelInstance *_c, int portNum, const char* hostName)
 ////////////////////////////////////////////////////////////////////////////////////
 /// copy variables.cfg file into the results folder
 ///
+/// The file is small, hence it is copied with the standard library.
+///
 ///\param _c The FMU instance.
 ///\return 0 if no error occurred.
 ////////////////////////////////////////////////////////////////////////////////////
 int copy_var_cfg(ModelInstance *_c)
 {
 	char *tmp_str;
-	int retVal;
-	tmp_str=(char*)(_c->functions.allocateMemory(strlen(_c->tmpResCon) + strlen (_c->fmuOutput) + 30, sizeof(char)));
-
-#ifdef _MSC_VER
-	//"\"" are quotes needed for path with spaces in the names
-	sprintf(tmp_str, "xcopy %s%s %s%s%s /Y /I", "\"", _c->tmpResCon, "\"", _c->fmuOutput, "\"");
-#elif __linux__
-	sprintf(tmp_str, "cp -f %s%s %s%s%s", "\"", _c->tmpResCon,  "\"", _c->fmuOutput, "\"");
-#elif __APPLE__
-	sprintf(tmp_str, "cp -f %s%s %s%s%s", "\"", _c->tmpResCon,  "\"", _c->fmuOutput, "\"");
-#else
-	printf ("Cannot execute %s. The FMU export is only supported on Windows, Linux and Mac OS.\n", tmp_str);
-#endif
-	_c->functions.logger(NULL, _c->instanceName, fmiOK, "ok",  
-		"Command executes to copy content of resources folder: %s\n", tmp_str);
-	retVal=system (tmp_str);
+	char buf[4096];
+	size_t nRead;
+	FILE *src;
+	FILE *dst=NULL;
+	int retVal=-1;
+	tmp_str=(char*)(_c->functions.allocateMemory(strlen (_c->fmuOutput) + strlen (VARCFG) + 1, sizeof(char)));
+	sprintf(tmp_str, "%s%s", _c->fmuOutput, VARCFG);
+	_c->functions.logger(NULL, _c->instanceName, fmiOK, "ok",
+		"Copy %s to %s\n", _c->tmpResCon, tmp_str);
+	src=fopen(_c->tmpResCon, "rb");
+	if (src!=NULL) {
+		dst=fopen(tmp_str, "wb");
+	}
+	if (dst!=NULL) {
+		retVal=0;
+		while ((nRead=fread(buf, 1, sizeof(buf), src)) > 0) {
+			if (fwrite(buf, 1, nRead, dst)!=nRead) {
+				retVal=-1;
+			}
+		}
+		if (ferror(src) || fclose(dst)!=0) {
+			retVal=-1;
+		}
+	}
+	if (src!=NULL) {
+		fclose(src);
+	}
 	_c->functions.freeMemory(tmp_str);
 	return retVal;
 }
@@ -313,15 +333,7 @@ int copy_var_cfg(ModelInstance *_c)
 ////////////////////////////////////////////////////////////////////////////////////
 int create_res(ModelInstance *_c)
 {
-	char *tmp_str;
-	int retVal;
-	// The 30 are for the additional characters in tmp_str
-	tmp_str=(char*)(_c->functions.allocateMemory(strlen(_c->fmuOutput) + 30, sizeof(char)));
-
-	sprintf(tmp_str, "mkdir %s%s%s", "\"", _c->fmuOutput, "\"");
-	retVal=system (tmp_str);
-	_c->functions.freeMemory (tmp_str);
-	return retVal;
+	return createDir (_c->fmuOutput);
 }
 
 
@@ -333,23 +345,9 @@ int create_res(ModelInstance *_c)
 ////////////////////////////////////////////////////////////////////////////////////
 int removeFMUDir (ModelInstance* _c)
 {
-	int retVal;
-	char *tmp_str;
-	// The 30 are for the additional characters in tmp_str
-	tmp_str=(char*)(_c->functions.allocateMemory(strlen(_c->fmuOutput) + 30, sizeof(char)));
 	_c->functions.logger(NULL, _c->instanceName, fmiOK, "ok", 
 		"This is the output folder %s\n", _c->fmuOutput);
-
-#ifdef _MSC_VER
-	sprintf(tmp_str, "rmdir /S /Q %s%s%s", "\"", _c->fmuOutput, "\"");
-#else
-	sprintf(tmp_str, "rm -rf %s%s%s", "\"", _c->fmuOutput, "\"");
-#endif
-	_c->functions.logger(NULL, _c->instanceName, fmiOK, "ok",  
-		"This is the command to be executed to delete existing directory %s\n", tmp_str);
-	retVal=system (tmp_str);
-	_c->functions.freeMemory (tmp_str);
-	return retVal;
+	return removeDir (_c->fmuOutput);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -698,6 +696,8 @@ DllExport fmiComponent fmiInstantiateSlave(fmiString instanceName,
 	struct stat st;
 	fmiBoolean errDir;
 	ModelInstance* _c;
+	// time the instantiation, which creates the output folder and parses the model description
+	const double tStart = getWallClockTime();
 
 	// Perform checks.
 	if (!functions.logger)
@@ -795,10 +795,9 @@ DllExport fmiComponent fmiInstantiateSlave(fmiString instanceName,
 	replace_char (_c->fmuUnzipLocation, '//', '\\');
 #endif
 
-	// create content of resources folder in created output directory
-	// "\"" is to make sure that we have quotation at the end of the path for variables.cfg.
-	_c->tmpResCon=(char *)_c->functions.allocateMemory(strlen (_c->fmuResourceLocation) + strlen (VARCFG) + strlen ("\"") + 1, sizeof(char));
-	sprintf(_c->tmpResCon, "%s%s%s", _c->fmuResourceLocation, "\"", VARCFG);
+	// path to the variables.cfg of the resources folder, to be copied to the output directory
+	_c->tmpResCon=(char *)_c->functions.allocateMemory(strlen (_c->fmuResourceLocation) + strlen (VARCFG) + 1, sizeof(char));
+	sprintf(_c->tmpResCon, "%s%s", _c->fmuResourceLocation, VARCFG);
 
 	// create the output directory
 	retVal=create_res(_c);
@@ -903,7 +902,8 @@ DllExport fmiComponent fmiInstantiateSlave(fmiString instanceName,
 	// This is required to prevent Dymola to call fmiSetReal before the initialization
 	_c->firstCallIni=1;
 	_c->functions.logger(NULL, _c->instanceName, fmiOK, "ok", 
-		"fmiInstantiateSlave: Instantiation of %s succeded.\n", _c->instanceName);
+		"fmiInstantiateSlave: Instantiation of %s succeded in %.3f ms.\n", _c->instanceName,
+		1e3*(getWallClockTime() - tStart));
 	return(_c); 
 }
 
@@ -0,0 +1,176 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+/////////////////////////////////////////////////////////////////////
+// \file   asyncWorker.c
+//
+// \brief  A thread that runs one job at a time for an FMU instance.
+//
+/////////////////////////////////////////////////////////////////////
+#include "asyncWorker.h"
+
+#ifdef _MSC_VER
+#define LOCK(w)      EnterCriticalSection(&(w)->mutex)
+#define UNLOCK(w)    LeaveCriticalSection(&(w)->mutex)
+#define WAIT(w)      SleepConditionVariableCS(&(w)->cond, &(w)->mutex, INFINITE)
+#define BROADCAST(w) WakeAllConditionVariable(&(w)->cond)
+#else
+#define LOCK(w)      pthread_mutex_lock(&(w)->mutex)
+#define UNLOCK(w)    pthread_mutex_unlock(&(w)->mutex)
+#define WAIT(w)      pthread_cond_wait(&(w)->cond, &(w)->mutex)
+#define BROADCAST(w) pthread_cond_broadcast(&(w)->cond)
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+/// Runs posted jobs until the worker is stopped.
+///
+///\param arg The worker.
+///////////////////////////////////////////////////////////////////////////////
+#ifdef _MSC_VER
+static DWORD WINAPI asyncWorker_run(LPVOID arg)
+#else
+static void* asyncWorker_run(void *arg)
+#endif
+{
+	AsyncWorker *w = (AsyncWorker*)arg;
+	LOCK(w);
+	for (;;) {
+		while (!w->isBusy && !w->quit)
+			WAIT(w);
+		if (!w->isBusy)
+			break;
+		UNLOCK(w);
+		w->job(w->arg);
+		LOCK(w);
+		w->isBusy = 0;
+		BROADCAST(w);
+		// Signal the end of the job once a call of asyncWorker_isBusy
+		// from within finished would return 0.
+		if (w->finished != NULL) {
+			UNLOCK(w);
+			w->finished(w->arg);
+			LOCK(w);
+		}
+	}
+	UNLOCK(w);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Starts the worker thread.
+///
+///\param w The worker. Must be zero-initialized or stopped.
+///\param job The function that is run for each posted job.
+///\param finished The function that is run after each job, or \c NULL.
+///\param arg The argument of \c job and \c finished.
+///\return 0 if no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+int asyncWorker_start(AsyncWorker *w, AsyncWorkerJob job, AsyncWorkerJob finished, void *arg)
+{
+	w->isBusy = 0;
+	w->quit = 0;
+	w->job = job;
+	w->finished = finished;
+	w->arg = arg;
+#ifdef _MSC_VER
+	InitializeCriticalSection(&w->mutex);
+	InitializeConditionVariable(&w->cond);
+	w->thread = CreateThread(NULL, 0, asyncWorker_run, w, 0, NULL);
+	if (w->thread == NULL) {
+		DeleteCriticalSection(&w->mutex);
+		return 1;
+	}
+#else
+	if (pthread_mutex_init(&w->mutex, NULL) != 0)
+		return 1;
+	if (pthread_cond_init(&w->cond, NULL) != 0) {
+		pthread_mutex_destroy(&w->mutex);
+		return 1;
+	}
+	if (pthread_create(&w->thread, NULL, asyncWorker_run, w) != 0) {
+		pthread_cond_destroy(&w->cond);
+		pthread_mutex_destroy(&w->mutex);
+		return 1;
+	}
+#endif
+	w->isRunning = 1;
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Runs the job once in the worker thread, and returns without waiting.
+///
+///\param w The worker.
+///\return 0 if no error occurred, 1 if the worker is not running or busy.
+///////////////////////////////////////////////////////////////////////////////
+int asyncWorker_post(AsyncWorker *w)
+{
+	int retVal = 1;
+	if (!w->isRunning)
+		return 1;
+	LOCK(w);
+	if (!w->isBusy) {
+		w->isBusy = 1;
+		BROADCAST(w);
+		retVal = 0;
+	}
+	UNLOCK(w);
+	return retVal;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Returns whether a posted job has not yet returned.
+///
+///\param w The worker.
+///\return 1 if the job is running, 0 otherwise.
+///////////////////////////////////////////////////////////////////////////////
+int asyncWorker_isBusy(AsyncWorker *w)
+{
+	int isBusy;
+	if (!w->isRunning)
+		return 0;
+	LOCK(w);
+	isBusy = w->isBusy;
+	UNLOCK(w);
+	return isBusy;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Waits until a posted job has returned.
+///
+///\param w The worker.
+///////////////////////////////////////////////////////////////////////////////
+void asyncWorker_wait(AsyncWorker *w)
+{
+	if (!w->isRunning)
+		return;
+	LOCK(w);
+	while (w->isBusy)
+		WAIT(w);
+	UNLOCK(w);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Waits for a posted job, and stops the worker thread.
+///
+///\param w The worker.
+///////////////////////////////////////////////////////////////////////////////
+void asyncWorker_stop(AsyncWorker *w)
+{
+	if (!w->isRunning)
+		return;
+	LOCK(w);
+	while (w->isBusy)
+		WAIT(w);
+	w->quit = 1;
+	BROADCAST(w);
+	UNLOCK(w);
+#ifdef _MSC_VER
+	WaitForSingleObject(w->thread, INFINITE);
+	CloseHandle(w->thread);
+	DeleteCriticalSection(&w->mutex);
+#else
+	pthread_join(w->thread, NULL);
+	pthread_cond_destroy(&w->cond);
+	pthread_mutex_destroy(&w->mutex);
+#endif
+	w->isRunning = 0;
+}
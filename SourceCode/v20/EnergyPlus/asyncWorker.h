@@ -0,0 +1,90 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+/////////////////////////////////////////////////////////////////////
+// \file   asyncWorker.h
+//
+// \brief  A thread that runs one job at a time for an FMU instance.
+//
+// The FMU uses the worker to exchange data with EnergyPlus while
+// fmi2DoStep has returned fmi2Pending to the master. The job is
+// posted by the thread of the master, and runs in the worker thread
+// while the master does other work, such as stepping other FMUs.
+//
+/////////////////////////////////////////////////////////////////////
+#ifndef _ASYNCWORKER_H_
+#define _ASYNCWORKER_H_
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+/// Function that is run by the worker.
+typedef void (*AsyncWorkerJob)(void *arg);
+
+typedef struct AsyncWorker {
+#ifdef _MSC_VER
+	HANDLE thread;               ///< The worker thread.
+	CRITICAL_SECTION mutex;      ///< Protects the flags below.
+	CONDITION_VARIABLE cond;     ///< Signals a change of the flags below.
+#else
+	pthread_t thread;            ///< The worker thread.
+	pthread_mutex_t mutex;       ///< Protects the flags below.
+	pthread_cond_t cond;         ///< Signals a change of the flags below.
+#endif
+	int isRunning;               ///< 1 if the thread has been started.
+	int isBusy;                  ///< 1 from posting a job until it returned.
+	int quit;                    ///< 1 if the thread should exit.
+	AsyncWorkerJob job;          ///< The job.
+	AsyncWorkerJob finished;     ///< Called after the job returned and \c isBusy was reset, or \c NULL.
+	void *arg;                   ///< The argument of \c job and \c finished.
+} AsyncWorker;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Starts the worker thread.
+///
+///\param w The worker. Must be zero-initialized or stopped.
+///\param job The function that is run for each posted job.
+///\param finished The function that is run after each job, once
+///       \c asyncWorker_isBusy returns 0, or \c NULL.
+///\param arg The argument of \c job and \c finished.
+///\return 0 if no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+int asyncWorker_start(AsyncWorker *w, AsyncWorkerJob job, AsyncWorkerJob finished, void *arg);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Runs the job once in the worker thread, and returns without waiting.
+///
+/// The previous job must have returned.
+///
+///\param w The worker.
+///\return 0 if no error occurred, 1 if the worker is not running or busy.
+///////////////////////////////////////////////////////////////////////////////
+int asyncWorker_post(AsyncWorker *w);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Returns whether a posted job has not yet returned.
+///
+///\param w The worker.
+///\return 1 if the job is running, 0 otherwise.
+///////////////////////////////////////////////////////////////////////////////
+int asyncWorker_isBusy(AsyncWorker *w);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Waits until a posted job has returned.
+///
+/// Returns immediately if the worker is not running or not busy.
+/// The function may return before \c finished has been called.
+///
+///\param w The worker.
+///////////////////////////////////////////////////////////////////////////////
+void asyncWorker_wait(AsyncWorker *w);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Waits for a posted job, and stops the worker thread.
+///
+///\param w The worker.
+///////////////////////////////////////////////////////////////////////////////
+void asyncWorker_stop(AsyncWorker *w);
+
+#endif /* _ASYNCWORKER_H_ */
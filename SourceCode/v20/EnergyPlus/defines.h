@@ -38,8 +38,16 @@
 #define FRUNINFILE   "runinfile.idf"
 #define FRUNWEAFILE  "runweafile.epw"
 #define FTIMESTEP    "tstep.txt"
+#define PREPCACHE    "Output_EPExport_cache"
+#define EPPREPCACHE  "ENERGYPLUSTOFMU_PREP_CACHE"
+#define EPPOOL       "Output_EPExport_pool"
+#define EPPOOLSIZE   "ENERGYPLUSTOFMU_POOL_SIZE"
+#define EPPOOLMAX    "ENERGYPLUSTOFMU_POOL_MAX"
+#define EPTIMING     "ENERGYPLUSTOFMU_TIMING"
+#define PHASETIMES   "startupTiming.json"
 #define VARCFG       "variables.cfg"
 #define SOCKCFG      "socket.cfg"
+#define SOCKUNIX     "socket.sock"
 #define EPBAT        "EP.bat"
 #define MAX_VARNAME_LEN 100
 #ifdef _MSC_VER
@@ -54,6 +62,10 @@
 #include "../fmusdk-shared/include/fmi2TypesPlatform.h"
 #include "../fmusdk-shared/include/fmi2Functions.h"
 #include "../fmusdk-shared/parser/XmlParserCApi.h"
+#include "valueRefTable.h"
+#include "../../socket/utilSocket.h"
+#include "asyncWorker.h"
+#include "phaseTimer.h"
 
 
 /* Export fmi functions on Windows */
@@ -83,7 +95,8 @@ typedef struct ModelInstance {
 	int numInVar;
 	int numOutVar;
 	int sockfd;
-	int newsockfd;
+	int unixsockfd;
+	SocketConnection con;
 
 	fmi2Boolean visible;
 	fmi2Boolean loggingOn;
@@ -105,6 +118,10 @@ typedef struct ModelInstance {
 	int readReady;
 	int writeReady;
 	int timeStepIDF;
+	int isAsync;
+	fmi2Status stepStatus;
+	AsyncWorker worker;
+	PhaseTimer timer;
 	int getCounter;
 	int setCounter;
 	int setupExperiment;
@@ -112,6 +129,10 @@ typedef struct ModelInstance {
 	ModelDescription * md;
 	fmi2Real *inVec;
 	fmi2Real *outVec;
+	fmi2Real *batBuf;
+	size_t batBufLen;
+	ValueRefTable inVrTab;
+	ValueRefTable outVrTab;
 	fmi2Real tStartFMU;
 	fmi2Real tStopFMU;
 	fmi2Real nexComm;
@@ -24,6 +24,9 @@
 #define MAXBUFFSIZE 1000
 //#define LIBXML_STATIC 1
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // for posix_spawn_file_actions_addchdir_np()
+#endif
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -38,6 +41,8 @@
 #include "../fmusdk-shared/fmi2.h"
 #include "../fmusdk-shared/sim_support.h"
 #include "../fmusdk-shared/xmlVersionParser.h"
+#include "modelDescCache.h"
+#include "../../fmu-export-prep-shared/fmu-export-prep-lib.h"
 
 #ifdef _MSC_VER
 #pragma comment(lib, "legacy_stdio_definitions.lib")
@@ -92,38 +97,89 @@ void getNumInputOutputVariablesInFMU(ModelDescription *md, int* inp, int* out) {
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// This function returns the path of a file in the output folder of the FMU.
+///
+/// The FMU does not change the working directory, which is shared by all
+/// threads of the process, so that instances can be initialized concurrently.
+///
+///\param _c The FMU instance.
+///\param fileName The name of the file.
+///\return The path of the file, to be freed with freeMemory.
+///////////////////////////////////////////////////////////////////////////////
+static char* getOutputPath(ModelInstance *_c, const char *fileName)
+{
+	char *path;
+	path=(char *)_c->functions->allocateMemory(strlen(_c->fmuOutput) + strlen(fileName) + 1, sizeof(char));
+	sprintf(path, "%s%s", _c->fmuOutput, fileName);
+	return path;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// This function checks whether the time of the startup phases is reported.
+///
+/// The time is reported if loggingOn is set, or if the environment
+/// variable ENERGYPLUSTOFMU_TIMING is set to a value other than 0.
+///
+///\param loggingOn The argument loggingOn of fmi2Instantiate.
+///\return 1 if the time is reported.
+///////////////////////////////////////////////////////////////////////////////
+static int isTimingOn(fmi2Boolean loggingOn)
+{
+	const char *env=getenv(EPTIMING);
+	return loggingOn == fmi2True || (env != NULL && strcmp(env, "0") != 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// This function checks whether the run files are taken from a cache.
+///
+///\return 1 if the environment variable EPPREPCACHE is set and not 0, else 0.
+///////////////////////////////////////////////////////////////////////////////
+static int isPrepCacheOn(void)
+{
+	const char *env=getenv(EPPREPCACHE);
+	return env != NULL && strcmp(env, "0") != 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// This function deletes temporary created files.
+///
+///\param _c The FMU instance.
 ///////////////////////////////////////////////////////////////////////////////
-int findFileDelete()
+int findFileDelete(ModelInstance *_c)
 {
+	const char *tmpFiles[] = {VARCFG, SOCKCFG, EPBAT, FTIMESTEP};
 	struct stat stat_p;
-	int res;
-
-	if (stat(VARCFG, &stat_p) >= 0)
-	{
-		remove(VARCFG);
-	}
-	if (stat(SOCKCFG, &stat_p) >= 0)
-	{
-		remove(SOCKCFG);
-	}
-	if (stat(EPBAT, &stat_p) >= 0)
-	{
-		remove(EPBAT);
-	}
-	if (stat(FTIMESTEP, &stat_p) >= 0)
-	{
-		remove(FTIMESTEP);
+	DIR *dirp;
+	struct dirent *dp;
+	size_t len;
+	size_t i;
+	char *path;
+
+	for (i = 0; i < sizeof(tmpFiles)/sizeof(tmpFiles[0]); i++){
+		path = getOutputPath(_c, tmpFiles[i]);
+		if (stat(path, &stat_p) >= 0){
+			remove(path);
+		}
+		_c->functions->freeMemory(path);
 	}
-	if (stat(FRUNWEAFILE, &stat_p) >= 0){
+	path = getOutputPath(_c, FRUNWEAFILE);
+	if (stat(path, &stat_p) >= 0){
 		// cleanup .epw files
-#ifdef _MSC_VER
-		res = system("del *.epw");
-#else
-		res = system("rm -f *.epw");
-#endif
+		dirp = opendir(_c->fmuOutput);
+		if (dirp != NULL){
+			while ((dp = readdir(dirp)) != NULL){
+				len = strlen(dp->d_name);
+				if (len > 4 && strcmp(dp->d_name + len - 4, ".epw") == 0){
+					char *epwPath = getOutputPath(_c, dp->d_name);
+					remove(epwPath);
+					_c->functions->freeMemory(epwPath);
+				}
+			}
+			closedir(dirp);
+		}
 	}
+	_c->functions->freeMemory(path);
 	return 0;
 }
 
@@ -284,11 +340,18 @@ int getResFile(ModelInstance *_c, fmi2String pattern)
 ///\param porNum The port number.
 ///\param hostName The host name.
 ///\return 0 if no error occurred.
+///
+/// If the FMU instance listens on a Unix domain socket, or if its
+/// connection has a shared memory region, their names are written
+/// as well. EnergyPlus versions that do not know these elements
+/// ignore them and connect to the TCP socket.
 ////////////////////////////////////////////////////////////////////////////////////
 int write_socket_cfg(ModelInstance *_c, int portNum, const char* hostName)
 {
 	FILE *fp;
-	fp=fopen("socket.cfg", "w");
+	char *path=getOutputPath(_c, SOCKCFG);
+	fp=fopen(path, "w");
+	_c->functions->freeMemory(path);
 	if (fp==NULL) {
 		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",  "Can't open socket.cfg file.\n");
 		return 1;  // STL error code: File not open.
@@ -300,6 +363,12 @@ int write_socket_cfg(ModelInstance *_c, int portNum, const char* hostName)
 	fprintf(fp, "<BCVTB-client>\n");
 	fprintf(fp, "  <ipc>\n");
 	fprintf(fp, "    <socket port=\"%d\" hostname=\"%s\"/>\n", portNum, hostName);
+	if (_c->unixsockfd != INVALID_SOCKET) {
+		fprintf(fp, "    <unixsocket path=\"%s\"/>\n", SOCKUNIX);
+	}
+	if (_c->con.shm.base != NULL) {
+		fprintf(fp, "    <sharedmemory name=\"%s\"/>\n", _c->con.shm.name);
+	}
 	fprintf(fp, "  </ipc>\n");
 	fprintf(fp, "</BCVTB-client>\n");
 	fclose(fp);
@@ -307,7 +376,7 @@ int write_socket_cfg(ModelInstance *_c, int portNum, const char* hostName)
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
-/// copy variables.cfg file into the results folder
+/// link or copy variables.cfg file into the results folder
 ///
 ///\param _c The FMU instance.
 ///\return 0 if no error occurred.
@@ -316,21 +385,11 @@ int copy_var_cfg(ModelInstance *_c)
 {
 	char *tmp_str;
 	int retVal;
-	tmp_str=(char*)(_c->functions->allocateMemory(strlen(_c->tmpResCon) + strlen (_c->fmuOutput) + 30, sizeof(char)));
-
-#ifdef _MSC_VER
-	//"\"" are quotes needed for path with spaces in the names
-	sprintf(tmp_str, "xcopy %s%s %s%s%s /Y /I", "\"", _c->tmpResCon, "\"", _c->fmuOutput, "\"");
-#elif __linux__
-	sprintf(tmp_str, "cp -f %s%s %s%s%s", "\"", _c->tmpResCon,  "\"", _c->fmuOutput, "\"");
-#elif __APPLE__
-	sprintf(tmp_str, "cp -f %s%s %s%s%s", "\"", _c->tmpResCon,  "\"", _c->fmuOutput, "\"");
-#else
-	printf ("Cannot execute %s. The FMU export is only supported on Windows, Linux and Mac OS.\n", tmp_str);
-#endif
+	tmp_str=(char*)(_c->functions->allocateMemory(strlen (_c->fmuOutput) + strlen (VARCFG) + 1, sizeof(char)));
+	sprintf(tmp_str, "%s%s", _c->fmuOutput, VARCFG);
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
-		"Command executes to copy content of resources folder: %s\n", tmp_str);
-	retVal=system (tmp_str);
+		"Link or copy %s to %s\n", _c->tmpResCon, tmp_str);
+	retVal=fmuExportPrep_linkOrCopyFile (_c->tmpResCon, tmp_str);
 	_c->functions->freeMemory(tmp_str);
 	return retVal;
 }
@@ -343,15 +402,7 @@ int copy_var_cfg(ModelInstance *_c)
 ////////////////////////////////////////////////////////////////////////////////////
 int create_res(ModelInstance *_c)
 {
-	char *tmp_str;
-	int retVal;
-	// The 30 are for the additional characters in tmp_str
-	tmp_str=(char*)(_c->functions->allocateMemory(strlen(_c->fmuOutput) + 30, sizeof(char)));
-
-	sprintf(tmp_str, "mkdir %s%s%s", "\"", _c->fmuOutput, "\"");
-	retVal=system (tmp_str);
-	_c->functions->freeMemory (tmp_str);
-	return retVal;
+	return createDir (_c->fmuOutput);
 }
 
 
@@ -363,23 +414,9 @@ int create_res(ModelInstance *_c)
 ////////////////////////////////////////////////////////////////////////////////////
 int removeFMUDir (ModelInstance* _c)
 {
-	int retVal;
-	char *tmp_str;
-	// The 30 are for the additional characters in tmp_str
-	tmp_str=(char*)(_c->functions->allocateMemory(strlen(_c->fmuOutput) + 30, sizeof(char)));
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
 		"This is the output folder %s\n", _c->fmuOutput);
-
-#ifdef _MSC_VER
-	sprintf(tmp_str, "rmdir /S /Q %s%s%s", "\"", _c->fmuOutput, "\"");
-#else
-	sprintf(tmp_str, "rm -rf %s%s%s", "\"", _c->fmuOutput, "\"");
-#endif
-	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
-		"This is the command to be executed to delete existing directory %s\n", tmp_str);
-	retVal=system (tmp_str);
-	_c->functions->freeMemory (tmp_str);
-	return retVal;
+	return removeDir (_c->fmuOutput);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -391,9 +428,14 @@ int removeFMUDir (ModelInstance* _c)
 int start_sim(ModelInstance* _c)
 {
 	struct stat stat_p;
+	char *path;
+	int haveWea;
 
 #ifdef _MSC_VER
 	FILE *fpBat;
+	char cmdLine[]="cmd.exe /c " EPBAT;
+	STARTUPINFOA si;
+	PROCESS_INFORMATION pi;
 #else
 #ifdef __APPLE__
 #include <crt_externs.h>
@@ -407,9 +449,18 @@ int start_sim(ModelInstance* _c)
 		"This version uses the **energyplus** command line interface to "
 		" call the EnergyPlus executable. **RunEPlus.bat** and **runenergyplus** ,"
 		" which were used in earlier versions, were deprecated as of August 2015.");
+	// EnergyPlus runs in the output folder, hence the relative file names
+	path=getOutputPath(_c, FRUNWEAFILE);
+	haveWea=(stat(path, &stat_p)>=0);
+	_c->functions->freeMemory(path);
 #ifdef _MSC_VER
-	fpBat=fopen("EP.bat", "w");
-	if (stat(FRUNWEAFILE, &stat_p)>=0){
+	path=getOutputPath(_c, EPBAT);
+	fpBat=fopen(path, "w");
+	_c->functions->freeMemory(path);
+	if (fpBat==NULL) {
+		return 1;
+	}
+	if (haveWea){
 		// write the command string
 		fprintf(fpBat, "energyplus %s %s %s %s %s %s %s %s %s %s",
 			"-w", FRUNWEAFILE, "-p", _c->mID, "-s", "C", "-x", "-m",
@@ -422,30 +473,45 @@ int start_sim(ModelInstance* _c)
 			"-p", _c->mID, "-s", "C", "-x", "-m", "-r", _c->in_file_name);
 	}
 	fclose (fpBat);
-	_c->pid=(HANDLE)_spawnl(P_NOWAIT, "EP.bat", "EP.bat", NULL);
-	if (_c->pid > 0 ) {
-		return 0;
-	}
-	else {
+	// run the batch file in the output folder
+	memset(&si, 0, sizeof(si));
+	si.cb=sizeof(si);
+	if (!CreateProcessA(NULL, cmdLine, NULL, NULL, FALSE, 0, NULL, _c->fmuOutput, &si, &pi)) {
 		return 1;
 	}
+	CloseHandle(pi.hThread);
+	_c->pid=pi.hProcess;
+	return 0;
 #else
-	if (stat (FRUNWEAFILE, &stat_p)>=0){
+	{
 		//char *const argv[]={"runenergyplus", _c->mID, FRUNWEAFILE, NULL};
-		char *const argv[]={"energyplus", "-w", FRUNWEAFILE, "-p", _c->mID,
+		char *const argvWea[]={"energyplus", "-w", FRUNWEAFILE, "-p", _c->mID,
 			"-s", "C", "-x", "-m", "-r", _c->in_file_name, NULL};
-		// execute the command string
-		retVal=posix_spawnp( &_c->pid, argv[0], NULL, NULL, argv, environ);
-		return retVal;
-	}
-	else
-	{
 		//char *const argv[]={"runenergyplus", _c->mID, NULL};
-		char *const argv[]={"energyplus", "-p", _c->mID, "-s", "C", "-x",
+		char *const argvNoWea[]={"energyplus", "-p", _c->mID, "-s", "C", "-x",
 			"-m", "-r", _c->in_file_name, NULL};
-		// execute the command string
-		retVal=posix_spawnp( &_c->pid, argv[0], NULL, NULL, argv, environ);
+		char *const *argv=haveWea ? argvWea : argvNoWea;
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+		// execute the command string in the output folder
+		posix_spawn_file_actions_t actions;
+		posix_spawn_file_actions_init(&actions);
+		retVal=posix_spawn_file_actions_addchdir_np(&actions, _c->fmuOutput);
+		if (retVal==0) {
+			retVal=posix_spawnp( &_c->pid, argv[0], &actions, NULL, argv, environ);
+		}
+		posix_spawn_file_actions_destroy(&actions);
 		return retVal;
+#else
+		// change to the output folder in the child process only
+		_c->pid=fork();
+		if (_c->pid==0) {
+			if (chdir(_c->fmuOutput)==0) {
+				execvp(argv[0], argv);
+			}
+			_exit(127);
+		}
+		return (_c->pid > 0) ? 0 : errno;
+#endif
 	}
 #endif
 }
@@ -546,6 +612,9 @@ int freeInstanceResources(ModelInstance* _c) {
 	// free model GUID
 	if (_c->mGUID!=NULL) _c->functions->freeMemory(_c->mGUID);
 	_c->mGUID = NULL;
+	// release the model description
+	mdCache_release(_c->md);
+	_c->md = NULL;
 	// free xml file
 	if (_c->xml_file!=NULL) _c->functions->freeMemory(_c->xml_file);
 	_c->xml_file = NULL;
@@ -576,6 +645,20 @@ int freeInstanceResources(ModelInstance* _c) {
 	// deallocate memory for outVec
 	if (_c->outVec != NULL)  _c->functions->freeMemory(_c->outVec);
 	_c->outVec = NULL;
+	// deallocate memory for the values of batched steps
+	if (_c->batBuf != NULL)  _c->functions->freeMemory(_c->batBuf);
+	_c->batBuf = NULL;
+	_c->batBufLen = 0;
+	// deallocate the value reference lookup tables
+	vrTable_free(&_c->inVrTab, _c->functions);
+	vrTable_free(&_c->outVrTab, _c->functions);
+	// stop the thread that exchanges data asynchronously
+	asyncWorker_stop(&_c->worker);
+	// free the buffers of the socket connection
+	freeconnectionFMU(&_c->con);
+	// close the Unix domain socket if no connection was accepted
+	if (_c->unixsockfd != INVALID_SOCKET) closeipcFMU(&(_c->unixsockfd));
+	_c->unixsockfd=INVALID_SOCKET;
 	 // free fmu instance
 	if (_c!=NULL) _c->functions->freeMemory(_c);
 	_c=NULL;
@@ -735,9 +818,12 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 	fmi2String mID;
 	fmi2String mGUID;
 	fmi2String mFmiVers;
+	ValueStatus vs;
 	struct stat st;
 	fmi2Boolean errDir;
 	ModelInstance* _c;
+	// time the instantiation, which creates the output folder and parses the model description
+	const double tStart = getWallClockTime();
 
 	// Perform checks.
 	if (!functions->logger)
@@ -763,6 +849,10 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 	// write instanceName to the struct
 	strcpy(_c->instanceName, instanceName);
 
+	// time the phases of the start if requested
+	phaseTimer_init(&_c->timer, isTimingOn(loggingOn));
+	phaseTimer_begin(&_c->timer);
+
 	// check fmu location
 	functions->logger(functions->componentEnvironment, instanceName, fmi2OK, "ok",
 		"fmi2Instantiate: The Resource location of FMU with instance name %s is %s.\n",
@@ -773,6 +863,8 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 	_c->functions=functions;
 	_c->loggingOn=loggingOn;
 	_c->setupExperiment = 0;
+	_c->unixsockfd=INVALID_SOCKET;
+	_c->stepStatus=fmi2OK;
 	if (visible == fmi2True) {
 		_c->functions->logger(functions->componentEnvironment, instanceName, fmi2Warning, "warning",
 			"fmi2Instantiate: Argument visible is set to %d\n."
@@ -784,7 +876,7 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 	if (loggingOn == fmi2True) {
 		_c->functions->logger(functions->componentEnvironment, instanceName, fmi2Warning, "warning",
 			"fmi2Instantiate: Argument loggingOn is set to %d\n."
-			" This is not supported. loggingOn will default to '0'.\n", loggingOn);
+			" Only the time of the startup phases is reported.\n", loggingOn);
 	}
 
 	_c->visible = fmi2False;
@@ -823,6 +915,7 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 				"fmi2Instantiate: The fmuOutput directory %s could not be deleted\n", _c->fmuOutput);
 		}
 	}
+	phaseTimer_end(&_c->timer, "directory cleanup");
 
 	// check whether the path to the resource folder has been provided
 	if((fmuLocation==NULL) || (strlen(fmuLocation)==0)) {
@@ -850,11 +943,11 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 	replace_char (_c->fmuResourceLocation, '//', '\\');
 	replace_char (_c->fmuUnzipLocation, '//', '\\');
 #endif
+	phaseTimer_end(&_c->timer, "resource lookup");
 	
-	// create content of resources folder in created output directory
-	// "\"" is to make sure that we have quotation at the end of the path for variables.cfg.
-	_c->tmpResCon=(char *)_c->functions->allocateMemory(strlen (_c->fmuResourceLocation) + strlen (VARCFG) + strlen ("\"") + 1, sizeof(char));
-	sprintf(_c->tmpResCon, "%s%s%s", _c->fmuResourceLocation, "\"", VARCFG);
+	// path to the variables.cfg of the resources folder, to be copied to the output directory
+	_c->tmpResCon=(char *)_c->functions->allocateMemory(strlen (_c->fmuResourceLocation) + strlen (VARCFG) + 1, sizeof(char));
+	sprintf(_c->tmpResCon, "%s%s", _c->fmuResourceLocation, VARCFG);
 	
 	// create the output directory
 	retVal=create_res(_c);
@@ -876,20 +969,7 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 		freeInstanceResources (_c);
 		return NULL;
 	}
-	
-	// change the directory to make sure that FMUs are not overwritten
-#ifdef _MSC_VER
-	retVal=_chdir(_c->fmuOutput);
-#else
-	retVal=chdir(_c->fmuOutput);
-#endif
-	if (retVal!=0){
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2Instantiate: Could not switch"
-			" to the output folder %s. Instantiation of %s failed.\n", _c->fmuOutput, _c->instanceName);
-		// Free resources allocated to instance.
-		freeInstanceResources (_c);
-		return NULL;
-	}
+	phaseTimer_end(&_c->timer, "directory creation");
 	
 	// create path to xml file
 	_c->xml_file=(char *)_c->functions->allocateMemory(strlen (_c->fmuUnzipLocation) + strlen (XML_FILE) + 1, sizeof(char));
@@ -897,8 +977,8 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
 		"fmi2Instantiate: Path to model description file is %s.\n", _c->xml_file);
 	
-	// get model description of the FMU
-	_c->md=parse(_c->xml_file);
+	// get model description of the FMU, which is shared by the instances of the FMU
+	_c->md=mdCache_acquire(_c->xml_file, fmuGUID);
 	if (!_c->md) {
 		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2Instantiate: Failed to parse the model description"
 			" found in directory %s. Instantiation of %s failed\n", _c->xml_file, _c->instanceName);
@@ -906,6 +986,7 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 		freeInstanceResources (_c);
 		return NULL;
 	}
+	phaseTimer_end(&_c->timer, "XML parse");
 	
 	// get the modelID of the FMU
 	mID = getAttributeValue((Element *)getCoSimulation(_c->md), att_modelIdentifier);
@@ -914,6 +995,17 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 	_c->mID=(char *)_c->functions->allocateMemory(strlen(mID) + 1, sizeof(char));
 	strcpy(_c->mID, mID);
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok", "fmi2Instantiate: The FMU modelIdentifier is %s.\n", _c->mID);
+
+	// run fmi2DoStep asynchronously if the FMU was exported with this
+	// capability and the master can be notified
+	_c->isAsync=(functions->stepFinished != NULL
+		&& getAttributeBool((Element *)getCoSimulation(_c->md), att_canRunAsynchronuously, &vs)
+		&& vs == valueDefined);
+	if (_c->isAsync) {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+			"fmi2Instantiate: Callback stepFinished is set. fmi2DoStep will return fmi2Pending"
+			" and exchange data with EnergyPlus in a separate thread.\n");
+	}
 	
 	// get the model GUID of the FMU
 	mGUID = getAttributeValue((Element *)(_c->md), att_guid);
@@ -934,7 +1026,7 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 	}
 	
 	// check whether the model is exported for FMI version 1.0
-	mFmiVers = extractVersion(_c->xml_file);
+	mFmiVers = getAttributeValue((Element *)(_c->md), att_fmiVersion);
 	if(strcmp(mFmiVers, FMIVERSION) !=0){
 		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2Instantiate: Wrong FMI version %s."
 			" FMI version 1.0 is currently supported. Instantiation of %s failed.\n", mFmiVers, _c->instanceName);
@@ -945,52 +1037,82 @@ DllExport fmi2Component fmi2Instantiate(fmi2String instanceName,
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
 		"fmi2Instantiate: Slave %s is instantiated.\n", _c->instanceName);
 	
-	// reset the current working directory. This is particularly important for Dymola
-	// otherwise Dymola will write results at wrong place
-#ifdef _MSC_VER
-	retVal=_chdir(_c->cwd);
-#else
-	retVal=chdir(_c->cwd);
-#endif
-	if (retVal!=0){
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2Instantiate: Could not switch to"
-			" the working directory folder %s. Instantiation of %s failed.\n", _c->cwd, _c->instanceName);
-		// Free resources allocated to instance.
-		freeInstanceResources (_c);
-		return NULL;
-	}
-	
 	// This is required to prevent Dymola to call fmi2SetReal before the initialization
 	_c->firstCallIni=1;
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
-		"fmi2Instantiate: Instantiation of %s succeded.\n", _c->instanceName);
+		"fmi2Instantiate: Instantiation of %s succeded in %.3f ms.\n", _c->instanceName,
+		1e3*(getWallClockTime() - tStart));
 
 	return(_c);
 }
 
-////////////////////////////////////////////////////////////////
-///  This method is used to enter initialization in the FMU
+////////////////////////////////////////////////////////////////////////////////////
+/// stop simulation
 ///
-///\param c The FMU instance.
+/// Sends the end of simulation flag to EnergyPlus, closes the sockets
+/// and waits for EnergyPlus to terminate. Does nothing if EnergyPlus
+/// has not been started.
+///
+///\param _c The FMU instance.
+////////////////////////////////////////////////////////////////////////////////////
+static void stop_sim(ModelInstance* _c)
+{
+#ifndef _MSC_VER
+	int status;
+#endif
+	// stop the thread of the asynchronous steps before using the socket
+	asyncWorker_stop(&_c->worker);
+	if (_c->pid==0) {
+		return;
+	}
+	// send end of simulation flag
+	_c->flaWri=1;
+	_c->flaRea=1;
+	exchangedoubleswithsocketFMUex (&(_c->con), &(_c->flaWri),
+		&(_c->flaRea), &(_c->numOutVar), &(_c->numInVar),
+		&(_c->simTimRec), _c->outVec, &(_c->simTimSen),
+		_c->inVec);
+	// close socket
+	closeipcFMU(&(_c->sockfd));
+	closeipcFMU(&(_c->con.sockfd));
+	_c->sockfd=INVALID_SOCKET;
+	_c->con.sockfd=INVALID_SOCKET;
+#ifdef _MSC_VER
+	// wait for object to terminate
+	WaitForSingleObject (_c->pid, INFINITE);
+	TerminateProcess(_c->pid, 0);
+	CloseHandle(_c->pid);
+#else
+	waitpid (_c->pid, &status, 0);
+#endif
+	_c->pid=0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+/// Prepares the run in the output folder of the FMU instance and starts EnergyPlus.
+///
+/// Opens the sockets and the shared memory that are offered to EnergyPlus,
+/// writes the input and weather file of the run, and starts EnergyPlus in
+/// the output folder. The connection is accepted by the caller.
+///
+///\param _c The FMU instance.
 ///\return fmi2OK if no error occurred.
-////////////////////////////////////////////////////////////////
-DllExport fmi2Status fmi2EnterInitializationMode(fmi2Component c)
+////////////////////////////////////////////////////////////////////////////////////
+static fmi2Status launch_sim(ModelInstance* _c)
 {
 	int retVal;
-	ModelInstance* _c=(ModelInstance *)c;
 	FILE *fp;
 	char tStartFMUstr[100];
 	char tStopFMUstr[100];
-	char command[100];
+	char errMsg[1024];
 	char *tmpstr;
-	char *cmdstr;
-	char *cmdstrEXE;
+	char *cacheDir=NULL;
+	int fromCache;
 
 #ifdef _MSC_VER
 	int sockLength;
 
 #else
-	struct stat stat_p;
 	socklen_t sockLength;
 #endif
 	struct sockaddr_in   server_addr;
@@ -998,81 +1120,6 @@ DllExport fmi2Status fmi2EnterInitializationMode(fmi2Component c)
 	char                 ThisHost[10000];
 	struct  hostent *hp;
 
-#ifdef _MSC_VER
-	WORD wVersionRequested=MAKEWORD(2,2);
-	WSADATA wsaData;
-#endif
-
-#ifndef _MSC_VER
-	mode_t process_mask=umask(0);
-#endif
-
-	// Check if setup experiment has been called
-	if (_c->setupExperiment != 1) {
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
-			"fmi2EnterInitializationMode: fmi2SetupExperiment must be called at least once prior "
-			" to calling fmi2EnterInitializationMode\n");
-		return fmi2Error;
-	}
-
-	// reset flag for indicating that fmi2SetupExperiment() has been called.
-	_c->setupExperiment = 0;
-
-	// initialize structure variables
-	_c->firstCallGetReal      =1;
-	//_c->firstCallSetReal      =1;
-	_c->firstCallDoStep       =1;
-	_c->firstCallFree         =1;
-	_c->firstCallTerm         =1;
-	_c->firstCallRes          =1;
-	_c->flaGetRealCall        =0;
-	_c->flaGetRea=0;
-	_c->flaWri=0;
-	_c->flaRea=0;
-	_c->wea_file = NULL;
-	_c->in_file = NULL;
-	_c->in_file = NULL;
-	_c->getCounter=0;
-	_c->setCounter=0;
-	_c->readReady=0;
-	_c->writeReady=0;
-	_c->numInVar =-1;
-	_c->numOutVar=-1;
-
-	// change the directory to make sure that FMUs are not overwritten
-#ifdef _MSC_VER
-	retVal=_chdir(_c->fmuOutput);
-#else
-	retVal=chdir(_c->fmuOutput);
-#endif
-	if (retVal!=0){
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
-			"fmi2EnterInitializationMode: The path to the output folder %s is not valid.\n", _c->fmuOutput);
-		return fmi2Error;
-	}
-	///////////////////////////////////////////////////////////////////////////////////
-	// create the socket server
-
-#ifdef _MSC_VER
-	// initialize winsock  /************* Windows specific code ********/
-	if (WSAStartup(wVersionRequested, &wsaData)!=0)
-	{
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName , fmi2Error,
-			"error", "fmi2EnterInitializationMode: WSAStartup failed with error %ld.\n", WSAGetLastError());
-		WSACleanup();
-		return fmi2Error;
-	}
-	// check if the version is supported
-	if (LOBYTE(wsaData.wVersion)!=2 || HIBYTE(wsaData.wVersion)!=2 )
-	{
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error,
-			"error", "fmi2EnterInitializationMode: Could not find a usable WinSock DLL for WinSock version %u.%u.\n",
-			LOBYTE(wsaData.wVersion), HIBYTE(wsaData.		wVersion));
-		WSACleanup();
-		return fmi2Error;
-	}
-#endif  /************* End of Windows specific code *******/
-
 	_c->sockfd=socket(AF_INET, SOCK_STREAM, 0);
 	// check for errors to ensure that the socket is a valid socket.
 	if (_c->sockfd==INVALID_SOCKET)
@@ -1118,14 +1165,6 @@ DllExport fmi2Status fmi2EnterInitializationMode(fmi2Component c)
 		return fmi2Error;
 	}
 
-	// write socket cfg file
-	retVal=write_socket_cfg (_c, port_num, ThisHost);
-	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",  "fmi2EnterInitializationMode: This hostname is %s.\n", ThisHost);
-	if  (retVal !=0) {
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error,
-			"error", "fmi2EnterInitializationMode: Write socket cfg failed.\n");
-		return fmi2Error;
-	}
 	// listen to the port
 	if (listen(_c->sockfd, 1)==SOCKET_ERROR)
 	{
@@ -1135,134 +1174,628 @@ DllExport fmi2Status fmi2EnterInitializationMode(fmi2Component c)
 	}
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",  "fmi2EnterInitializationMode: TCPServer Server waiting for clients on port: %d.\n", port_num);
 
-	// Initialize the number of inputs and output variables
-	_c->numInVar = 0;
-	_c->numOutVar = 0;
-
-	// Get the number of inputs and output variables
-	getNumInputOutputVariablesInFMU(_c->md, &_c->numInVar, &_c->numOutVar);
-
-	if (_c->numInVar!=0)
-	{
-		// initialize the input vectors
-		_c->inVec=(fmi2Real*)_c->functions->allocateMemory(_c->numInVar, sizeof(fmi2Real));
+	// offer EnergyPlus a shared memory region for the data exchange,
+	// which is large enough for the inputs and for the outputs
+	initconnectionFMU(&_c->con, INVALID_SOCKET);
+	if (shmcreateFMU(&_c->con.shm, getbinarybufferlengthFMU(
+		_c->numInVar > _c->numOutVar ? _c->numInVar : _c->numOutVar, 0, 0)) == 0) {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+			"fmi2EnterInitializationMode: The shared memory region is %s.\n", _c->con.shm.name);
+	}
+	else {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+			"fmi2EnterInitializationMode: Shared memory is not available, data will be exchanged through the socket.\n");
 	}
-	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",  "fmi2EnterInitializationMode: The number of input variables is %d.\n", _c->numInVar);
 
-	// get the number of output variables of the FMU
-	if (_c->numOutVar!=0)
-	{
-		// initialize the output vector
-		_c->outVec=(fmi2Real*)_c->functions->allocateMemory(_c->numOutVar, sizeof(fmi2Real));
+	// offer EnergyPlus a Unix domain socket in the output folder, which is
+	// its working directory, as the TCP socket is slower and uses a port.
+	// If the path is too long for a socket address, the TCP socket is used.
+	tmpstr=getOutputPath(_c, SOCKUNIX);
+	_c->unixsockfd=openunixsocketFMU(tmpstr);
+	_c->functions->freeMemory(tmpstr);
+	if (_c->unixsockfd != INVALID_SOCKET) {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+			"fmi2EnterInitializationMode: Listening on Unix domain socket %s.\n", SOCKUNIX);
 	}
-	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",  "fmi2EnterInitializationMode: The number of output variables is %d.\n", _c->numOutVar);
 
-	if ( (_c->numInVar + _c->numOutVar)==0){
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
-			"fmi2EnterInitializationMode: The FMU instance %s has no input and output variables. Please check the model description file.\n",
-			_c->instanceName);
+	// write socket cfg file
+	retVal=write_socket_cfg (_c, port_num, ThisHost);
+	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",  "fmi2EnterInitializationMode: This hostname is %s.\n", ThisHost);
+	if  (retVal !=0) {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error,
+			"error", "fmi2EnterInitializationMode: Write socket cfg failed.\n");
 		return fmi2Error;
 	}
-	// create the input and weather file for the run
-	// Need to see how we will parste the start and stop time so
-	// they become strings and can be used by str when calling the system command.
+	phaseTimer_end(&_c->timer, "socket setup");
 
-	// get input file from the folder. There must be only one input file in the folder.
-	retVal = getResFile(_c, ".idf");
+	sprintf(tStartFMUstr, "%f", _c->tStartFMU);
+	sprintf(tStopFMUstr, "%f", _c->tStopFMU);
+
+	// write the input and weather file of the run in this process.
+	// If EPPREPCACHE is set, instances started in the same directory share
+	// a cache of these files, so that repeated runs of the same FMU do not
+	// prepare them again.
+	if (isPrepCacheOn()){
+		cacheDir = (char *)_c->functions->allocateMemory(strlen(_c->cwd) + strlen(PATH_SEP)
+			+ strlen(PREPCACHE) + 1, sizeof(char));
+		sprintf(cacheDir, "%s%s%s", _c->cwd, PATH_SEP, PREPCACHE);
+	}
+	retVal = fmuExportPrep_writeRunFilesCached(_c->fmuOutput, cacheDir, _c->idd_file, _c->in_file,
+		_c->wea_file, tStartFMUstr, tStopFMUstr, &fromCache, errMsg, sizeof(errMsg));
 	if (retVal != 0){
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not get"
-			" the .idf input file. Instantiation of %s failed.\n",
-			_c->instanceName);
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not"
+			" create the input and weather file: %s Initialization of %s failed.\n",
+			errMsg, _c->instanceName);
+		if (cacheDir != NULL) _c->functions->freeMemory(cacheDir);
 		return fmi2Error;
 	}
-	// get the weather file from the folder. there must be only one weather file in the folder.
-	retVal = getResFile(_c, ".epw");
+	if (fromCache){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+			"fmi2EnterInitializationMode: Linked the input and weather file of the run from cache %s.\n",
+			cacheDir);
+	}
+	if (cacheDir != NULL) _c->functions->freeMemory(cacheDir);
+
+	{
+		char *runInfile = getOutputPath(_c, FRUNINFILE);
+		char *inFile = getOutputPath(_c, _c->in_file_name);
+		retVal = rename(runInfile, inFile);
+		_c->functions->freeMemory(runInfile);
+		_c->functions->freeMemory(inFile);
+	}
 	if (retVal != 0){
 		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not"
-			" get the .epw weather file. Instantiation of %s failed.\n",
+			" rename the temporary input file. Initialization of %s failed.\n",
 			_c->instanceName);
 		return fmi2Error;
 	}
-	// get the idd file from the folder. there must be only one idd file in the folder.
-	retVal = getResFile(_c, ".idd");
-	if (retVal != 0){
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not"
-			" get the .idd dictionary file. Instantiation of %s failed.\n",
-			_c->instanceName);
+
+	tmpstr = getOutputPath(_c, FTIMESTEP);
+	fp = fopen(tmpstr, "r");
+	_c->functions->freeMemory(tmpstr);
+	if(fp !=NULL) {
+		retVal=fscanf(fp, "%d", &(_c->timeStepIDF));
+		fclose (fp);
+		// check if the timeStepIDF is null to avoid division by zero
+		if (_c->timeStepIDF==0){
+			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+				"fmi2EnterInitializationMode: The time step in IDF cannot be null.\n");
+			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",   "fmi2EnterInitializationMode: Time step in IDF is null.\n");
+			return fmi2Error;
+		}
+	}
+	else
+	{
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"fmi2EnterInitializationMode: A valid time step could not be determined.\n");
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",   "fmi2EnterInitializationMode: Can't read time step file.\n");
 		return fmi2Error;
 	}
+	phaseTimer_end(&_c->timer, "preprocessing");
 
-	// Check the validity of the FMU start and stop time
-	if (modulusOp((_c->tStopFMU - _c->tStartFMU), 86400) != 0){
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: The delta"
-			" between the FMU stop time %f and the FMU start time %f must be a multiple of 86400."
-			" This is required by EnergyPlus. The current delta is %f. Instantiation of %s failed.\n",
-			_c->tStopFMU, _c->tStartFMU, _c->tStopFMU - _c->tStartFMU, _c->instanceName);
+	// start the simulation
+	retVal=start_sim(_c);
+	if  (retVal !=0) {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error,
+			"error", "fmi2EnterInitializationMode: The FMU instance could %s not be initialized. "
+			"EnergyPlus can't start . Check if EnergyPlus is installed and on the system path.\n",
+			_c->instanceName);
 		return fmi2Error;
 	}
+	phaseTimer_end(&_c->timer, "EnergyPlus spawn");
+	return fmi2OK;
+}
 
-	sprintf(tStartFMUstr, "%f", _c->tStartFMU);
-	sprintf(tStopFMUstr, "%f", _c->tStopFMU);
 
-	//retVal=createRunInfile(_c);
+#ifndef _MSC_VER
+////////////////////////////////////////////////////////////////////////////////////
+/// Pool of EnergyPlus processes that are started ahead of time.
+///
+/// If the environment variable EPPOOLSIZE is set to n>0, each initialization
+/// of an FMU instance starts EnergyPlus processes until n of them wait for the
+/// same input files and run period. The pool keeps at most EPPOOLMAX processes,
+/// or n if it is not set, and stops the oldest processes of other inputs to
+/// make room for those of the current input. Each process runs in its own folder of
+/// EPPOOL, does the sizing and warm-up, and waits for the FMU to accept its
+/// connection. The next instance that is initialized with the same input claims
+/// the oldest process instead of starting EnergyPlus. As a process of the pool
+/// has not received any input from the FMU, the simulation does not change.
+///
+/// The pool is not used on Windows, where the folder of a running process
+/// cannot be moved to the output folder of the instance that claims it.
+////////////////////////////////////////////////////////////////////////////////////
+typedef struct EpPoolWorker {
+	char *key;                 ///< The FMU, resource location and run period.
+	char *dir;                 ///< The folder in which EnergyPlus runs, with the end slash.
+	int sockfd;                ///< The listening TCP socket.
+	int unixsockfd;            ///< The listening Unix domain socket, or INVALID_SOCKET.
+	SocketConnection con;      ///< The connection, with the shared memory offered to EnergyPlus.
+	int timeStepIDF;           ///< The number of time steps per hour of the run.
+	pid_t pid;                 ///< The EnergyPlus process, or 0 if it has been waited for.
+	double tStart;             ///< The time at which EnergyPlus was started.
+	struct EpPoolWorker *next; ///< The next process, or NULL.
+} EpPoolWorker;
+
+/// The processes of the pool, oldest first, protected by epPoolLock.
+static EpPoolWorker *epPoolHead=NULL;
+/// The number of processes started for the pool, to name their folders.
+static int epPoolNumStarted=0;
+static pthread_mutex_t epPoolLock=PTHREAD_MUTEX_INITIALIZER;
 
-#ifdef _MSC_VER
-	strcpy(command, "idf-to-fmu-export-prep-win.exe");
-#elif __linux__
-	strcpy(command, "idf-to-fmu-export-prep-linux");
-#elif __APPLE__
-	strcpy(command, "idf-to-fmu-export-prep-darwin");
-#endif
+////////////////////////////////////////////////////////////////////////////////////
+/// Get the number of EnergyPlus processes to keep ready for each input.
+///
+///\return The value of the environment variable EPPOOLSIZE, or 0.
+////////////////////////////////////////////////////////////////////////////////////
+static int epPool_getSize(void)
+{
+	const char *size=getenv(EPPOOLSIZE);
+	return (size==NULL) ? 0 : atoi(size);
+}
 
-	if (_c->wea_file != NULL){
-		cmdstr = (char *)_c->functions->allocateMemory(strlen(_c->fmuResourceLocation) + strlen(command) + 10, sizeof(char));
-		sprintf(cmdstr, "%s%s", _c->fmuResourceLocation, command);
-		//Make file executable if UNIX
-#ifndef _MSC_VER
-		cmdstrEXE = (char *)_c->functions->allocateMemory(strlen(cmdstr) + 10, sizeof(char));
-		sprintf(cmdstrEXE, "%s %s", "chmod +x", cmdstr);
-		retVal = system(cmdstrEXE);
-		if (retVal != 0){
-			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not"
-				" make preprocessor executable. Initialization of %s failed.\n",
-				_c->instanceName);
-			return fmi2Error;
+////////////////////////////////////////////////////////////////////////////////////
+/// Get the number of EnergyPlus processes the pool keeps for all inputs.
+///
+///\param size The number of processes to keep ready for each input.
+///\return The value of the environment variable EPPOOLMAX, or \c size
+///        if it is not set to a positive number.
+////////////////////////////////////////////////////////////////////////////////////
+static int epPool_getMax(int size)
+{
+	const char *max=getenv(EPPOOLMAX);
+	const int num=(max==NULL) ? 0 : atoi(max);
+	return (num>0) ? num : size;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+/// Get a copy of a path without the end slash, to be freed with free().
+///
+///\param path The path.
+///\return The copy, or NULL if memory could not be allocated.
+////////////////////////////////////////////////////////////////////////////////////
+static char* epPool_trimPath(const char *path)
+{
+	size_t len=strlen(path);
+	char *trimmed=(char *)malloc(len + 1);
+	if (trimmed==NULL) {
+		return NULL;
+	}
+	while (len>1 && (path[len-1]=='/' || path[len-1]=='\\')) {
+		len--;
+	}
+	memcpy(trimmed, path, len);
+	trimmed[len]='\0';
+	return trimmed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+/// Stop an EnergyPlus process of the pool and remove its folder.
+///
+///\param w The process, which is not in the pool.
+////////////////////////////////////////////////////////////////////////////////////
+static void epPool_freeWorker(EpPoolWorker *w)
+{
+	int status;
+	if (w->pid>0) {
+		kill(w->pid, SIGKILL);
+		waitpid(w->pid, &status, 0);
+	}
+	if (w->sockfd!=INVALID_SOCKET) closeipcFMU(&(w->sockfd));
+	if (w->unixsockfd!=INVALID_SOCKET) closeipcFMU(&(w->unixsockfd));
+	shmcloseFMU(&w->con.shm);
+	if (w->dir!=NULL) removeDir(w->dir);
+	free(w->dir);
+	free(w->key);
+	free(w);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+/// Stop the EnergyPlus processes of the pool when the FMU is unloaded.
+////////////////////////////////////////////////////////////////////////////////////
+__attribute__((destructor)) static void epPool_shutdown(void)
+{
+	EpPoolWorker *w;
+	pthread_mutex_lock(&epPoolLock);
+	while (epPoolHead!=NULL) {
+		w=epPoolHead;
+		epPoolHead=w->next;
+		epPool_freeWorker(w);
+	}
+	pthread_mutex_unlock(&epPoolLock);
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+/// Start an EnergyPlus process for the pool.
+///
+/// The run is prepared by a copy of the FMU instance whose output folder
+/// is the folder of the process, hence exactly as for the instance.
+///
+///\param _c The FMU instance.
+///\param key The FMU, resource location and run period.
+///\return The process, or NULL if it could not be started.
+////////////////////////////////////////////////////////////////////////////////////
+static EpPoolWorker* epPool_start(ModelInstance *_c, const char *key)
+{
+	ModelInstance copy=*_c;
+	EpPoolWorker *w;
+	char *poolDir;
+	int num;
+
+	pthread_mutex_lock(&epPoolLock);
+	num=++epPoolNumStarted;
+	pthread_mutex_unlock(&epPoolLock);
+
+	w=(EpPoolWorker *)calloc(1, sizeof(EpPoolWorker));
+	if (w==NULL) {
+		return NULL;
+	}
+	w->sockfd=INVALID_SOCKET;
+	w->unixsockfd=INVALID_SOCKET;
+	w->key=(char *)malloc(strlen(key) + 1);
+	poolDir=(char *)malloc(strlen(_c->cwd) + strlen(PATH_SEP) + strlen(EPPOOL) + 1);
+	w->dir=(char *)malloc(strlen(_c->cwd) + 3*strlen(PATH_SEP) + strlen(EPPOOL) + 32);
+	if (w->key==NULL || poolDir==NULL || w->dir==NULL) {
+		free(poolDir);
+		epPool_freeWorker(w);
+		return NULL;
+	}
+	strcpy(w->key, key);
+	// the folder of the pool is shared by all processes of the pool
+	sprintf(poolDir, "%s%s%s", _c->cwd, PATH_SEP, EPPOOL);
+	createDir(poolDir);
+	sprintf(w->dir, "%s%s%d-%d", poolDir, PATH_SEP, (int)getpid(), num);
+	free(poolDir);
+	if (createDir(w->dir)!=0) {
+		free(w->dir);
+		w->dir=NULL;
+		epPool_freeWorker(w);
+		return NULL;
+	}
+	strcat(w->dir, PATH_SEP);
+
+	// prepare the run in the folder of the process, and start EnergyPlus
+	copy.fmuOutput=w->dir;
+	copy.sockfd=INVALID_SOCKET;
+	copy.unixsockfd=INVALID_SOCKET;
+	initconnectionFMU(&copy.con, INVALID_SOCKET);
+	copy.pid=0;
+	if (copy_var_cfg(&copy)!=0 || launch_sim(&copy)!=fmi2OK) {
+		w->sockfd=copy.sockfd;
+		w->unixsockfd=copy.unixsockfd;
+		w->con=copy.con;
+		w->pid=copy.pid;
+		epPool_freeWorker(w);
+		return NULL;
+	}
+	w->sockfd=copy.sockfd;
+	w->unixsockfd=copy.unixsockfd;
+	w->con=copy.con;
+	w->timeStepIDF=copy.timeStepIDF;
+	w->pid=copy.pid;
+	w->tStart=getWallClockTime();
+	return w;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+/// Start EnergyPlus processes until the pool has enough of them for an input.
+///
+///\param _c The FMU instance.
+///\param key The FMU, resource location and run period.
+////////////////////////////////////////////////////////////////////////////////////
+static void epPool_fill(ModelInstance *_c, const char *key)
+{
+	EpPoolWorker *w;
+	EpPoolWorker **pw;
+	int num=0;
+	int total=0;
+	const int size=epPool_getSize();
+	const int max=epPool_getMax(size);
+
+	pthread_mutex_lock(&epPoolLock);
+	for (w=epPoolHead; w!=NULL; w=w->next) {
+		if (strcmp(w->key, key)==0) num++;
+		total++;
+	}
+	pthread_mutex_unlock(&epPoolLock);
+
+	for (; num<size; num++) {
+		// make room by stopping the oldest process of another input
+		if (total>=max) {
+			w=NULL;
+			pthread_mutex_lock(&epPoolLock);
+			for (pw=&epPoolHead; *pw!=NULL; pw=&(*pw)->next) {
+				if (strcmp((*pw)->key, key)!=0) {
+					w=*pw;
+					*pw=w->next;
+					break;
+				}
+			}
+			pthread_mutex_unlock(&epPoolLock);
+			if (w==NULL) {
+				return;
+			}
+			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+				"fmi2EnterInitializationMode: Stopped EnergyPlus process %d of the pool, which runs another input.\n",
+				(int)w->pid);
+			epPool_freeWorker(w);
+			total--;
 		}
-		_c->functions->freeMemory(cmdstrEXE);
-#endif
-		tmpstr = (char *)_c->functions->allocateMemory(strlen(cmdstr) + strlen(_c->wea_file) +
-			strlen(_c->idd_file) + strlen(_c->in_file) + strlen(tStartFMUstr) + strlen(tStopFMUstr) + 50, sizeof(char));
-		sprintf(tmpstr, "%s -w %s -b %s -e %s %s %s", cmdstr, _c->wea_file, tStartFMUstr, tStopFMUstr, _c->idd_file, _c->in_file);
-		retVal = system(tmpstr);
+		w=epPool_start(_c, key);
+		if (w==NULL) {
+			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Warning, "warning",
+				"fmi2EnterInitializationMode: Could not start an EnergyPlus process for the pool.\n");
+			return;
+		}
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+			"fmi2EnterInitializationMode: Started EnergyPlus process %d for the pool in %s.\n",
+			(int)w->pid, w->dir);
+		pthread_mutex_lock(&epPoolLock);
+		for (pw=&epPoolHead; *pw!=NULL; pw=&(*pw)->next);
+		*pw=w;
+		pthread_mutex_unlock(&epPoolLock);
+		total++;
 	}
-	else{
-		cmdstr = (char *)_c->functions->allocateMemory(strlen(_c->fmuResourceLocation) + strlen(command) + 10, sizeof(char));
-		sprintf(cmdstr, "%s%s", _c->fmuResourceLocation, command);
-#ifndef _MSC_VER
-		cmdstrEXE = (char *)_c->functions->allocateMemory(strlen(cmdstr) + 10, sizeof(char));
-		sprintf(cmdstrEXE, "%s %s", "chmod +x", cmdstr);
-		retVal = system(cmdstrEXE);
-		if (retVal != 0){
-			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not"
-				" make preprocessor executable. Initialization of %s failed.\n",
-				_c->instanceName);
-			return fmi2Error;
+}
+
+////////////////////////////////////////////////////////////////////////////////////
+/// Claim an EnergyPlus process of the pool that runs the input of an FMU instance.
+///
+/// The folder of the process replaces the output folder of the instance,
+/// and the instance takes over the sockets and the process.
+///
+///\param _c The FMU instance.
+///\param key The FMU, resource location and run period.
+///\return 0 if a process was claimed, 1 if EnergyPlus must be started.
+////////////////////////////////////////////////////////////////////////////////////
+static int epPool_claim(ModelInstance *_c, const char *key)
+{
+	EpPoolWorker *w;
+	EpPoolWorker **pw;
+	char *src;
+	char *dst;
+	int status;
+	int retVal;
+
+	for (;;) {
+		w=NULL;
+		pthread_mutex_lock(&epPoolLock);
+		for (pw=&epPoolHead; *pw!=NULL; pw=&(*pw)->next) {
+			if (strcmp((*pw)->key, key)==0) {
+				w=*pw;
+				*pw=w->next;
+				break;
+			}
 		}
-		_c->functions->freeMemory(cmdstrEXE);
+		pthread_mutex_unlock(&epPoolLock);
+		if (w==NULL) {
+			return 1;
+		}
+		// skip processes that stopped, for example because of an error in the input
+		if (waitpid(w->pid, &status, WNOHANG)==0) {
+			break;
+		}
+		w->pid=0;
+		epPool_freeWorker(w);
+	}
+
+	// move the folder of the process, which remains its working directory
+	src=epPool_trimPath(w->dir);
+	dst=epPool_trimPath(_c->fmuOutput);
+	retVal=(src==NULL || dst==NULL);
+	if (retVal==0) {
+		removeDir(dst);
+		retVal=rename(src, dst);
+		if (retVal!=0) {
+			// restore the output folder, as EnergyPlus will be started
+			createDir(dst);
+			copy_var_cfg(_c);
+		}
+	}
+	free(src);
+	free(dst);
+	if (retVal!=0) {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Warning, "warning",
+			"fmi2EnterInitializationMode: Could not move the folder %s of the EnergyPlus process"
+			" of the pool to the output folder %s.\n", w->dir, _c->fmuOutput);
+		epPool_freeWorker(w);
+		return 1;
+	}
+
+	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+		"fmi2EnterInitializationMode: Claimed EnergyPlus process %d of the pool, started %.3f s ago.\n",
+		(int)w->pid, getWallClockTime() - w->tStart);
+	_c->sockfd=w->sockfd;
+	_c->unixsockfd=w->unixsockfd;
+	_c->con=w->con;
+	_c->timeStepIDF=w->timeStepIDF;
+	_c->pid=w->pid;
+	free(w->dir);
+	free(w->key);
+	free(w);
+	return 0;
+}
+#else
+// The pool is not used on Windows, see above.
+static int epPool_getSize(void)
+{
+	return 0;
+}
+
+static void epPool_fill(ModelInstance *_c, const char *key)
+{
+}
+
+static int epPool_claim(ModelInstance *_c, const char *key)
+{
+	return 1;
+}
+#endif
+
+////////////////////////////////////////////////////////////////
+///  This method is used to enter initialization in the FMU
+///
+///\param c The FMU instance.
+///\return fmi2OK if no error occurred.
+////////////////////////////////////////////////////////////////
+DllExport fmi2Status fmi2EnterInitializationMode(fmi2Component c)
+{
+	int retVal;
+	ModelInstance* _c=(ModelInstance *)c;
+	char *tmpstr;
+	char *poolKey=NULL;
+	int poolSize;
+	int poolKeyLen;
+	struct stat stat_p;
+
+#ifdef _MSC_VER
+	WORD wVersionRequested=MAKEWORD(2,2);
+	WSADATA wsaData;
 #endif
-		tmpstr = (char *)_c->functions->allocateMemory(strlen(cmdstr) +
-			strlen(_c->idd_file) + strlen(_c->in_file) + strlen(tStartFMUstr) + strlen(tStopFMUstr) + 50, sizeof(char));
-		sprintf(tmpstr, "%s -b %s -e %s %s %s", cmdstr, tStartFMUstr, tStopFMUstr, _c->idd_file, _c->in_file);
-		retVal = system(tmpstr);
+
+	// Check if setup experiment has been called
+	if (_c->setupExperiment != 1) {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"fmi2EnterInitializationMode: fmi2SetupExperiment must be called at least once prior "
+			" to calling fmi2EnterInitializationMode\n");
+		return fmi2Error;
 	}
-	_c->functions->freeMemory(cmdstr);
-	_c->functions->freeMemory(tmpstr);
+
+	// reset flag for indicating that fmi2SetupExperiment() has been called.
+	_c->setupExperiment = 0;
+	phaseTimer_begin(&_c->timer);
+
+	// initialize structure variables
+	_c->firstCallGetReal      =1;
+	//_c->firstCallSetReal      =1;
+	_c->firstCallDoStep       =1;
+	_c->firstCallFree         =1;
+	_c->firstCallTerm         =1;
+	_c->firstCallRes          =1;
+	_c->flaGetRealCall        =0;
+	_c->flaGetRea=0;
+	_c->flaWri=0;
+	_c->flaRea=0;
+	// a failed asynchronous step of a previous run does not fail this one
+	_c->stepStatus=fmi2OK;
+	_c->wea_file = NULL;
+	_c->in_file = NULL;
+	_c->in_file = NULL;
+	_c->getCounter=0;
+	_c->setCounter=0;
+	_c->readReady=0;
+	_c->writeReady=0;
+	_c->numInVar =-1;
+	_c->numOutVar=-1;
+
+	// check the output folder, in which all files of the instance are written
+	// with absolute paths, as the working directory is shared by all threads
+	if (stat(_c->fmuOutput, &stat_p)!=0){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"fmi2EnterInitializationMode: The path to the output folder %s is not valid.\n", _c->fmuOutput);
+		return fmi2Error;
+	}
+	///////////////////////////////////////////////////////////////////////////////////
+	// create the socket server
+
+#ifdef _MSC_VER
+	// initialize winsock  /************* Windows specific code ********/
+	if (WSAStartup(wVersionRequested, &wsaData)!=0)
+	{
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName , fmi2Error,
+			"error", "fmi2EnterInitializationMode: WSAStartup failed with error %ld.\n", WSAGetLastError());
+		WSACleanup();
+		return fmi2Error;
+	}
+	// check if the version is supported
+	if (LOBYTE(wsaData.wVersion)!=2 || HIBYTE(wsaData.wVersion)!=2 )
+	{
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error,
+			"error", "fmi2EnterInitializationMode: Could not find a usable WinSock DLL for WinSock version %u.%u.\n",
+			LOBYTE(wsaData.wVersion), HIBYTE(wsaData.		wVersion));
+		WSACleanup();
+		return fmi2Error;
+	}
+#endif  /************* End of Windows specific code *******/
+
+	// Initialize the number of inputs and output variables
+	_c->numInVar = 0;
+	_c->numOutVar = 0;
+
+	// Get the number of inputs and output variables
+	getNumInputOutputVariablesInFMU(_c->md, &_c->numInVar, &_c->numOutVar);
+
+	// the vectors are kept by fmi2Reset
+	if (_c->numInVar!=0 && _c->inVec==NULL)
+	{
+		// initialize the input vectors
+		_c->inVec=(fmi2Real*)_c->functions->allocateMemory(_c->numInVar, sizeof(fmi2Real));
+	}
+	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",  "fmi2EnterInitializationMode: The number of input variables is %d.\n", _c->numInVar);
+
+	// get the number of output variables of the FMU
+	if (_c->numOutVar!=0 && _c->outVec==NULL)
+	{
+		// initialize the output vector
+		_c->outVec=(fmi2Real*)_c->functions->allocateMemory(_c->numOutVar, sizeof(fmi2Real));
+	}
+	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",  "fmi2EnterInitializationMode: The number of output variables is %d.\n", _c->numOutVar);
+
+	// compile the value reference lookup tables used by fmi2SetReal and fmi2GetReal
+	vrTable_free(&_c->inVrTab, _c->functions);
+	vrTable_free(&_c->outVrTab, _c->functions);
+	if (vrTable_build(&_c->inVrTab, _c->md, enu_input, VR_INPUT_BASE, _c->numInVar, _c->functions) != 0 ||
+		vrTable_build(&_c->outVrTab, _c->md, enu_output, VR_OUTPUT_BASE, _c->numOutVar, _c->functions) != 0){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"fmi2EnterInitializationMode: Could not build the value reference lookup tables of FMU instance %s."
+			" Please check the value references in the model description file.\n", _c->instanceName);
+		return fmi2Error;
+	}
+
+	if ( (_c->numInVar + _c->numOutVar)==0){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"fmi2EnterInitializationMode: The FMU instance %s has no input and output variables. Please check the model description file.\n",
+			_c->instanceName);
+		return fmi2Error;
+	}
+
+	// create the input and weather file for the run
+	// Need to see how we will parste the start and stop time so
+	// they become strings and can be used by str when calling the system command.
+
+	// get input file from the folder. There must be only one input file in the folder.
+	retVal = getResFile(_c, ".idf");
+	if (retVal != 0){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not get"
+			" the .idf input file. Instantiation of %s failed.\n",
+			_c->instanceName);
+		return fmi2Error;
+	}
+	// get the weather file from the folder. there must be only one weather file in the folder.
+	retVal = getResFile(_c, ".epw");
+	if (retVal != 0){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not"
+			" get the .epw weather file. Instantiation of %s failed.\n",
+			_c->instanceName);
+		return fmi2Error;
+	}
+	// get the idd file from the folder. there must be only one idd file in the folder.
+	retVal = getResFile(_c, ".idd");
 	if (retVal != 0){
 		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not"
-			" create the input and weather file. Initialization of %s failed.\n",
+			" get the .idd dictionary file. Instantiation of %s failed.\n",
 			_c->instanceName);
 		return fmi2Error;
 	}
+	phaseTimer_end(&_c->timer, "resource files");
+
+	// Check the validity of the FMU start and stop time
+	if (modulusOp((_c->tStopFMU - _c->tStartFMU), 86400) != 0){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: The delta"
+			" between the FMU stop time %f and the FMU start time %f must be a multiple of 86400."
+			" This is required by EnergyPlus. The current delta is %f. Instantiation of %s failed.\n",
+			_c->tStopFMU, _c->tStartFMU, _c->tStopFMU - _c->tStartFMU, _c->instanceName);
+		return fmi2Error;
+	}
 
 	// rename found idf to have the correct name.
 	tmpstr = (char *)_c->functions->allocateMemory(strlen(_c->mID) + strlen(".idf") + 1, sizeof(char));
@@ -1270,47 +1803,53 @@ DllExport fmi2Status fmi2EnterInitializationMode(fmi2Component c)
 	strcpy(_c->in_file_name, tmpstr);
 	// free tmpstr
 	_c->functions->freeMemory(tmpstr);
-	retVal = rename(FRUNINFILE, _c->in_file_name);
-	if (retVal != 0){
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error", "fmi2EnterInitializationMode: Could not"
-			" rename the temporary input file. Initialization of %s failed.\n",
-			_c->instanceName);
-		return fmi2Error;
-	}
 
-	if((fp=fopen(FTIMESTEP, "r")) !=NULL) {
-		retVal=fscanf(fp, "%d", &(_c->timeStepIDF));
-		fclose (fp);
-		// check if the timeStepIDF is null to avoid division by zero
-		if (_c->timeStepIDF==0){
-			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
-				"fmi2EnterInitializationMode: The time step in IDF cannot be null.\n");
-			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",   "fmi2EnterInitializationMode: Time step in IDF is null.\n");
+	// claim an EnergyPlus process of the pool that runs the same input,
+	// or prepare the run and start EnergyPlus
+	poolSize=epPool_getSize();
+	if (poolSize>0) {
+		poolKeyLen=snprintf(NULL, 0, "%s|%s|%f|%f", _c->mGUID, _c->fmuResourceLocation, _c->tStartFMU, _c->tStopFMU);
+		poolKey=(char *)_c->functions->allocateMemory(poolKeyLen + 1, sizeof(char));
+		snprintf(poolKey, poolKeyLen + 1, "%s|%s|%f|%f", _c->mGUID, _c->fmuResourceLocation, _c->tStartFMU, _c->tStopFMU);
+	}
+	if (poolSize==0 || epPool_claim(_c, poolKey)!=0) {
+		if (launch_sim(_c)!=fmi2OK) {
+			if (poolKey!=NULL) _c->functions->freeMemory(poolKey);
 			return fmi2Error;
 		}
 	}
-	else
-	{
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
-			"fmi2EnterInitializationMode: A valid time step could not be determined.\n");
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",   "fmi2EnterInitializationMode: Can't read time step file.\n");
-		return fmi2Error;
+	else {
+		phaseTimer_end(&_c->timer, "pool claim");
 	}
 
-#ifndef _MSC_VER
-	umask(process_mask);
-#endif
-	// start the simulation
-	retVal=start_sim(_c);
-	_c->newsockfd=accept(_c->sockfd, NULL, NULL);
+	// accept the connection of EnergyPlus, which is established after the warm-up
+	_c->con.sockfd=acceptfirstFMU(&(_c->sockfd), &(_c->unixsockfd));
+	phaseTimer_end(&_c->timer, "accept wait");
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",  "fmi2EnterInitializationMode: The connection has been accepted.\n");
-	// check whether the simulation could start successfully
-	if  (retVal !=0) {
-		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error,
-			"error", "fmi2EnterInitializationMode: The FMU instance could %s not be initialized. "
-			"EnergyPlus can't start . Check if EnergyPlus is installed and on the system path.\n",
-			_c->instanceName);
-		return fmi2Error;
+	// the Unix domain socket is no longer needed to accept connections
+	if (_c->unixsockfd != INVALID_SOCKET) {
+		closeipcFMU(&(_c->unixsockfd));
+		_c->unixsockfd=INVALID_SOCKET;
+		tmpstr=getOutputPath(_c, SOCKUNIX);
+		remove(tmpstr);
+		_c->functions->freeMemory(tmpstr);
+	}
+	// EnergyPlus attaches to the shared memory before it connects,
+	// hence the region can be used, or released, once it connected.
+	shmunlinkFMU(&_c->con.shm);
+	if (shmisattachedFMU(&_c->con.shm)) {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+			"fmi2EnterInitializationMode: EnergyPlus exchanges data through shared memory.\n");
+	}
+	else {
+		shmcloseFMU(&_c->con.shm);
+	}
+	// configure the connection for one small message per time step and direction
+	if (_c->con.shm.base == NULL && setlowlatencysocketFMU(&(_c->con.sockfd), getrequiredbufferlengthFMU(
+		_c->numInVar > _c->numOutVar ? _c->numInVar : _c->numOutVar, 0, 0)) != 0) {
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Warning, "warning",
+			"fmi2EnterInitializationMode: Could not configure the socket for low latency."
+			" The data exchange may be slower.\n");
 	}
 
 	// reset firstCallIni
@@ -1318,14 +1857,14 @@ DllExport fmi2Status fmi2EnterInitializationMode(fmi2Component c)
 	{
 		_c->firstCallIni=0;
 	}
+
+	// start EnergyPlus processes for the next instances with the same input
+	if (poolSize>0) {
+		epPool_fill(_c, poolKey);
+		_c->functions->freeMemory(poolKey);
+		phaseTimer_end(&_c->timer, "pool fill");
+	}
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",  "fmi2EnterInitializationMode: Slave %s is initialized.\n", _c->instanceName);
-	// reset the current working directory. This is particularly important for Dymola
-	// otherwise Dymola will write results at wrong place
-#ifdef _MSC_VER
-	retVal=_chdir(_c->cwd);
-#else
-	retVal=chdir(_c->cwd);
-#endif
 	return fmi2OK;
 }
 
@@ -1340,6 +1879,87 @@ DllExport fmi2Status fmi2ExitInitializationMode(fmi2Component c)
 	return fmi2OK;
 }
 
+////////////////////////////////////////////////////////////////
+/// Reads the outputs of EnergyPlus at the current communication point.
+///
+/// The first read of an instance ends its startup, whose phases
+/// are then reported if the timer is enabled.
+///
+///\param _c The FMU instance.
+///\return The return value of readfromsocketFMU.
+////////////////////////////////////////////////////////////////
+static int readOutputs(ModelInstance *_c)
+{
+	int retVal;
+	char *tmpstr;
+	const int report=_c->timer.enabled;
+
+	// time only the exchange, not the time the master took to call it
+	phaseTimer_begin(&_c->timer);
+	retVal=readfromsocketFMU(&(_c->con), &(_c->flaRea),
+		&(_c->numOutVar), &zI, &zI, &(_c->simTimRec),
+		_c->outVec, NULL, NULL);
+	if (report) {
+		phaseTimer_end(&_c->timer, "first exchange");
+		phaseTimer_log(&_c->timer, _c->functions, _c->instanceName);
+		tmpstr=getOutputPath(_c, PHASETIMES);
+		if (phaseTimer_writeJson(&_c->timer, tmpstr, _c->instanceName) != 0) {
+			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Warning, "warning",
+				"Could not write the time of the startup phases to %s.\n", tmpstr);
+		}
+		_c->functions->freeMemory(tmpstr);
+		// the startup is reported once
+		_c->timer.enabled=0;
+	}
+	return retVal;
+}
+
+////////////////////////////////////////////////////////////////
+///  This method exchanges the data of a communication step in the
+///  thread of the FMU instance, while fmi2DoStep returned fmi2Pending
+///
+///  Unlike the synchronous fmi2DoStep, the outputs at the end of the
+///  step are read as well, so that EnergyPlus computes the step while
+///  the master does other work. fmi2GetReal returns them without
+///  reading from the socket.
+///
+///\param arg The FMU instance.
+////////////////////////////////////////////////////////////////
+static void doStepAsync(void *arg)
+{
+	ModelInstance* _c=(ModelInstance *)arg;
+	int retVal=0;
+	if (_c->flaGetRealCall==0){
+		retVal=readOutputs(_c);
+	}
+	if (retVal==0 && writetosocketFMU(&(_c->con), &(_c->flaWri),
+		&_c->numInVar, &zI, &zI, &(_c->simTimSen),
+		_c->inVec, NULL, NULL) < 0){
+		retVal=-1;
+	}
+	if (retVal==0){
+		retVal=readOutputs(_c);
+	}
+	// the outputs have been read, hence fmi2GetReal and fmi2DoStep
+	// do not read them again
+	_c->flaGetRealCall=1;
+	_c->flaGetRea=0;
+	_c->firstCallGetReal=0;
+	_c->stepStatus=(retVal==0 && _c->flaRea==0) ? fmi2OK : fmi2Error;
+}
+
+////////////////////////////////////////////////////////////////
+///  This method notifies the master that the asynchronous
+///  communication step finished
+///
+///\param arg The FMU instance.
+////////////////////////////////////////////////////////////////
+static void doStepAsyncFinished(void *arg)
+{
+	ModelInstance* _c=(ModelInstance *)arg;
+	_c->functions->stepFinished(_c->componentEnvironment, _c->stepStatus);
+}
+
 ////////////////////////////////////////////////////////////////
 ///  This method is used to do the time stepping the FMU
 ///
@@ -1354,6 +1974,10 @@ DllExport fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPo
 {
 	ModelInstance* _c=(ModelInstance *)c;
 	int retVal;
+	int isPending=0;
+
+	// wait for the previous step if it was done asynchronously
+	asyncWorker_wait(&_c->worker);
 
 	// get current communication point
 	_c->curComm=currentCommunicationPoint;
@@ -1459,15 +2083,32 @@ DllExport fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPo
 		(_c->firstCallDoStep==0)
 		&& _c->curComm <=(_c->tStopFMU -
 		_c->communicationStepSize)) {
-			if (_c->flaWri !=1){
+			// start the thread for the asynchronous steps on the first step
+			if (_c->flaWri !=1 && _c->isAsync && !_c->worker.isRunning){
+				if (asyncWorker_start(&_c->worker, doStepAsync,
+					doStepAsyncFinished, _c) != 0){
+					_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Warning,
+						"Warning", "fmi2DoStep: Could not start the thread for asynchronous steps."
+						" The steps will be done synchronously.\n");
+					_c->isAsync=0;
+				}
+			}
+			if (_c->flaWri !=1 && _c->isAsync){
+				// the worker owns the socket until the step finished
+				if (asyncWorker_post(&_c->worker) != 0){
+					_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error,
+						"Error", "fmi2DoStep: Could not start the asynchronous step.\n");
+					return fmi2Error;
+				}
+				isPending=1;
+			}
+			else if (_c->flaWri !=1){
 				_c->flaGetRea=1;
 				if (_c->flaGetRealCall==0)
 				{
-					retVal=readfromsocketFMU(&(_c->newsockfd), &(_c->flaRea),
-						&(_c->numOutVar), &zI, &zI, &(_c->simTimRec),
-						_c->outVec, NULL, NULL);
+					retVal=readOutputs(_c);
 				}
-				retVal=writetosocketFMU(&(_c->newsockfd), &(_c->flaWri),
+				retVal=writetosocketFMU(&(_c->con), &(_c->flaWri),
 					&_c->numInVar, &zI, &zI, &(_c->simTimSen),
 					_c->inVec, NULL, NULL);
 
@@ -1490,6 +2131,163 @@ DllExport fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPo
 	{
 		_c->firstCallDoStep=0;
 	}
+	return isPending ? fmi2Pending : fmi2OK;
+}
+
+////////////////////////////////////////////////////////////////
+///  This method is used to do several communication steps in one call
+///
+///  The method is an extension of the FMI, which is announced in the
+///  VendorAnnotations of modelDescription.xml. Masters that know the
+///  inputs of several steps in advance, such as measured schedules,
+///  can call it instead of fmi2SetReal, fmi2DoStep and fmi2GetReal
+///  for each step. If EnergyPlus can read batches, the inputs of all
+///  steps are sent in one message, and the outputs are read in one
+///  message. Otherwise, the steps are exchanged one at a time.
+///
+///\param c The FMU instance.
+///\param currentCommunicationPoint The communication point of the first step.
+///\param communicationStepSize The communication step size of each step.
+///\param nSteps The number of steps.
+///\param vrIn The value references of the inputs.
+///\param nvrIn The number of inputs.
+///\param valueIn The inputs, one row of \c nvrIn values for each step.
+///                Inputs that are not set keep the value of the previous step.
+///\param vrOut The value references of the outputs.
+///\param nvrOut The number of outputs.
+///\param valueOut The outputs at the end of each step, one row of
+///                 \c nvrOut values for each step.
+///\return fmi2OK if no error occurred.
+////////////////////////////////////////////////////////////////
+DllExport fmi2Status EnergyPlusToFMU_doSteps(fmi2Component c, fmi2Real currentCommunicationPoint,
+	fmi2Real communicationStepSize, size_t nSteps,
+	const fmi2ValueReference vrIn[], size_t nvrIn, const fmi2Real valueIn[],
+	const fmi2ValueReference vrOut[], size_t nvrOut, fmi2Real valueOut[])
+{
+	ModelInstance* _c=(ModelInstance *)c;
+	fmi2Real *inBat, *outBat, *simTimBat, *simTimRea;
+	size_t i, k, batLen;
+	int retVal, slot, nStepRea, nDblRea;
+	const int fla=0;
+
+	asyncWorker_wait(&_c->worker);
+	if (nSteps==0){
+		return fmi2OK;
+	}
+	if (_c->firstCallIni || _c->flaWri==1){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"EnergyPlusToFMU_doSteps: The FMU is not initialized or has been terminated.\n");
+		return fmi2Error;
+	}
+	// check the communication points as fmi2DoStep does for each step
+	if ((_c->firstCallDoStep && fabs(currentCommunicationPoint - _c->tStartFMU) > 1e-10)
+		|| (!_c->firstCallDoStep && fabs(currentCommunicationPoint - _c->nexComm) > 1e-10)){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"EnergyPlusToFMU_doSteps: Current communication point: %f is not the next communication point.\n",
+			currentCommunicationPoint);
+		return fmi2Error;
+	}
+	if (fabs(communicationStepSize - (3600/_c->timeStepIDF)) > 1e-10){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"EnergyPlusToFMU_doSteps: CommunicationStepSize: %f is different from time step: %d in input file.\n",
+			communicationStepSize, _c->timeStepIDF);
+		return fmi2Error;
+	}
+	if (currentCommunicationPoint + nSteps*communicationStepSize > _c->tStopFMU + 1e-10){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"EnergyPlusToFMU_doSteps: Current communication point: %f + %u steps of %f is larger than "
+			"end of simulation time: %f.\n",
+			currentCommunicationPoint, (unsigned int)nSteps, communicationStepSize, _c->tStopFMU);
+		return fmi2Error;
+	}
+
+	// reserve the values of all steps, which are kept for the next call
+	batLen=nSteps*(_c->numInVar + _c->numOutVar + 2);
+	if (_c->batBufLen < batLen){
+		if (_c->batBuf != NULL) _c->functions->freeMemory(_c->batBuf);
+		_c->batBuf=(fmi2Real*)_c->functions->allocateMemory(batLen, sizeof(fmi2Real));
+		_c->batBufLen=(_c->batBuf == NULL) ? 0 : batLen;
+		if (_c->batBuf == NULL){
+			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+				"EnergyPlusToFMU_doSteps: Could not allocate memory for %u steps.\n", (unsigned int)nSteps);
+			return fmi2Error;
+		}
+	}
+	inBat=_c->batBuf;
+	outBat=inBat + nSteps*_c->numInVar;
+	simTimBat=outBat + nSteps*_c->numOutVar;
+	simTimRea=simTimBat + nSteps;
+
+	// read the outputs at the current communication point if
+	// fmi2GetReal did not read them, as fmi2DoStep does
+	if (_c->flaGetRealCall==0){
+		retVal=readOutputs(_c);
+		// do not write the batch if EnergyPlus failed or finished
+		if (retVal!=0 || _c->flaRea!=0){
+			_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+				"EnergyPlusToFMU_doSteps: Could not read the outputs of EnergyPlus at time %f."
+				" The return value is %d and the flag is %d.\n",
+				currentCommunicationPoint, retVal, _c->flaRea);
+			return fmi2Error;
+		}
+	}
+	// assemble the inputs of each step
+	for (k=0; k<nSteps; k++){
+		fmi2Real *inRow=inBat + k*_c->numInVar;
+		memcpy(inRow, k==0 ? _c->inVec : inRow - _c->numInVar, _c->numInVar*sizeof(fmi2Real));
+		for (i=0; i<nvrIn; i++){
+			slot=vrTable_getSlot(&_c->inVrTab, vrIn[i]);
+			if (slot!=VR_NOT_FOUND){
+				inRow[slot]=valueIn[k*nvrIn + i];
+			}
+		}
+		simTimBat[k]=currentCommunicationPoint + k*communicationStepSize;
+	}
+	retVal=exchangebatchwithsocketFMU(&(_c->con), (int)nSteps, &fla, &(_c->numInVar),
+		simTimBat, inBat, _c->numOutVar, &nStepRea, &(_c->flaRea), &nDblRea, simTimRea, outBat);
+	// the rows hold numOutVar values, hence shorter rows are not used
+	if (nStepRea > 0 && nDblRea!=_c->numOutVar){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"EnergyPlusToFMU_doSteps: EnergyPlus sent %d outputs, but the FMU has %d.\n",
+			nDblRea, _c->numOutVar);
+		return fmi2Error;
+	}
+
+	// the outputs at the end of the last step read are the current outputs
+	if (nStepRea > 0){
+		memcpy(_c->inVec, inBat + (nStepRea-1)*_c->numInVar, _c->numInVar*sizeof(fmi2Real));
+		memcpy(_c->outVec, outBat + (nStepRea-1)*_c->numOutVar, _c->numOutVar*sizeof(fmi2Real));
+		_c->simTimRec=simTimRea[nStepRea-1];
+		_c->curComm=simTimBat[nStepRea-1];
+		_c->simTimSen=_c->curComm;
+		_c->communicationStepSize=communicationStepSize;
+		_c->nexComm=_c->curComm + communicationStepSize;
+		_c->firstCallDoStep=0;
+		_c->firstCallGetReal=0;
+	}
+	for (k=0; k<(size_t)nStepRea; k++){
+		for (i=0; i<nvrOut; i++){
+			slot=vrTable_getSlot(&_c->outVrTab, vrOut[i]);
+			if (slot!=VR_NOT_FOUND){
+				valueOut[k*nvrOut + i]=outBat[k*_c->numOutVar + slot];
+			}
+		}
+	}
+	// the outputs have been read, hence fmi2GetReal and fmi2DoStep
+	// do not read them again
+	_c->flaGetRealCall=1;
+	_c->flaGetRea=0;
+	_c->readReady=0;
+	_c->writeReady=0;
+	_c->setCounter=0;
+	_c->getCounter=0;
+
+	if (retVal!=0 || nStepRea!=(int)nSteps){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "error",
+			"EnergyPlusToFMU_doSteps: EnergyPlus completed %d of %u steps with flag %d.\n",
+			nStepRea, (unsigned int)nSteps, _c->flaRea);
+		return fmi2Error;
+	}
 	return fmi2OK;
 }
 
@@ -1538,23 +2336,21 @@ DllExport fmi2Status fmi2SetupExperiment(fmi2Component c, fmi2Boolean toleranceD
 DllExport fmi2Status fmi2Terminate(fmi2Component c)
 {
 		ModelInstance* _c=(ModelInstance *)c;
+		asyncWorker_wait(&_c->worker);
 		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK,
 		"ok", "fmi2Terminate: fmiFreeInstanceSlave must be called to free the FMU instance.\n");
 		return fmi2OK;
 }
 
 ////////////////////////////////////////////////////////////////
-///  This method is used to reset the FMU instance
+///  This method is used to reset the FMU instance, see fmi2Reset
 ///
 ///\param c The FMU instance.
-///\return fmi2Warning if no error occurred.
+///\return fmi2OK if no error occurred.
 ////////////////////////////////////////////////////////////////
 DllExport fmi2Status fm2ResetSlave(fmi2Component c)
 {
-	ModelInstance* _c=(ModelInstance *)c;
-	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Warning, "Warning",
-		"fm2ResetSlave: fm2ResetSlave:: is not provided.\n");
-	return fmi2OK;
+	return fmi2Reset(c);
 }
 
 ////////////////////////////////////////////////////////////////
@@ -1566,50 +2362,17 @@ DllExport void fmi2FreeInstance(fmi2Component c)
 {
 	if (c!=NULL){
 		ModelInstance* _c=(ModelInstance *)c;
-		int retVal;
-
-#ifndef _MSC_VER
-		int status;
-#endif
-		// change the directory to make sure that FMUs are not overwritten
-#ifdef _MSC_VER
-		retVal=_chdir(_c->fmuOutput);
-#else
-		retVal=chdir(_c->fmuOutput);
-#endif
 		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK,
 		"ok", "fmi2FreeInstance: The function fmi2FreeInstance of instance %s is executed.\n",
 		_c->instanceName);
-		// send end of simulation flag
-		_c->flaWri=1;
-		_c->flaRea=1;
-		retVal=exchangedoubleswithsocketFMUex (&(_c->newsockfd), &(_c->flaWri),
-			&(_c->flaRea), &(_c->numOutVar), &(_c->numInVar),
-			&(_c->simTimRec), _c->outVec, &(_c->simTimSen),
-			_c->inVec);
-		// close socket
-		closeipcFMU(&(_c->sockfd));
-		closeipcFMU(&(_c->newsockfd));
+		// stop EnergyPlus
+		stop_sim(_c);
 		// clean-up temporary files
-		findFileDelete();
-#ifdef _MSC_VER
-		// wait for object to terminate
-		WaitForSingleObject (_c->pid, INFINITE);
-		TerminateProcess(_c->pid, 0);
-#else
-		waitpid (_c->pid, &status, 0);
-#endif
+		findFileDelete(_c);
 
 #ifdef _MSC_VER
 		// clean-up winsock
 		WSACleanup();
-#endif
-		// reset the current working directory. This is particularly important for Dymola
-		// otherwise Dymola will write results at wrong place
-#ifdef _MSC_VER
-		retVal=_chdir(_c->cwd);
-#else
-		retVal=chdir(_c->cwd);
 #endif
 		// FIXME: Freeing the FMU instance seems to cause
 		// segmentation fault in Dymola 2016, thus
@@ -1635,31 +2398,22 @@ DllExport void fmi2FreeInstance(fmi2Component c)
 DllExport fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[])
 {
 	ModelInstance* _c=(ModelInstance *)c;
+	// the inputs are sent by a pending asynchronous step
+	asyncWorker_wait(&_c->worker);
 	// to prevent the fmi2SetReal to be called before the FMU is initialized
 	if (_c->firstCallIni==0)
 	{
-		// fmi2ValueReference to check for input variable
-		fmi2ValueReference vrTemp;
-		//ScalarVariable** vars;
-		int i, k;
-		int n = getScalarVariableSize(_c->md);
-
-		//fixme
-		//vars=_c->md->modelVariables;
+		// slot of the input variable in inVec
+		int slot;
+		size_t i;
+
 		if (!_c->writeReady){
 			for(i=0; i<nvr; i++)
 			{
-				for (k=0; k<n; k++) {
-					// fixme
-					//ScalarVariable* svTemp=vars [k];
-					ScalarVariable *svTemp = getScalarVariable(_c->md, k);
-					//if (getAlias(svTemp)!=enu_noAlias) continue;
-					if (getCausality(svTemp) !=enu_input) continue;
-					vrTemp=getValueReference(svTemp);
-					if (vrTemp==vr[i]){
-						_c->inVec[vr[i]-1]=value[i];
-						_c->setCounter++;
-					}
+				slot=vrTable_getSlot(&_c->inVrTab, vr[i]);
+				if (slot!=VR_NOT_FOUND){
+					_c->inVec[slot]=value[i];
+					_c->setCounter++;
 				}
 			}
 			if (_c->setCounter==_c->numInVar)
@@ -1751,22 +2505,24 @@ DllExport fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[],
 {
 	ModelInstance* _c=(ModelInstance *)c;
 	int retVal;
+	// the outputs are read by a pending asynchronous step
+	asyncWorker_wait(&_c->worker);
+	if (_c->stepStatus != fmi2OK){
+		_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Error, "Error",
+			"fmi2GetReal: The asynchronous step failed. Outputs are not available.\n");
+		return fmi2Error;
+	}
 	// to prevent the fmi2GetReal to be called before the FMU is initialized
 	if (_c->firstCallIni==0){
-		fmi2ValueReference vrTemp;
-		//ScalarVariable** vars;
-		int i, k;
-		int n = getScalarVariableSize(_c->md);
-		//fixme
-		//vars=_c->md->modelVariables;
+		// slot of the output variable in outVec
+		int slot;
+		size_t i;
 		_c->flaGetRealCall=1;
 
 		if (_c->firstCallGetReal||((_c->firstCallGetReal==0)
 			&& (_c->flaGetRea)))  {
 				// read the values from the server
-				retVal=readfromsocketFMU(&(_c->newsockfd), &(_c->flaRea),
-					&(_c->numOutVar), &zI, &zI, &(_c->simTimRec),
-					_c->outVec, NULL, NULL);
+				retVal=readOutputs(_c);
 				// reset flaGetRea
 				_c->flaGetRea=0;
 		}
@@ -1774,17 +2530,10 @@ DllExport fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[],
 		{
 			for(i=0; i<nvr; i++)
 			{
-				for (k=0; k<n; k++) {
-					// fixme
-					//ScalarVariable* svTemp=vars [k];
-					ScalarVariable *svTemp = getScalarVariable(_c->md, k);
-					//if (getAlias(svTemp)!=enu_noAlias) continue;
-					if (getCausality(svTemp) !=enu_output) continue;
-					vrTemp=getValueReference(svTemp);
-					if (vrTemp==vr[i]){
-						value[i]=_c->outVec[vr[i]-100001];
-						_c->getCounter++;
-					}
+				slot=vrTable_getSlot(&_c->outVrTab, vr[i]);
+				if (slot!=VR_NOT_FOUND){
+					value[i]=_c->outVec[slot];
+					_c->getCounter++;
 				}
 			}
 			if (_c->getCounter==_c->numOutVar)
@@ -1968,15 +2717,54 @@ DllExport fmi2Status fmi2CancelStep(fmi2Component c)
 ////////////////////////////////////////////////////////////////
 ///  This method is used to reset the FMU
 ///
+///  Stops EnergyPlus and returns the instance to the state after
+///  fmi2Instantiate. The model description, the output folder and
+///  the vectors are kept, hence the next fmi2EnterInitializationMode
+///  only prepares the run files, from the cache, and starts EnergyPlus.
+///
 ///\param c The FMU instance.
-///\return fmi2Warning if no error occurred.
+///\return fmi2OK if no error occurred.
 ////////////////////////////////////////////////////////////////
 DllExport fmi2Status fmi2Reset(fmi2Component c)
 {
 	ModelInstance* _c = (ModelInstance *)c;
-	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Warning,
-		"Warning", "fmi2Reset: The function fmi2Reset: is not provided.\n");
-	return fmi2Warning;
+	char *tmpstr;
+	const double tStart=getWallClockTime();
+
+	// stop EnergyPlus, which cannot go back to the start time
+	stop_sim(_c);
+	// release the buffers and the shared memory of the connection,
+	// a new connection is opened by fmi2EnterInitializationMode
+	freeconnectionFMU(&_c->con);
+	initconnectionFMU(&_c->con, INVALID_SOCKET);
+
+	// remove the input file of the run, which is written again
+	if (strlen(_c->in_file_name) > 0) {
+		tmpstr=getOutputPath(_c, _c->in_file_name);
+		remove(tmpstr);
+		_c->functions->freeMemory(tmpstr);
+	}
+	// the resource files are searched again by fmi2EnterInitializationMode
+	if (_c->in_file != NULL) _c->functions->freeMemory(_c->in_file);
+	_c->in_file = NULL;
+	if (_c->wea_file != NULL) _c->functions->freeMemory(_c->wea_file);
+	_c->wea_file = NULL;
+	if (_c->idd_file != NULL) _c->functions->freeMemory(_c->idd_file);
+	_c->idd_file = NULL;
+
+	// keep the vectors, but not their values
+	if (_c->inVec != NULL) memset(_c->inVec, 0, _c->numInVar*sizeof(fmi2Real));
+	if (_c->outVec != NULL) memset(_c->outVec, 0, _c->numOutVar*sizeof(fmi2Real));
+
+	// go back to the state after fmi2Instantiate
+	_c->setupExperiment=0;
+	_c->firstCallIni=1;
+	_c->stepStatus=fmi2OK;
+	phaseTimer_init(&_c->timer, isTimingOn(_c->loggingOn));
+	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2OK, "ok",
+		"fmi2Reset: Reset of %s succeded in %.3f ms.\n", _c->instanceName,
+		1e3*(getWallClockTime() - tStart));
+	return fmi2OK;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -1985,11 +2773,16 @@ DllExport fmi2Status fmi2Reset(fmi2Component c)
 ///\param c The FMU instance.
 ///\param fmi2StatusKind The status information.
 ///\param value The status value.
-///\return fmi2Warning if no error occured.
+///\return fmi2OK for fmi2DoStepStatus, fmi2Warning otherwise.
 ////////////////////////////////////////////////////////////////
 DllExport fmi2Status fmi2GetStatus(fmi2Component c, const fmi2StatusKind s, fmi2Status* value)
 {
 	ModelInstance* _c=(ModelInstance *)c;
+	// status of an asynchronous step
+	if (s==fmi2DoStepStatus){
+		*value=asyncWorker_isBusy(&_c->worker) ? fmi2Pending : _c->stepStatus;
+		return fmi2OK;
+	}
 	_c->functions->logger(_c->componentEnvironment, _c->instanceName, fmi2Warning, "Warning",
 		"fmi2GetStatus: fmi2GetStatus: is not provided.\n");
 	return fmi2Warning;
@@ -0,0 +1,146 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+/////////////////////////////////////////////////////////////////////
+// \file   modelDescCache.c
+//
+// \brief  Process-wide cache of parsed model description files.
+//
+/////////////////////////////////////////////////////////////////////
+#include <stdlib.h>
+#include <string.h>
+#include "modelDescCache.h"
+
+#ifdef _MSC_VER
+#include <windows.h>
+static SRWLOCK cacheLock = SRWLOCK_INIT;
+#define LOCK()   AcquireSRWLockExclusive(&cacheLock)
+#define UNLOCK() ReleaseSRWLockExclusive(&cacheLock)
+#else
+#include <pthread.h>
+static pthread_mutex_t cacheLock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK()   pthread_mutex_lock(&cacheLock)
+#define UNLOCK() pthread_mutex_unlock(&cacheLock)
+#endif
+
+typedef struct MdCacheEntry {
+	char *xmlPath;             ///< Path to the model description file.
+	char *guid;                ///< GUID of the model description.
+	ModelDescription *md;      ///< The parsed model description.
+	int refCount;              ///< Number of instances that use \c md.
+	struct MdCacheEntry *next; ///< The next entry, or \c NULL.
+} MdCacheEntry;
+
+/// The entries, protected by \c cacheLock.
+static MdCacheEntry *cacheHead = NULL;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Finds an entry. Must be called with the lock held.
+///
+///\param xmlPath The path to the model description file.
+///\param guid The GUID of the model description.
+///\return The entry, or \c NULL.
+///////////////////////////////////////////////////////////////////////////////
+static MdCacheEntry* mdCache_find(const char *xmlPath, const char *guid)
+{
+	MdCacheEntry *e;
+	for (e = cacheHead; e != NULL; e = e->next) {
+		if (strcmp(e->xmlPath, xmlPath) == 0 && strcmp(e->guid, guid) == 0)
+			return e;
+	}
+	return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Gets the parsed model description of a file.
+///
+///\param xmlPath The path to the model description file.
+///\param guid The expected GUID of the model.
+///\return The model description, or \c NULL if the file could not be
+///        parsed. A model description that is not \c NULL must be
+///        released with \c mdCache_release.
+///////////////////////////////////////////////////////////////////////////////
+ModelDescription* mdCache_acquire(const char *xmlPath, const char *guid)
+{
+	MdCacheEntry *e;
+	ModelDescription *md;
+	const char *mdGuid;
+
+	LOCK();
+	e = mdCache_find(xmlPath, guid);
+	if (e != NULL) {
+		e->refCount++;
+		UNLOCK();
+		return e->md;
+	}
+	UNLOCK();
+
+	// Parse without holding the lock, so that instances of other
+	// FMUs are not blocked.
+	md = parse((char *)xmlPath);
+	if (md == NULL)
+		return NULL;
+	mdGuid = getAttributeValue((Element *)md, att_guid);
+
+	LOCK();
+	// Another instance may have added the same file in the meantime.
+	e = mdCache_find(xmlPath, mdGuid);
+	if (e != NULL) {
+		e->refCount++;
+		UNLOCK();
+		freeModelDescription(md);
+		return e->md;
+	}
+	e = (MdCacheEntry *)calloc(1, sizeof(MdCacheEntry));
+	if (e != NULL) {
+		e->xmlPath = (char *)malloc(strlen(xmlPath) + 1);
+		e->guid = (char *)malloc(strlen(mdGuid) + 1);
+	}
+	if (e == NULL || e->xmlPath == NULL || e->guid == NULL) {
+		UNLOCK();
+		if (e != NULL) {
+			free(e->xmlPath);
+			free(e->guid);
+			free(e);
+		}
+		freeModelDescription(md);
+		return NULL;
+	}
+	strcpy(e->xmlPath, xmlPath);
+	strcpy(e->guid, mdGuid);
+	e->md = md;
+	e->refCount = 1;
+	e->next = cacheHead;
+	cacheHead = e;
+	UNLOCK();
+	return md;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Releases a model description returned by \c mdCache_acquire.
+///
+///\param md The model description, or \c NULL.
+///////////////////////////////////////////////////////////////////////////////
+void mdCache_release(ModelDescription *md)
+{
+	MdCacheEntry **pe;
+	MdCacheEntry *e = NULL;
+
+	if (md == NULL)
+		return;
+	LOCK();
+	for (pe = &cacheHead; *pe != NULL; pe = &(*pe)->next) {
+		if ((*pe)->md == md) {
+			if (--(*pe)->refCount == 0) {
+				e = *pe;
+				*pe = e->next;
+			}
+			break;
+		}
+	}
+	UNLOCK();
+	if (e != NULL) {
+		freeModelDescription(e->md);
+		free(e->xmlPath);
+		free(e->guid);
+		free(e);
+	}
+}
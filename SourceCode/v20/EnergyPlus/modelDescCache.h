@@ -0,0 +1,45 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+/////////////////////////////////////////////////////////////////////
+// \file   modelDescCache.h
+//
+// \brief  Process-wide cache of parsed model description files.
+//
+// Instances of the same FMU share one parsed model description,
+// so that a master that instantiates many copies of an FMU parses
+// its modelDescription.xml once. Entries are keyed by the path
+// of the file and by its GUID, and are reference counted. The
+// model description of an entry must not be modified.
+//
+/////////////////////////////////////////////////////////////////////
+#ifndef _MODELDESCCACHE_H_
+#define _MODELDESCCACHE_H_
+
+#include "../fmusdk-shared/parser/XmlParserCApi.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Gets the parsed model description of a file.
+///
+/// If the cache has an entry for \c xmlPath whose GUID is \c guid,
+/// the entry is returned. Otherwise the file is parsed and added to
+/// the cache under the GUID found in the file, which the caller
+/// must check against \c guid.
+///
+///\param xmlPath The path to the model description file.
+///\param guid The expected GUID of the model.
+///\return The model description, or \c NULL if the file could not be
+///        parsed. A model description that is not \c NULL must be
+///        released with \c mdCache_release.
+///////////////////////////////////////////////////////////////////////////////
+ModelDescription* mdCache_acquire(const char *xmlPath, const char *guid);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Releases a model description returned by \c mdCache_acquire.
+///
+/// The model description is freed when it is no longer used by
+/// any instance.
+///
+///\param md The model description, or \c NULL.
+///////////////////////////////////////////////////////////////////////////////
+void mdCache_release(ModelDescription *md);
+
+#endif /* _MODELDESCCACHE_H_ */
@@ -0,0 +1,145 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+/////////////////////////////////////////////////////////////////////
+// \file   phaseTimer.c
+//
+// \brief  Wall clock and processor time of the phases of the
+//         start of an FMU instance.
+//
+/////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "phaseTimer.h"
+#include "../../utility/util.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Removes all phases and enables or disables the timer.
+///
+///\param t The timer.
+///\param enabled 1 to record the phases.
+///////////////////////////////////////////////////////////////////////////////
+void phaseTimer_init(PhaseTimer *t, int enabled)
+{
+	memset(t, 0, sizeof(PhaseTimer));
+	t->enabled = enabled;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Starts a phase.
+///
+///\param t The timer.
+///////////////////////////////////////////////////////////////////////////////
+void phaseTimer_begin(PhaseTimer *t)
+{
+	if (!t->enabled)
+		return;
+	t->wallStart = getWallClockTime();
+	t->cpuStart = getCpuTime();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Ends the current phase and starts the next one.
+///
+///\param t The timer.
+///\param name The name of the phase, which must be a string literal.
+///////////////////////////////////////////////////////////////////////////////
+void phaseTimer_end(PhaseTimer *t, const char *name)
+{
+	int i;
+	double wall;
+	double cpu;
+
+	if (!t->enabled)
+		return;
+	wall = getWallClockTime();
+	cpu = getCpuTime();
+	for (i = 0; i < t->nPhase; i++) {
+		if (strcmp(t->phases[i].name, name) == 0)
+			break;
+	}
+	if (i == t->nPhase && t->nPhase < PHASETIMER_MAX) {
+		t->phases[i].name = name;
+		t->phases[i].wall = 0;
+		t->phases[i].cpu = 0;
+		t->nPhase++;
+	}
+	if (i < t->nPhase) {
+		t->phases[i].wall += wall - t->wallStart;
+		t->phases[i].cpu += cpu - t->cpuStart;
+	}
+	t->wallStart = wall;
+	t->cpuStart = cpu;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Reports the phases through the logger of the FMU instance.
+///
+///\param t The timer.
+///\param functions The callback functions of the FMU instance.
+///\param instanceName The name of the FMU instance.
+///////////////////////////////////////////////////////////////////////////////
+void phaseTimer_log(const PhaseTimer *t, const fmi2CallbackFunctions *functions,
+	fmi2String instanceName)
+{
+	int i;
+	double wall = 0;
+	double cpu = 0;
+
+	for (i = 0; i < t->nPhase; i++) {
+		functions->logger(functions->componentEnvironment, instanceName, fmi2OK, "ok",
+			"Startup phase %-24s wall %10.3f ms, cpu %10.3f ms.\n", t->phases[i].name,
+			1e3*t->phases[i].wall, 1e3*t->phases[i].cpu);
+		wall += t->phases[i].wall;
+		cpu += t->phases[i].cpu;
+	}
+	functions->logger(functions->componentEnvironment, instanceName, fmi2OK, "ok",
+		"Startup phase %-24s wall %10.3f ms, cpu %10.3f ms.\n", "total", 1e3*wall, 1e3*cpu);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Writes a string as a JSON string.
+///
+///\param fp The file.
+///\param str The string.
+///////////////////////////////////////////////////////////////////////////////
+static void writeJsonString(FILE *fp, const char *str)
+{
+	fputc('"', fp);
+	for (; *str != '\0'; str++) {
+		if (*str == '"' || *str == '\\')
+			fprintf(fp, "\\%c", *str);
+		else if ((unsigned char)*str < 0x20)
+			fprintf(fp, "\\u%04x", (unsigned char)*str);
+		else
+			fputc(*str, fp);
+	}
+	fputc('"', fp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Writes the phases to a JSON file.
+///
+///\param t The timer.
+///\param fileName The name of the file.
+///\param instanceName The name of the FMU instance.
+///\return 0 if no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+int phaseTimer_writeJson(const PhaseTimer *t, const char *fileName, const char *instanceName)
+{
+	int i;
+	FILE *fp = fopen(fileName, "w");
+	if (fp == NULL)
+		return 1;
+	fprintf(fp, "{\n");
+	fprintf(fp, "  \"instanceName\": ");
+	writeJsonString(fp, instanceName);
+	fprintf(fp, ",\n");
+	fprintf(fp, "  \"unit\": \"s\",\n");
+	fprintf(fp, "  \"phases\": [");
+	for (i = 0; i < t->nPhase; i++) {
+		fprintf(fp, "%s\n    {\"name\": ", i == 0 ? "" : ",");
+		writeJsonString(fp, t->phases[i].name);
+		fprintf(fp, ", \"wall\": %.6f, \"cpu\": %.6f}", t->phases[i].wall, t->phases[i].cpu);
+	}
+	fprintf(fp, "\n  ]\n}\n");
+	return fclose(fp) == 0 ? 0 : 1;
+}
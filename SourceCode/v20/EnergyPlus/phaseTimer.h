@@ -0,0 +1,81 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+/////////////////////////////////////////////////////////////////////
+// \file   phaseTimer.h
+//
+// \brief  Wall clock and processor time of the phases of the
+//         start of an FMU instance.
+//
+// The phases are timed from fmi2Instantiate to the first exchange
+// of data with EnergyPlus, and reported through the logger and in
+// a JSON file in the output folder of the instance.
+//
+/////////////////////////////////////////////////////////////////////
+#ifndef _PHASETIMER_H_
+#define _PHASETIMER_H_
+
+#include "../fmusdk-shared/include/fmi2Functions.h"
+
+/** \val Maximum number of phases that are recorded. */
+#define PHASETIMER_MAX 16
+
+/// Time of one phase.
+typedef struct PhaseTime {
+	const char *name; ///< Name of the phase, which must be a string literal.
+	double wall;      ///< Elapsed wall clock time, in seconds.
+	double cpu;       ///< Processor time of the calling thread, in seconds.
+} PhaseTime;
+
+typedef struct PhaseTimer {
+	int enabled;                       ///< 1 if the phases are recorded.
+	int nPhase;                        ///< Number of phases recorded in \c phases.
+	PhaseTime phases[PHASETIMER_MAX];  ///< The phases, in the order in which they ended.
+	double wallStart;                  ///< Wall clock time at the start of the current phase.
+	double cpuStart;                   ///< Processor time at the start of the current phase.
+} PhaseTimer;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Removes all phases and enables or disables the timer.
+///
+///\param t The timer.
+///\param enabled 1 to record the phases.
+///////////////////////////////////////////////////////////////////////////////
+void phaseTimer_init(PhaseTimer *t, int enabled);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Starts a phase.
+///
+///\param t The timer.
+///////////////////////////////////////////////////////////////////////////////
+void phaseTimer_begin(PhaseTimer *t);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Ends the current phase and starts the next one.
+///
+/// Phases with the same name are added.
+///
+///\param t The timer.
+///\param name The name of the phase, which must be a string literal.
+///////////////////////////////////////////////////////////////////////////////
+void phaseTimer_end(PhaseTimer *t, const char *name);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Reports the phases through the logger of the FMU instance.
+///
+///\param t The timer.
+///\param functions The callback functions of the FMU instance.
+///\param instanceName The name of the FMU instance.
+///////////////////////////////////////////////////////////////////////////////
+void phaseTimer_log(const PhaseTimer *t, const fmi2CallbackFunctions *functions,
+	fmi2String instanceName);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Writes the phases to a JSON file.
+///
+///\param t The timer.
+///\param fileName The name of the file.
+///\param instanceName The name of the FMU instance.
+///\return 0 if no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+int phaseTimer_writeJson(const PhaseTimer *t, const char *fileName, const char *instanceName);
+
+#endif /* _PHASETIMER_H_ */
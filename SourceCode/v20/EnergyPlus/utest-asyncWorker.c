@@ -0,0 +1,142 @@
+//--- Unit test and micro-benchmark for asyncWorker.c.
+//
+/// \brief  Unit test and micro-benchmark for asyncWorker.c.
+///
+/// Posts jobs to a worker, checks that every job runs once, that
+/// the worker is not busy when the finished function is called,
+/// and that posting to a busy worker fails. Then reports the time
+/// per step of a master that waits for EnergyPlus, and of a master
+/// that does its own work while the worker waits for EnergyPlus.
+///
+/// Build on Linux, from this directory, with
+///   gcc -O3 utest-asyncWorker.c asyncWorker.c -lpthread -o utest-asyncWorker
+
+
+//--- Includes.
+#include <assert.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "asyncWorker.h"
+
+
+//--- File-scope constants.
+#define N_JOB 10000
+#define N_STEP 200
+#define STEP_NS 1000000L
+
+
+//--- State shared by the master and the jobs.
+//
+typedef struct TestState {
+  AsyncWorker worker;
+  volatile int nJob;
+  volatile int nFinished;
+  volatile int nBusyInFinished;
+  long sleepNs;
+} TestState;
+
+
+//--- Wall clock time in seconds.
+//
+static double wallTime(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return( ts.tv_sec + 1e-9*ts.tv_nsec );
+}
+
+
+//--- Sleep {ns} nanoseconds, as a stand-in for EnergyPlus or the master.
+//
+static void sleepNs(long ns) {
+  struct timespec ts;
+  if( ns <= 0 ) return;
+  ts.tv_sec = ns / 1000000000L;
+  ts.tv_nsec = ns % 1000000000L;
+  nanosleep(&ts, NULL);
+}
+
+
+//--- Job: count, and wait for EnergyPlus.
+//
+static void job(void* arg) {
+  TestState* st = (TestState*)arg;
+  st->nJob++;
+  sleepNs(st->sleepNs);
+}
+
+
+//--- Finished: count, and check that the worker is no longer busy.
+//
+static void finished(void* arg) {
+  TestState* st = (TestState*)arg;
+  if( asyncWorker_isBusy(&st->worker) ) st->nBusyInFinished++;
+  st->nFinished++;
+}
+
+
+//--- Main driver.
+//
+int main(int argc, const char* argv[]) {
+  //
+  TestState st = {{0}};
+  int i;
+  double tic, tSync, tAsync;
+  //
+  // A worker that has not been started is neither busy nor accepts jobs.
+  assert( asyncWorker_isBusy(&st.worker) == 0 );
+  assert( asyncWorker_post(&st.worker) != 0 );
+  asyncWorker_wait(&st.worker);
+  asyncWorker_stop(&st.worker);
+  //
+  // Every posted job runs once, followed by finished.
+  assert( 0 == asyncWorker_start(&st.worker, job, finished, &st) );
+  tic = wallTime();
+  for( i=0; i<N_JOB; i++ ){
+    assert( 0 == asyncWorker_post(&st.worker) );
+    asyncWorker_wait(&st.worker);
+    assert( st.nJob == i+1 );
+    // The finished function is called after the job has returned.
+    while( st.nFinished != i+1 ) sched_yield();
+  }
+  printf("post and wait: %8.3f us/job\n", 1e6*(wallTime()-tic)/N_JOB);
+  asyncWorker_stop(&st.worker);
+  assert( st.nFinished == N_JOB );
+  assert( st.nBusyInFinished == 0 );
+  assert( asyncWorker_isBusy(&st.worker) == 0 );
+  //
+  // A busy worker does not accept another job.
+  st.sleepNs = 20*STEP_NS;
+  assert( 0 == asyncWorker_start(&st.worker, job, NULL, &st) );
+  assert( 0 == asyncWorker_post(&st.worker) );
+  assert( asyncWorker_isBusy(&st.worker) == 1 );
+  assert( asyncWorker_post(&st.worker) != 0 );
+  asyncWorker_wait(&st.worker);
+  assert( asyncWorker_isBusy(&st.worker) == 0 );
+  asyncWorker_stop(&st.worker);
+  assert( st.nJob == N_JOB+1 );
+  //
+  // EnergyPlus and the master each take STEP_NS per step.
+  st.sleepNs = STEP_NS;
+  tic = wallTime();
+  for( i=0; i<N_STEP; i++ ){
+    job(&st);
+    sleepNs(STEP_NS);
+  }
+  tSync = 1e6*(wallTime()-tic)/N_STEP;
+  assert( 0 == asyncWorker_start(&st.worker, job, NULL, &st) );
+  tic = wallTime();
+  for( i=0; i<N_STEP; i++ ){
+    assert( 0 == asyncWorker_post(&st.worker) );
+    sleepNs(STEP_NS);
+    asyncWorker_wait(&st.worker);
+  }
+  tAsync = 1e6*(wallTime()-tic)/N_STEP;
+  asyncWorker_stop(&st.worker);
+  printf("%16s  %16s\n", "sync [us/step]", "async [us/step]");
+  printf("%16.1f  %16.1f\n", tSync, tAsync);
+  assert( tAsync < tSync );
+  //
+  return( 0 );
+}  // End fcn main().
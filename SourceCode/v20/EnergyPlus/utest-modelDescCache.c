@@ -0,0 +1,147 @@
+//--- Unit test and micro-benchmark for modelDescCache.c.
+//
+/// \brief  Unit test and micro-benchmark for modelDescCache.c.
+///
+/// Checks that instances of the same model description file and
+/// GUID share one parsed model description, that a different GUID
+/// or file gets its own entry, that an entry is freed with its last
+/// instance, and that threads acquiring the same file concurrently
+/// get the same entry. Reports the cost of parsing the file compared
+/// to getting it from the cache.
+///
+/// Build on Linux, from this directory, with
+///   g++ -c ../fmusdk-shared/parser/*.cpp
+///   gcc -O3 utest-modelDescCache.c modelDescCache.c *.o -lstdc++ -lxml2 -lpthread -o utest-modelDescCache
+
+
+//--- Includes.
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "modelDescCache.h"
+
+
+//--- File-scope constants.
+#define XML_TEST_FILE "utest-modelDescCache.xml"
+#define XML_TEST_FILE_2 "utest-modelDescCache-2.xml"
+#define N_VAR 500
+#define N_INST 500
+#define N_THREAD 8
+
+
+//--- Write a model description with {nVar} inputs and outputs, and GUID {guid}.
+//
+static void writeModelDescription(const char* fileName, const char* guid, int nVar) {
+  int i;
+  FILE* fp = fopen(fileName, "w");
+  assert( fp != NULL );
+  fprintf(fp, "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n");
+  fprintf(fp, "<fmiModelDescription fmiVersion=\"2.0\" modelName=\"utest\" guid=\"%s\">\n", guid);
+  fprintf(fp, "  <CoSimulation modelIdentifier=\"utest\"/>\n");
+  fprintf(fp, "  <ModelVariables>\n");
+  for( i=0; i<nVar; i++ ){
+    fprintf(fp, "    <ScalarVariable name=\"u%d\" valueReference=\"%d\" variability=\"continuous\" causality=\"input\">\n", i, 1+i);
+    fprintf(fp, "      <Real start=\"0\"/>\n    </ScalarVariable>\n");
+  }
+  for( i=0; i<nVar; i++ ){
+    fprintf(fp, "    <ScalarVariable name=\"y%d\" valueReference=\"%d\" variability=\"continuous\" causality=\"output\">\n", i, 100001+i);
+    fprintf(fp, "      <Real/>\n    </ScalarVariable>\n");
+  }
+  fprintf(fp, "  </ModelVariables>\n");
+  fprintf(fp, "  <ModelStructure>\n    <Outputs>\n");
+  for( i=0; i<nVar; i++ ){
+    fprintf(fp, "      <Unknown index=\"%d\"/>\n", nVar+i+1);
+  }
+  fprintf(fp, "    </Outputs>\n  </ModelStructure>\n");
+  fprintf(fp, "</fmiModelDescription>\n");
+  fclose(fp);
+}
+
+
+//--- Acquire the model description from a thread.
+//
+static void* acquireFromThread(void* arg) {
+  ModelDescription** md = (ModelDescription**)arg;
+  *md = mdCache_acquire(XML_TEST_FILE, "{1}");
+  return( NULL );
+}
+
+
+//--- Main driver.
+//
+int main(int argc, const char* argv[]) {
+  //
+  ModelDescription* md[N_INST];
+  ModelDescription *md2, *mdOther;
+  pthread_t threads[N_THREAD];
+  int i;
+  double tParse, tCache;
+  clock_t tic;
+  //
+  writeModelDescription(XML_TEST_FILE, "{1}", N_VAR);
+  writeModelDescription(XML_TEST_FILE_2, "{2}", N_VAR);
+  //
+  // Instances of the same file and GUID share the model description.
+  tic = clock();
+  md[0] = mdCache_acquire(XML_TEST_FILE, "{1}");
+  tParse = 1e3*(double)(clock()-tic)/CLOCKS_PER_SEC;
+  assert( md[0] != NULL );
+  assert( 0 == strcmp(getAttributeValue((Element*)md[0], att_guid), "{1}") );
+  assert( 2*N_VAR == getScalarVariableSize(md[0]) );
+  tic = clock();
+  for( i=1; i<N_INST; i++ ){
+    md[i] = mdCache_acquire(XML_TEST_FILE, "{1}");
+  }
+  tCache = 1e3*(double)(clock()-tic)/CLOCKS_PER_SEC/(N_INST-1);
+  for( i=1; i<N_INST; i++ ){
+    assert( md[i] == md[0] );
+  }
+  //
+  // Another file has its own entry.
+  md2 = mdCache_acquire(XML_TEST_FILE_2, "{2}");
+  assert( md2 != NULL && md2 != md[0] );
+  assert( 0 == strcmp(getAttributeValue((Element*)md2, att_guid), "{2}") );
+  //
+  // A GUID that is not the one of the file parses the file again,
+  // and gets the entry of the GUID of the file, which the caller rejects.
+  mdOther = mdCache_acquire(XML_TEST_FILE, "{3}");
+  assert( mdOther == md[0] );
+  assert( 0 == strcmp(getAttributeValue((Element*)mdOther, att_guid), "{1}") );
+  mdCache_release(mdOther);
+  //
+  // A missing file is not cached.
+  assert( NULL == mdCache_acquire("utest-modelDescCache-missing.xml", "{1}") );
+  //
+  // The entry stays while an instance uses it.
+  for( i=1; i<N_INST; i++ ){
+    mdCache_release(md[i]);
+  }
+  assert( md[0] == mdCache_acquire(XML_TEST_FILE, "{1}") );
+  mdCache_release(md[0]);
+  mdCache_release(md[0]);
+  mdCache_release(md2);
+  //
+  // Threads that start without an entry end up sharing one.
+  for( i=0; i<N_THREAD; i++ ){
+    assert( 0 == pthread_create(&threads[i], NULL, acquireFromThread, &md[i]) );
+  }
+  for( i=0; i<N_THREAD; i++ ){
+    assert( 0 == pthread_join(threads[i], NULL) );
+  }
+  for( i=1; i<N_THREAD; i++ ){
+    assert( md[i] != NULL && md[i] == md[0] );
+  }
+  for( i=0; i<N_THREAD; i++ ){
+    mdCache_release(md[i]);
+  }
+  //
+  printf("%8s  %16s  %16s\n", "nVar", "parse [ms]", "cache [ms]");
+  printf("%8d  %16.3f  %16.6f\n", 2*N_VAR, tParse, tCache);
+  remove(XML_TEST_FILE);
+  remove(XML_TEST_FILE_2);
+  //
+  return( 0 );
+}  // End fcn main().
@@ -0,0 +1,139 @@
+//--- Unit test and micro-benchmark for phaseTimer.c.
+//
+/// \brief  Unit test and micro-benchmark for phaseTimer.c.
+///
+/// Checks that a disabled timer records nothing, that phases with
+/// the same name are added, that the number of phases is bounded,
+/// and that the report goes to the logger and to a JSON file.
+/// Reports the cost of ending a phase.
+///
+/// Build on Linux, from this directory, with
+///   gcc -O3 utest-phaseTimer.c phaseTimer.c ../../utility/util.c -o utest-phaseTimer
+
+
+//--- Includes.
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "phaseTimer.h"
+
+
+//--- File-scope constants.
+#define JSON_TEST_FILE "utest-phaseTimer.json"
+#define N_END 100000
+
+
+//--- Number of messages of the logger.
+static int nLog = 0;
+
+
+//--- Logger that counts the messages.
+//
+static void countLogger(fmi2ComponentEnvironment env, fmi2String instanceName,
+  fmi2Status status, fmi2String category, fmi2String message, ...) {
+  assert( status == fmi2OK );
+  assert( 0 == strcmp(instanceName, "inst\"1") );
+  nLog++;
+}
+
+
+//--- Spend some processor time.
+//
+static double spin(int n) {
+  volatile double sum = 0;
+  int i;
+  for( i=0; i<n; i++ ){
+    sum += 1e-3*i;
+  }
+  return( sum );
+}
+
+
+//--- Main driver.
+//
+int main(int argc, const char* argv[]) {
+  //
+  PhaseTimer t;
+  const fmi2CallbackFunctions functions = {countLogger, NULL, NULL, NULL, NULL};
+  char buf[4096];
+  size_t len;
+  FILE* fp;
+  int i;
+  double tEnd;
+  clock_t tic;
+  //
+  // A disabled timer records nothing.
+  phaseTimer_init(&t, 0);
+  phaseTimer_begin(&t);
+  phaseTimer_end(&t, "a");
+  assert( t.nPhase == 0 );
+  //
+  // Phases with the same name are added, in the order in which they first ended.
+  phaseTimer_init(&t, 1);
+  phaseTimer_begin(&t);
+  spin(1000000);
+  phaseTimer_end(&t, "a");
+  phaseTimer_end(&t, "b");
+  spin(1000000);
+  phaseTimer_end(&t, "a");
+  assert( t.nPhase == 2 );
+  assert( 0 == strcmp(t.phases[0].name, "a") );
+  assert( 0 == strcmp(t.phases[1].name, "b") );
+  assert( t.phases[0].wall > 0 && t.phases[0].cpu > 0 );
+  assert( t.phases[0].wall >= t.phases[1].wall );
+  //
+  // Phases beyond the maximum are dropped.
+  phaseTimer_end(&t, "c");
+  phaseTimer_end(&t, "d");
+  phaseTimer_end(&t, "e");
+  phaseTimer_end(&t, "f");
+  phaseTimer_end(&t, "g");
+  phaseTimer_end(&t, "h");
+  phaseTimer_end(&t, "i");
+  phaseTimer_end(&t, "j");
+  phaseTimer_end(&t, "k");
+  phaseTimer_end(&t, "l");
+  phaseTimer_end(&t, "m");
+  phaseTimer_end(&t, "n");
+  phaseTimer_end(&t, "o");
+  phaseTimer_end(&t, "p");
+  phaseTimer_end(&t, "q");
+  assert( t.nPhase == PHASETIMER_MAX );
+  //
+  // The logger gets one message per phase and the total.
+  phaseTimer_log(&t, &functions, "inst\"1");
+  assert( nLog == PHASETIMER_MAX + 1 );
+  //
+  // The JSON file has the phases, with the instance name escaped.
+  assert( 0 == phaseTimer_writeJson(&t, JSON_TEST_FILE, "inst\"1") );
+  fp = fopen(JSON_TEST_FILE, "r");
+  assert( fp != NULL );
+  len = fread(buf, 1, sizeof(buf)-1, fp);
+  buf[len] = '\0';
+  fclose(fp);
+  assert( NULL != strstr(buf, "\"instanceName\": \"inst\\\"1\"") );
+  assert( NULL != strstr(buf, "{\"name\": \"a\", \"wall\": ") );
+  assert( NULL != strstr(buf, "{\"name\": \"p\", \"wall\": ") );
+  assert( NULL == strstr(buf, "\"q\"") );
+  remove(JSON_TEST_FILE);
+  //
+  // A file that cannot be opened is an error.
+  assert( 0 != phaseTimer_writeJson(&t, "utest-phaseTimer-missing/x.json", "inst\"1") );
+  //
+  // Cost of ending a phase.
+  phaseTimer_init(&t, 1);
+  phaseTimer_begin(&t);
+  tic = clock();
+  for( i=0; i<N_END; i++ ){
+    phaseTimer_end(&t, "a");
+  }
+  tEnd = 1e6*(double)(clock()-tic)/CLOCKS_PER_SEC/N_END;
+  //
+  printf("%16s\n", "end [us]");
+  printf("%16.3f\n", tEnd);
+  //
+  return( 0 );
+}  // End fcn main().
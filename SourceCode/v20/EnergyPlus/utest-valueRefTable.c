@@ -0,0 +1,166 @@
+//--- Unit test and micro-benchmark for valueRefTable.c.
+//
+/// \brief  Unit test and micro-benchmark for valueRefTable.c.
+///
+/// Writes model description files with an increasing number of
+/// input and output variables, checks that the lookup tables map
+/// every value reference to the same slot as the scan over all
+/// scalar variables that was used by fmi2SetReal and fmi2GetReal,
+/// and reports the cost per communication step of both methods.
+///
+/// Build on Linux, from this directory, with
+///   g++ -c ../fmusdk-shared/parser/*.cpp
+///   gcc -O3 utest-valueRefTable.c valueRefTable.c *.o -lstdc++ -lxml2 -o utest-valueRefTable
+
+
+//--- Includes.
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "valueRefTable.h"
+
+
+//--- File-scope constants.
+#define XML_TEST_FILE "utest-valueRefTable.xml"
+#define N_STEP 2000
+
+
+//--- Write a model description with {nVar} inputs and {nVar} outputs.
+//
+static void writeModelDescription(const char* fileName, int nVar) {
+  int i;
+  FILE* fp = fopen(fileName, "w");
+  assert( fp != NULL );
+  fprintf(fp, "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n");
+  fprintf(fp, "<fmiModelDescription fmiVersion=\"2.0\" modelName=\"utest\" guid=\"{0}\">\n");
+  fprintf(fp, "  <CoSimulation modelIdentifier=\"utest\"/>\n");
+  fprintf(fp, "  <ModelVariables>\n");
+  for( i=0; i<nVar; i++ ){
+    fprintf(fp, "    <ScalarVariable name=\"u%d\" valueReference=\"%d\" variability=\"continuous\" causality=\"input\">\n", i, VR_INPUT_BASE+i);
+    fprintf(fp, "      <Real start=\"0\"/>\n    </ScalarVariable>\n");
+  }
+  for( i=0; i<nVar; i++ ){
+    fprintf(fp, "    <ScalarVariable name=\"y%d\" valueReference=\"%d\" variability=\"continuous\" causality=\"output\">\n", i, VR_OUTPUT_BASE+i);
+    fprintf(fp, "      <Real/>\n    </ScalarVariable>\n");
+  }
+  fprintf(fp, "  </ModelVariables>\n");
+  fprintf(fp, "  <ModelStructure>\n    <Outputs>\n");
+  for( i=0; i<nVar; i++ ){
+    fprintf(fp, "      <Unknown index=\"%d\"/>\n", nVar+i+1);
+  }
+  fprintf(fp, "    </Outputs>\n  </ModelStructure>\n");
+  fprintf(fp, "</fmiModelDescription>\n");
+  fclose(fp);
+}
+
+
+//--- Get outputs by scanning all scalar variables, as done before the lookup tables.
+//
+static int getByScan(ModelDescription* md, const fmi2ValueReference vr[], size_t nvr,
+  const double outVec[], double value[]) {
+  size_t i;
+  int k, cnt = 0;
+  const int n = getScalarVariableSize(md);
+  for( i=0; i<nvr; i++ ){
+    for( k=0; k<n; k++ ){
+      ScalarVariable* svTemp = getScalarVariable(md, k);
+      if( getCausality(svTemp) != enu_output ) continue;
+      if( getValueReference(svTemp) == vr[i] ){
+        value[i] = outVec[vr[i]-VR_OUTPUT_BASE];
+        cnt++;
+      }
+    }
+  }
+  return( cnt );
+}
+
+
+//--- Get outputs through the lookup table.
+//
+static int getByTable(const ValueRefTable* tab, const fmi2ValueReference vr[], size_t nvr,
+  const double outVec[], double value[]) {
+  size_t i;
+  int slot, cnt = 0;
+  for( i=0; i<nvr; i++ ){
+    slot = vrTable_getSlot(tab, vr[i]);
+    if( slot != VR_NOT_FOUND ){
+      value[i] = outVec[slot];
+      cnt++;
+    }
+  }
+  return( cnt );
+}
+
+
+//--- Main driver.
+//
+int main(int argc, const char* argv[]) {
+  //
+  const int nVarList[] = {10, 100, 1000};
+  const fmi2CallbackFunctions functions = {NULL, calloc, free, NULL, NULL};
+  int iCase, i, step, nVar, nStep;
+  double tScan, tTab;
+  clock_t tic;
+  //
+  printf("%8s  %16s  %16s\n", "nVar", "scan [us/step]", "table [us/step]");
+  for( iCase=0; iCase<3; iCase++ ){
+    ModelDescription* md;
+    ValueRefTable inTab = {0, 0, NULL};
+    ValueRefTable outTab = {0, 0, NULL};
+    fmi2ValueReference* vr;
+    double *outVec, *valScan, *valTab;
+    //
+    nVar = nVarList[iCase];
+    writeModelDescription(XML_TEST_FILE, nVar);
+    md = parse(XML_TEST_FILE);
+    assert( md != NULL );
+    assert( 0 == vrTable_build(&inTab, md, enu_input, VR_INPUT_BASE, nVar, &functions) );
+    assert( 0 == vrTable_build(&outTab, md, enu_output, VR_OUTPUT_BASE, nVar, &functions) );
+    //
+    vr = (fmi2ValueReference*)calloc(nVar, sizeof(fmi2ValueReference));
+    outVec = (double*)calloc(nVar, sizeof(double));
+    valScan = (double*)calloc(nVar, sizeof(double));
+    valTab = (double*)calloc(nVar, sizeof(double));
+    for( i=0; i<nVar; i++ ){
+      vr[i] = VR_OUTPUT_BASE + (nVar-1-i);  // Request in reverse order.
+      outVec[i] = 0.5*i;
+      assert( vrTable_getSlot(&inTab, VR_INPUT_BASE+i) == i );
+      assert( vrTable_getSlot(&outTab, VR_OUTPUT_BASE+i) == i );
+    }
+    // Value references of the other causality, or out of range, are not found.
+    assert( vrTable_getSlot(&inTab, VR_OUTPUT_BASE) == VR_NOT_FOUND );
+    assert( vrTable_getSlot(&outTab, VR_INPUT_BASE) == VR_NOT_FOUND );
+    assert( vrTable_getSlot(&outTab, 0) == VR_NOT_FOUND );
+    assert( vrTable_getSlot(&outTab, VR_OUTPUT_BASE+nVar) == VR_NOT_FOUND );
+    //
+    // Keep total work of the scan roughly constant across cases.
+    nStep = N_STEP / nVar + 1;
+    tic = clock();
+    for( step=0; step<nStep; step++ ){
+      assert( nVar == getByScan(md, vr, nVar, outVec, valScan) );
+    }
+    tScan = 1e6*(double)(clock()-tic)/CLOCKS_PER_SEC/nStep;
+    tic = clock();
+    for( step=0; step<nStep*1000; step++ ){
+      assert( nVar == getByTable(&outTab, vr, nVar, outVec, valTab) );
+    }
+    tTab = 1e6*(double)(clock()-tic)/CLOCKS_PER_SEC/(nStep*1000);
+    for( i=0; i<nVar; i++ ){
+      assert( valScan[i] == valTab[i] );
+    }
+    printf("%8d  %16.3f  %16.3f\n", nVar, tScan, tTab);
+    //
+    vrTable_free(&inTab, &functions);
+    vrTable_free(&outTab, &functions);
+    freeModelDescription(md);
+    free(vr);
+    free(outVec);
+    free(valScan);
+    free(valTab);
+  }
+  remove(XML_TEST_FILE);
+  //
+  return( 0 );
+}  // End fcn main().
@@ -0,0 +1,100 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+/////////////////////////////////////////////////////////////////////
+// \file   valueRefTable.c
+//
+// \brief  Lookup tables that map FMI value references to the
+//         slots of the input and output vectors exchanged with
+//         EnergyPlus.
+//
+/////////////////////////////////////////////////////////////////////
+#include "valueRefTable.h"
+
+///////////////////////////////////////////////////////////////////////////////
+/// Builds the lookup table for all scalar variables of a causality.
+///
+///\param tab The table to build. Must be zero-initialized or freed.
+///\param md The model description.
+///\param causality The causality, \c enu_input or \c enu_output.
+///\param vrBase The value reference that maps to slot 0.
+///\param nSlot The number of slots in the vector.
+///\param functions The callback functions used to allocate memory.
+///\return 0 if no error occurred, 1 if a value reference maps outside
+///        of the vector or memory could not be allocated.
+///////////////////////////////////////////////////////////////////////////////
+int vrTable_build(ValueRefTable *tab, ModelDescription *md, Enu causality,
+	fmi2ValueReference vrBase, int nSlot, const fmi2CallbackFunctions *functions)
+{
+	int k;
+	size_t i;
+	int found = 0;
+	fmi2ValueReference vr;
+	fmi2ValueReference vrMin = 0;
+	fmi2ValueReference vrMax = 0;
+	const int n = getScalarVariableSize(md);
+
+	tab->vrMin = 0;
+	tab->nVr = 0;
+	tab->slot = NULL;
+
+	// First pass: get the range of value references.
+	for (k = 0; k < n; k++) {
+		ScalarVariable *svTemp = getScalarVariable(md, k);
+		if (getCausality(svTemp) != causality) continue;
+		vr = getValueReference(svTemp);
+		if (vr < vrBase || vr - vrBase >= (fmi2ValueReference)nSlot) {
+			return 1;
+		}
+		if (!found || vr < vrMin) vrMin = vr;
+		if (!found || vr > vrMax) vrMax = vr;
+		found = 1;
+	}
+	if (!found) {
+		return 0;
+	}
+
+	// Second pass: store the slot of each value reference.
+	tab->slot = (int *)functions->allocateMemory(vrMax - vrMin + 1, sizeof(int));
+	if (tab->slot == NULL) {
+		return 1;
+	}
+	tab->vrMin = vrMin;
+	tab->nVr = vrMax - vrMin + 1;
+	for (i = 0; i < tab->nVr; i++) {
+		tab->slot[i] = VR_NOT_FOUND;
+	}
+	for (k = 0; k < n; k++) {
+		ScalarVariable *svTemp = getScalarVariable(md, k);
+		if (getCausality(svTemp) != causality) continue;
+		vr = getValueReference(svTemp);
+		tab->slot[vr - vrMin] = (int)(vr - vrBase);
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Returns the vector slot of a value reference.
+///
+///\param tab The table.
+///\param vr The value reference.
+///\return The slot, or \c VR_NOT_FOUND.
+///////////////////////////////////////////////////////////////////////////////
+int vrTable_getSlot(const ValueRefTable *tab, fmi2ValueReference vr)
+{
+	// Unsigned arithmetic maps vr < vrMin to a large index.
+	const size_t idx = (size_t)(vr - tab->vrMin);
+	return (idx < tab->nVr) ? tab->slot[idx] : VR_NOT_FOUND;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Frees the memory of the table.
+///
+///\param tab The table.
+///\param functions The callback functions used to free memory.
+///////////////////////////////////////////////////////////////////////////////
+void vrTable_free(ValueRefTable *tab, const fmi2CallbackFunctions *functions)
+{
+	if (tab->slot != NULL) functions->freeMemory(tab->slot);
+	tab->slot = NULL;
+	tab->vrMin = 0;
+	tab->nVr = 0;
+}
@@ -0,0 +1,70 @@
+// Methods for Functional Mock-up Unit Export of EnergyPlus.
+/////////////////////////////////////////////////////////////////////
+// \file   valueRefTable.h
+//
+// \brief  Lookup tables that map FMI value references to the
+//         slots of the input and output vectors exchanged with
+//         EnergyPlus.
+//
+// The tables are compiled once from the model description so that
+// fmi2SetReal and fmi2GetReal do not have to scan all scalar
+// variables for every requested value reference.
+//
+/////////////////////////////////////////////////////////////////////
+#ifndef _VALUEREFTABLE_H_
+#define _VALUEREFTABLE_H_
+
+#include <stddef.h>
+#include "../fmusdk-shared/include/fmi2Functions.h"
+#include "../fmusdk-shared/parser/XmlParserCApi.h"
+
+/** \val Value reference of the first input (to EnergyPlus). */
+#define VR_INPUT_BASE  1
+/** \val Value reference of the first output (from EnergyPlus). */
+#define VR_OUTPUT_BASE 100001
+
+/** \val Slot value for value references that are not in the table. */
+#define VR_NOT_FOUND  -1
+
+typedef struct ValueRefTable {
+	fmi2ValueReference vrMin; ///< Smallest value reference in the table.
+	size_t nVr;               ///< Number of entries in \c slot.
+	int *slot;                ///< Vector slot of value reference \c vrMin+i, or \c VR_NOT_FOUND.
+} ValueRefTable;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Builds the lookup table for all scalar variables of a causality.
+///
+/// The slot of a variable is its value reference minus \c vrBase,
+/// which is the order used in \c variables.cfg.
+///
+///\param tab The table to build. Must be zero-initialized or freed.
+///\param md The model description.
+///\param causality The causality, \c enu_input or \c enu_output.
+///\param vrBase The value reference that maps to slot 0.
+///\param nSlot The number of slots in the vector.
+///\param functions The callback functions used to allocate memory.
+///\return 0 if no error occurred, 1 if a value reference maps outside
+///        of the vector or memory could not be allocated.
+///////////////////////////////////////////////////////////////////////////////
+int vrTable_build(ValueRefTable *tab, ModelDescription *md, Enu causality,
+	fmi2ValueReference vrBase, int nSlot, const fmi2CallbackFunctions *functions);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Returns the vector slot of a value reference.
+///
+///\param tab The table.
+///\param vr The value reference.
+///\return The slot, or \c VR_NOT_FOUND.
+///////////////////////////////////////////////////////////////////////////////
+int vrTable_getSlot(const ValueRefTable *tab, fmi2ValueReference vr);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Frees the memory of the table.
+///
+///\param tab The table.
+///\param functions The callback functions used to free memory.
+///////////////////////////////////////////////////////////////////////////////
+void vrTable_free(ValueRefTable *tab, const fmi2CallbackFunctions *functions);
+
+#endif /* _VALUEREFTABLE_H_ */
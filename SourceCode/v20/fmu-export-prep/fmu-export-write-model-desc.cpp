@@ -9,6 +9,8 @@
 //--- Includes.
 //
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctype.h>
 #include <string>
 using std::string;
@@ -30,6 +32,10 @@ using std::endl;
 
 
 //--- File-scope constants.
+//
+// Environment variable that, if set to a value other than 0 at export,
+// lets the FMU run fmi2DoStep asynchronously.
+static const char *const asyncEnvName = "ENERGYPLUSTOFMU_ASYNC";
 
 
 //--- Functions.
@@ -57,6 +63,9 @@ void modelDescXml_write(std::ostream& outStream,
   const char *const modelVarsTagName = "ModelVariables";
   const char *const implementationTagName = "Implementation";
   const char *const cosimToolTagName = "CoSimulation";
+  const char *const vendorAnnotationsTagName = "VendorAnnotations";
+  const char *const toolTagName = "Tool";
+  const char *const batchedExchangeTagName = "BatchedExchange";
   const char *const modelTagName = "Model";
   const char *const modelStructureTagName = "ModelStructure";
   const char *const outputsTagName = "Outputs";
@@ -124,12 +133,27 @@ void modelDescXml_write(std::ostream& outStream,
   xmlOutput_attribute(outStream, 2, "canGetAndSetFMUstate", "false");
   xmlOutput_attribute(outStream, 2, "canSerializeFMUstate", "false");
   // Note the FMI specification spells "asynchronously" wrong.
-  xmlOutput_attribute(outStream, 2, "canRunAsynchronuously", "false");
+  const char *const asyncEnv = getenv(asyncEnvName);
+  xmlOutput_attribute(outStream, 2, "canRunAsynchronuously",
+    (asyncEnv != NULL && strcmp(asyncEnv, "0") != 0) ? "true" : "false");
   xmlOutput_attribute(outStream, 2, "canBeInstantiatedOnlyOncePerProcess", "false");
   xmlOutput_attribute(outStream, 2, "canNotUseMemoryManagementFunctions", "true");
   xmlOutput_attribute(outStream, 2, "providesDirectionalDerivative", "false");
   xmlOutput_endTag(outStream, -1, NULL);
   //
+  //-- Write vendor annotation for the exchange of several steps in one call.
+  xmlOutput_comment(outStream, 1, "Masters that know the inputs of several steps in advance can call EnergyPlusToFMU_doSteps().");
+  xmlOutput_startTag(outStream, 1, vendorAnnotationsTagName);
+  xmlOutput_startTag_finish(outStream);
+  xmlOutput_startTag(outStream, 2, toolTagName);
+  xmlOutput_attribute(outStream, 3, "name", "EnergyPlusToFMU");
+  xmlOutput_startTag_finish(outStream);
+  xmlOutput_startTag(outStream, 3, batchedExchangeTagName);
+  xmlOutput_attribute(outStream, 4, "functionName", "EnergyPlusToFMU_doSteps");
+  xmlOutput_endTag(outStream, -1, NULL);
+  xmlOutput_endTag(outStream, 2, toolTagName);
+  xmlOutput_endTag(outStream, 1, vendorAnnotationsTagName);
+  //
   //-- Open tag for exposed model variables.
   xmlOutput_comment(outStream, 1, "Exposed model variables.");
   xmlOutput_startTag(outStream, 1, modelVarsTagName);